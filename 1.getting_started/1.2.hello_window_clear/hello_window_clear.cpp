@@ -5,6 +5,8 @@
 /* The include file for GLAD includes the required OpenGL headers,
 so be sure to include GLAD before other header files that require OpenGL (like GLFW) */
 
+#include <learnopengl/redraw_scheduler.h>
+
 #include <iostream>
 
 /* -The moment a user resizes the window the viewport should be adjusted as well.
@@ -17,6 +19,11 @@ void processInput(GLFWwindow* window);
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+/* The screen never changes, so redrawing it 60 times per second only burns power. With ON_DEMAND_RENDERING
+the loop sleeps until an event (a key, a resize, the window being uncovered) and only then draws a frame
+(see learnopengl/redraw_scheduler.h). */
+const bool ON_DEMAND_RENDERING = false;
+
 int main()
 {
 	// instantiate the GLFW window:
@@ -71,14 +78,27 @@ int main()
 
 	(but another function called "framebuffer_size_callback", set at the bottom) */
 
+	/* The scheduler chains itself in front of framebuffer_size_callback, so a resize also asks for a new frame */
+	RedrawScheduler redraw(window, ON_DEMAND_RENDERING);
+
 	/* -The glfwWindowShouldClose function checks at the start of each loop iteration if GLFW has
 	been instructed to close. If so, the function returns true and the render loop stops running,
 	after which we can close the application */
 	while (!glfwWindowShouldClose(window))
 	{
+		/* - The glfwPollEvents function checks if any events are triggered
+		(like keyboard input or mouse movement events), updates the window state,
+			and calls the corresponding functions (which we can register via callback methods).
+		- On demand, waitEvents() instead sleeps in glfwWaitEventsTimeout until there is one */
+		redraw.waitEvents();
+
 		/* input */
 		processInput(window);
 
+		/* nothing changed: keep the frame that is on the screen */
+		if (!redraw.beginFrame())
+			continue;
+
 		/* rendering commands next: */
 		
 		/* - We want to clear the screen with a color of our choice. At the
@@ -104,11 +124,8 @@ int main()
 		color values for each pixel in GLFW’s window) that is used to render to during this
 			render iteration and show it as output to the screen */
 		glfwSwapBuffers(window);
-		/* - The glfwPollEvents function checks if any events are triggered
-		(like keyboard input or mouse movement events), updates the window state,
-			and calls the corresponding functions (which we can register via callback methods) */
-		glfwPollEvents();
 	}
+	redraw.report();
 
 	/* - As soon as we exit the render loop we would like to properly clean/delete all of
 	GLFW’s resources that were allocated */
@@ -3,7 +3,16 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <learnopengl/frame_profiler.h>
+#include <learnopengl/gl_window.h>
+#include <learnopengl/gpu_culling.h>
+#include <learnopengl/program_cache.h>
+#include <learnopengl/shader_batch.h>
+#include <learnopengl/stream_buffer.h>
+
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
@@ -12,6 +21,21 @@ void processInput(GLFWwindow *window);
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// compares compiling the shader program from source with restoring it from the on-disk program cache
+const bool PROGRAM_CACHE = false;
+
+// frame profiler: the statistics are printed when the window closes
+const bool SHOW_PROFILER_OVERLAY = false; // draws the frame times as a graph in the bottom left corner
+const char *PROFILER_CSV_PATH = NULL;     // e.g. "frame_times.csv" to dump every measurement
+
+// streams the vertices through a StreamBuffer every frame (the triangle pulses) instead of drawing the static VBO
+const bool STREAM_VERTICES = false;
+
+// draws a field of CULLING_OBJECTS small triangles behind the big one, spread over an area much larger than the
+// screen while the view pans over it, and culls them against the view in a compute shader (needs OpenGL 4.3)
+const bool GPU_CULLING = false;
+const int CULLING_OBJECTS = 100000;
+
 /* Stages of the graphics pipeline:
 1) Vertex Shader
 2) Shape Assembly
@@ -103,7 +127,9 @@ int main()
 
     // glfw window creation
     // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    // GPU_CULLING asks for a 4.3 context, and gets the 3.3 one when the driver can't give it (see learnopengl/gl_window.h)
+    GLFWwindow* window = GPU_CULLING ? createWindowPreferring(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", 4, 3)
+                                     : glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
     if (window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -120,7 +146,11 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
 
+    ProgramCache programCache;
+    double buildStart = glfwGetTime();
 
     // +++ Build and compile our "Vertex Shader"
     // -------------------------------------------------------------------------------
@@ -180,6 +210,7 @@ int main()
     then link them with <glLinkProgram>. */
     glAttachShader(shaderProgram, vertexShader);
     glAttachShader(shaderProgram, fragmentShader);
+    programCache.prepare(shaderProgram); // keep the linked binary retrievable for the program cache below
     glLinkProgram(shaderProgram);
     /* - The result is a program object that we can activate by calling glUseProgram with the newly
     created program object as its argument:
@@ -198,6 +229,28 @@ int main()
     object; we no longer need them anymore. */
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+
+    /* - Compiling and linking like this happens on every launch, and with many shaders it dominates the
+    startup time. The program cache stores the linked program with glGetProgramBinary, keyed by the sources
+    and the driver, so a later launch can restore it with glProgramBinary instead of doing all of the above
+    (the Shader class of the next samples does exactly that). Here we store the program we just built and
+    restore it right away, to see how the two compare. */
+    if (PROGRAM_CACHE)
+    {
+        double compileMs = 1000.0 * (glfwGetTime() - buildStart);
+        programCache.store(shaderProgram, vertexShaderSource, fragmentShaderSource);
+        double restoreStart = glfwGetTime();
+        unsigned int restored = programCache.load(vertexShaderSource, fragmentShaderSource);
+        double restoreMs = 1000.0 * (glfwGetTime() - restoreStart);
+        std::cout << "shader program compiled and linked from source in " << compileMs << " ms";
+        if (restored != 0)
+        {
+            glDeleteProgram(shaderProgram);
+            shaderProgram = restored;
+            std::cout << ", restored from the program cache in " << restoreMs << " ms";
+        }
+        std::cout << std::endl;
+    }
     /* - Right now we sent the input vertex data to the GPU and instructed the GPU how it should
     process the vertex data within a vertex and fragment shader. We’re almost there, but not quite yet.
     OpenGL does not yet know how it should interpret the vertex data in memory and how it should connect
@@ -333,16 +386,81 @@ int main()
     // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
     // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
     glBindVertexArray(0); 
+
+    /* - Data that changes every frame goes through a ring buffer instead: the same attribute pointer, but
+    sourced from the StreamBuffer, and every frame draws from wherever this frame's vertices were written. */
+    StreamBuffer* streamBuffer = NULL;
+    if (STREAM_VERTICES)
+    {
+        streamBuffer = new StreamBuffer(64 * 1024);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffer->ID);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
     // ----------------------------------------------------------------------------------------------------
 
 
     // uncomment this call to draw in wireframe polygons.
     //glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
+    /* - The frame profiler measures how long each frame takes on the CPU, and how long the GPU spends on
+    the draw call (with GL_TIME_ELAPSED queries that are read back a few frames later, so we never wait for them). */
+    FrameProfiler profiler;
+    if (PROFILER_CSV_PATH)
+        profiler.openCsv(PROFILER_CSV_PATH);
+
+    /* - Everything we draw goes through the vertex shader, and whatever ends up outside the screen is only
+    thrown away after that, by clipping. For a handful of triangles that is fine; for a field of 100000 of
+    which only a few percent are in view, the vertex stage mostly works for nothing. The GpuCuller tests the
+    bounding sphere of every object against the view in a compute shader and writes the draw commands of
+    the visible ones only, which one indirect draw call then consumes. */
+    MeshPool* cullingPool = NULL;
+    MultiDrawBatch* cullingBatch = NULL;
+    GpuCuller* culler = NULL;
+    ShaderBatch cullingShaders;
+    int cullingShader = -1;
+    unsigned int cullingProgram = 0;
+    int viewOffsetLocation = -1;
+    if (GPU_CULLING && multiDrawIndirectSupported())
+    {
+        unsigned int triangleIndices[] = { 0, 1, 2 };
+        cullingPool = new MeshPool(3, 3);
+        int triangleMesh = cullingPool->add(vertices, 3, triangleIndices, 3);
+        cullingBatch = new MultiDrawBatch(*cullingPool);
+        std::vector<BoundingSphere> bounds(CULLING_OBJECTS);
+        for (int i = 0; i < CULLING_OBJECTS; i++)
+        {
+            // scattered over [-8, 8] in both directions, 64 times the area of the screen
+            DrawData data;
+            data.offsetScale[0] = -8.0f + 16.0f * (float)(((long long)i * 7919) % CULLING_OBJECTS) / CULLING_OBJECTS;
+            data.offsetScale[1] = -8.0f + 16.0f * (float)(((long long)i * 104729) % CULLING_OBJECTS) / CULLING_OBJECTS;
+            data.offsetScale[2] = data.offsetScale[3] = 0.05f;
+            data.color[0] = 0.5f; data.color[1] = 0.8f; data.color[2] = 1.0f; data.color[3] = 1.0f;
+            cullingBatch->add(triangleMesh, data);
+            bounds[i].center[0] = data.offsetScale[0];
+            bounds[i].center[1] = data.offsetScale[1];
+            bounds[i].center[2] = 0.0f;
+            bounds[i].radius = 0.05f * 0.71f; // the triangle spans [-0.5, 0.5] before scaling
+        }
+        cullingBatch->upload();
+        culler = new GpuCuller(*cullingPool);
+        culler->upload(*cullingBatch, bounds);
+        cullingShader = cullingShaders.submit(multiDrawVertexShader(true), multiDrawFragmentSource);
+    }
+    else if (GPU_CULLING)
+    {
+        std::cout << "ERROR::GPU_CULLING::NOT_SUPPORTED: needs OpenGL 4.3, drawing the single triangle" << std::endl;
+    }
+    int cullingFrames = 0;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
     {
+        profiler.beginFrame();
+
         // input
         // -----
         processInput(window);
@@ -352,29 +470,96 @@ int main()
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
+        if (culler)
+        {
+            if (cullingShaders.pending() > 0)
+            {
+                cullingShaders.poll();
+                cullingProgram = cullingShaders.program(cullingShader);
+                viewOffsetLocation = cullingProgram ? glGetUniformLocation(cullingProgram, "viewOffset") : -1;
+            }
+            if (cullingProgram != 0)
+            {
+                profiler.beginGpu("culling");
+                // the view pans in a circle; the frustum is the screen moved by the same offset
+                float viewX = 4.0f * (float)sin(glfwGetTime() * 0.5), viewY = 4.0f * (float)cos(glfwGetTime() * 0.5);
+                float view[16] = { 1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,  0.0f, 0.0f, 1.0f, 0.0f,  -viewX, -viewY, 0.0f, 1.0f };
+                float planes[6][4];
+                frustumPlanes(view, planes);
+                culler->cull(planes);
+                glUseProgram(cullingProgram);
+                glUniform2f(viewOffsetLocation, viewX, viewY);
+                culler->draw(*cullingBatch);
+                profiler.endGpu();
+                // reading the count back waits for the GPU, so only do it now and then
+                if (++cullingFrames % 300 == 0 && culler->compacting())
+                    std::cout << "culling: " << culler->readVisibleCount() << " of " << CULLING_OBJECTS << " objects visible" << std::endl;
+            }
+        }
+
         // draw our first triangle
+        profiler.beginCpu("draw");
+        profiler.beginGpu("draw");
         /* Run the "shaderProgram". */
         glUseProgram(shaderProgram);
         glBindVertexArray(VAO); // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
+        int firstVertex = 0;
+        if (streamBuffer)
+        {
+            float* streamed = (float*)streamBuffer->map(sizeof(vertices), 3 * sizeof(float));
+            float scale = 0.75f + 0.25f * (float)sin(glfwGetTime() * 2.0);
+            for (int i = 0; i < 9; i++)
+                streamed[i] = vertices[i] * scale;
+            streamBuffer->unmap();
+            firstVertex = (int)(streamBuffer->offset() / (3 * sizeof(float)));
+        }
         /* - The <glDrawArrays> function takes as its first argument the OpenGL primitive type we would
         like to draw. Since I said at the start we wanted to draw a triangle, and I don’t like lying to you, we
         pass in GL_TRIANGLES. The second argument specifies the starting index of the vertex array we’d
         like to draw; we just leave this at 0. The last argument specifies how many vertices we want to draw,
         which is 3 (we only render 1 triangle from our data, which is exactly 3 vertices long. */
-        glDrawArrays(GL_TRIANGLES, 0, 3); /* Draws primitives using the currently active shader */
+        glDrawArrays(GL_TRIANGLES, firstVertex, 3); /* Draws primitives using the currently active shader */
+        if (streamBuffer)
+            streamBuffer->endFrame();
         // glBindVertexArray(0); // no need to unbind it every time 
+        profiler.endGpu();
+        profiler.endCpu("draw");
+
+        if (SHOW_PROFILER_OVERLAY)
+            profiler.drawOverlay();
  
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
+        profiler.beginCpu("swap");
         glfwSwapBuffers(window);
+        profiler.endCpu("swap");
+        profiler.endFrame();
         glfwPollEvents();
     }
+    profiler.report();
+    profiler.release();
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    if (streamBuffer)
+    {
+        streamBuffer->release();
+        delete streamBuffer;
+    }
     glDeleteProgram(shaderProgram);
+    if (culler)
+    {
+        culler->release();
+        cullingBatch->release();
+        cullingPool->release();
+        delete culler;
+        delete cullingBatch;
+        delete cullingPool;
+        glDeleteProgram(cullingProgram);
+    }
+    cullingShaders.release();
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
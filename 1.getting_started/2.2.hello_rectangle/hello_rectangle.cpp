@@ -2,15 +2,31 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <learnopengl/gl_window.h>
+#include <learnopengl/multi_draw.h>
+#include <learnopengl/shader_batch.h>
+#include <learnopengl/stream_buffer.h>
+
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
+void drawStreamed(StreamBuffer& streamBuffer, const float* vertices, const unsigned int* indices);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// streams vertices and indices through a StreamBuffer every frame (the rectangle sways) instead of the static VBO/EBO
+const bool STREAM_VERTICES = false;
+
+// draws MULTI_DRAW_OBJECTS rectangles and triangles, suballocated from one shared vertex/index buffer, with a
+// single glMultiDrawElementsIndirect (needs OpenGL 4.3)
+const bool MULTI_DRAW_INDIRECT = false;
+const int MULTI_DRAW_OBJECTS = 1024;
+
 const char *vertexShaderSource = "#version 330 core\n"
     "layout (location = 0) in vec3 aPos;\n"
     "void main()\n"
@@ -39,7 +55,9 @@ int main()
 
     // glfw window creation
     // --------------------
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    // MULTI_DRAW_INDIRECT asks for a 4.3 context, and gets the 3.3 one when the driver can't give it (see learnopengl/gl_window.h)
+    GLFWwindow* window = MULTI_DRAW_INDIRECT ? createWindowPreferring(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", 4, 3)
+                                             : glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
     if (window == NULL)
     {
         std::cout << "Failed to create GLFW window" << std::endl;
@@ -56,6 +74,7 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
 
     // build and compile our shader program
@@ -151,6 +170,68 @@ int main()
     // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
     glBindVertexArray(0); 
 
+    // the streamed version sources both the vertices and the indices from one ring buffer
+    StreamBuffer* streamBuffer = NULL;
+    if (STREAM_VERTICES)
+    {
+        streamBuffer = new StreamBuffer(64 * 1024);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, streamBuffer->ID);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, streamBuffer->ID);
+        glBindVertexArray(0);
+    }
+
+    /* - With many objects, one glDrawElements each costs CPU time for every single object. The multi-draw
+    version puts every mesh into one MeshPool (one VBO, one EBO, one VAO), writes one indirect command per
+    object into a GL_DRAW_INDIRECT_BUFFER and the per-object offset and color into a shader storage buffer,
+    and then the whole grid is a single draw call. */
+    MeshPool* meshPool = NULL;
+    MultiDrawBatch* multiDraw = NULL;
+    /* - Checking GL_COMPILE_STATUS right after glCompileShader, as we did above, makes us wait for the
+    compiler, one shader at a time. For the multi-draw program we use a ShaderBatch instead: it submits the
+    sources and links without asking, and the driver compiles them on its own threads
+    (GL_KHR_parallel_shader_compile). Every frame we poll whether the program is done, and only draw the
+    grid once it is. */
+    ShaderBatch shaderBatch;
+    int multiDrawShader = -1;
+    unsigned int multiDrawProgram = 0;
+    if (MULTI_DRAW_INDIRECT && multiDrawIndirectSupported())
+    {
+        float triangle[] = {
+            -0.5f, -0.5f, 0.0f,
+             0.5f, -0.5f, 0.0f,
+             0.0f,  0.5f, 0.0f
+        };
+        unsigned int triangleIndices[] = { 0, 1, 2 };
+        meshPool = new MeshPool(1024, 1024);
+        int rectangleMesh = meshPool->add(vertices, 4, indices, 6);
+        int triangleMesh = meshPool->add(triangle, 3, triangleIndices, 3);
+
+        multiDraw = new MultiDrawBatch(*meshPool);
+        int side = (int)ceil(sqrt((double)MULTI_DRAW_OBJECTS));
+        float size = 2.0f / side;
+        for (int i = 0; i < MULTI_DRAW_OBJECTS; i++)
+        {
+            DrawData data;
+            data.offsetScale[0] = -1.0f + (i % side + 0.5f) * size;
+            data.offsetScale[1] = -1.0f + (i / side + 0.5f) * size;
+            data.offsetScale[2] = data.offsetScale[3] = size * 0.9f;
+            data.color[0] = 1.0f;
+            data.color[1] = 0.5f * (i % side) / side + 0.25f;
+            data.color[2] = 0.2f + 0.6f * (i / side) / side;
+            data.color[3] = 1.0f;
+            multiDraw->add(i % 2 ? triangleMesh : rectangleMesh, data);
+        }
+        multiDraw->upload();
+        multiDrawShader = shaderBatch.submit(multiDrawVertexShader(), multiDrawFragmentSource);
+    }
+    else if (MULTI_DRAW_INDIRECT)
+    {
+        std::cout << "ERROR::MULTI_DRAW::NOT_SUPPORTED: glMultiDrawElementsIndirect needs OpenGL 4.3, drawing the single rectangle" << std::endl;
+    }
+
     // uncomment this call to draw in wireframe polygons.
     // glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
     /* - "Wireframe mode": instead of drawing the triangles with color inside, we only draw the border.
@@ -217,8 +298,26 @@ int main()
         |______________________|                                          index data
 
         - A VAO stores the glBindBuffer calls when the target is GL_ELEMENT_ARRAY_BUFFER. */
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        if (streamBuffer)
+            drawStreamed(*streamBuffer, vertices, indices);
+        else
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
         // glBindVertexArray(0); // no need to unbind it every time 
+
+        // and over it the whole grid, in one draw call, once the batch finished its program
+        if (multiDraw)
+        {
+            if (shaderBatch.pending() > 0)
+            {
+                shaderBatch.poll();
+                multiDrawProgram = shaderBatch.program(multiDrawShader);
+            }
+            if (multiDrawProgram != 0)
+            {
+                glUseProgram(multiDrawProgram);
+                multiDraw->draw();
+            }
+        }
  
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -231,7 +330,21 @@ int main()
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    if (streamBuffer)
+    {
+        streamBuffer->release();
+        delete streamBuffer;
+    }
     glDeleteProgram(shaderProgram);
+    if (multiDraw)
+    {
+        shaderBatch.release();
+        multiDraw->release();
+        meshPool->release();
+        delete multiDraw;
+        delete meshPool;
+        glDeleteProgram(multiDrawProgram);
+    }
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -255,3 +368,20 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     // height will be significantly larger than specified on retina displays.
     glViewport(0, 0, width, height);
 }
+
+// the streamed draw: writes this frame's vertices (the top edge sways) and the indices into the ring buffer,
+// and draws them from wherever they were written
+// ---------------------------------------------------------------------------------------------------------
+void drawStreamed(StreamBuffer& streamBuffer, const float* vertices, const unsigned int* indices)
+{
+    float* streamed = (float*)streamBuffer.map(12 * sizeof(float), 3 * sizeof(float));
+    float sway = 0.25f * (float)sin(glfwGetTime());
+    for (int i = 0; i < 12; i++)
+        streamed[i] = vertices[i] + (i % 3 == 0 && vertices[i + 1] > 0.0f ? sway : 0.0f);
+    streamBuffer.unmap();
+    int baseVertex = (int)(streamBuffer.offset() / (3 * sizeof(float)));
+    std::memcpy(streamBuffer.map(6 * sizeof(unsigned int), sizeof(unsigned int)), indices, 6 * sizeof(unsigned int));
+    streamBuffer.unmap();
+    glDrawElementsBaseVertex(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)streamBuffer.offset(), baseVertex);
+    streamBuffer.endFrame();
+}
@@ -3,16 +3,44 @@ by updating the uniform value each frame, before drawing. */
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <learnopengl/frame_pipeline.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/program_cache.h>
+#include <learnopengl/uniform_arena.h>
+
 #include <iostream>
 #include <cmath>
+#include <string>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void processInput(GLFWwindow *window);
+void benchmarkUniformUpdate(unsigned int shaderProgram, int cachedLocation, float greenValue);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// set to true to print the per-frame CPU time of the uniform update, with and without the cached location
+const bool UNIFORM_BENCHMARK = false;
+const int UNIFORM_BENCHMARK_UPDATES = 1000; // uniform updates per frame while benchmarking, so the difference is measurable
+
+// set to true to pass the color (and a shared per-frame block) through uniform buffers instead of glUniform4f
+const bool UNIFORM_BUFFERS = false;
+
+// set to true to update on the main thread at SIMULATION_TICK_RATE and draw on a render thread of its own
+// (see learnopengl/frame_pipeline.h); input is then sampled at the tick rate, whatever the swap interval
+const bool DECOUPLED_THREADS = false;
+const double SIMULATION_TICK_RATE = 120.0;
+
+// everything a frame is drawn from, produced by the update and handed to the drawing as a whole
+struct FrameSnapshot
+{
+    double time;
+    double deltaTime;
+    float greenValue;
+    int width, height; // of the framebuffer
+};
+
 /* - Shaders are written in the C-like language GLSL. GLSL is tailored for use with graphics and contains
 useful features specifically targeted at vector and matrix manipulation.
 - Shaders always begin with a version declaration, followed by a list of input and output variables,
@@ -104,6 +132,21 @@ const char *fragmentShaderSource = "#version 330 core\n"
     "{\n"
     "   FragColor = ourColor;\n"
     "}\n\0";
+/* - The same two shaders with uniform blocks (see learnopengl/uniform_arena.h). FrameUniforms holds what every
+program of a frame shares, ObjectUniforms what changes per draw; the blocks are declared once, in C++ next to
+the structs that are copied into them. */
+const std::string uboVertexShaderSource = std::string("#version 330 core\n") + frameUniformsBlock +
+    "layout (location = 0) in vec3 aPos;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = viewProjection * vec4(aPos, 1.0);\n"
+    "}\n";
+const std::string uboFragmentShaderSource = std::string("#version 330 core\n") + objectUniformsBlock +
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = color;\n"
+    "}\n";
 
 int main()
 {
@@ -137,46 +180,60 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // build and compile our shader program
     // ------------------------------------
-    // vertex shader
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    // check for shader compile errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    // fragment shader
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    // check for shader compile errors
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    // restore the program from the binary cache of an earlier run, or build it and store it there
+    ProgramCache programCache;
+    const char* vertexSource = UNIFORM_BUFFERS ? uboVertexShaderSource.c_str() : vertexShaderSource;
+    const char* fragmentSource = UNIFORM_BUFFERS ? uboFragmentShaderSource.c_str() : fragmentShaderSource;
+    double buildStart = glfwGetTime();
+    unsigned int shaderProgram = programCache.load(vertexSource, fragmentSource);
+    if (shaderProgram == 0)
     {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    // link shaders
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    // check for linking errors
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        // vertex shader
+        unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertexShader, 1, &vertexSource, NULL);
+        glCompileShader(vertexShader);
+        // check for shader compile errors
+        int success;
+        char infoLog[512];
+        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        // fragment shader
+        unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
+        glCompileShader(fragmentShader);
+        // check for shader compile errors
+        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        // link shaders
+        shaderProgram = glCreateProgram();
+        glAttachShader(shaderProgram, vertexShader);
+        glAttachShader(shaderProgram, fragmentShader);
+        programCache.prepare(shaderProgram); // keep the linked binary retrievable for the cache
+        glLinkProgram(shaderProgram);
+        // check for linking errors
+        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        }
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        programCache.store(shaderProgram, vertexSource, fragmentSource);
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    std::cout << "shader program ready in " << 1000.0 * (glfwGetTime() - buildStart) << " ms ("
+              << (programCache.hits > 0 ? "warm start: restored from the program cache" : "cold start: compiled from source") << ")" << std::endl;
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -207,29 +264,66 @@ int main()
     // just bind it beforehand before rendering the respective triangle; this is another approach.
     glBindVertexArray(VAO);
 
+    /* - Query the location of the ourColor uniform once, before the render loop. A uniform location
+    never changes after the program is linked, so calling glGetUniformLocation every frame only adds
+    a string lookup inside the driver to each iteration. (The Shader class in learnopengl/shader_s.h
+    does the same for all of its uniforms right after linking.) */
+    int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
+
+    /* - With UNIFORM_BUFFERS the blocks of the program are pointed at fixed binding points once, and every
+    frame the arena copies the block data into one large buffer and binds the ranges there. The frame block
+    is pushed once per frame no matter how many programs read it. */
+    UniformArena* uniformArena = NULL;
+    if (UNIFORM_BUFFERS)
+    {
+        bindUniformBlock(shaderProgram, "FrameUniforms", FRAME_UNIFORMS_BINDING, sizeof(FrameUniforms));
+        bindUniformBlock(shaderProgram, "ObjectUniforms", OBJECT_UNIFORMS_BINDING, sizeof(ObjectUniforms));
+        uniformArena = new UniformArena(4096);
+    }
+
+    /* - The program stays bound from one frame to the next. GLState remembers what was bound last and
+    drops the calls that would not change anything, so the glUseProgram below only reaches the driver once. */
+    GLState glState;
 
-    // render loop
-    // -----------
-    while (!glfwWindowShouldClose(window))
+    // the update: reads the time and the window, and leaves the drawing nothing to ask GLFW
+    // ---------------------------------------------------------------------------------------
+    double lastTime = glfwGetTime();
+    auto update = [&](FrameSnapshot& frame)
     {
-        // input
-        // -----
-        processInput(window);
+        frame.time = glfwGetTime();
+        frame.deltaTime = frame.time - lastTime;
+        frame.greenValue = static_cast<float>(sin(frame.time) / 2.0 + 0.5); // (0.0-1.0)
+        glfwGetFramebufferSize(window, &frame.width, &frame.height);
+        lastTime = frame.time;
+    };
+
+    // the drawing: only GL calls and the swap, from the snapshot it is given
+    // ----------------------------------------------------------------------
+    int viewportWidth = 0, viewportHeight = 0;
+    auto draw = [&](const FrameSnapshot& frame)
+    {
+        if (frame.width != viewportWidth || frame.height != viewportHeight)
+        {
+            glViewport(0, 0, frame.width, frame.height);
+            viewportWidth = frame.width;
+            viewportHeight = frame.height;
+        }
 
         // render
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glState.clearColor(0.2f, 0.3f, 0.3f, 1.0f);
         // clear the colorbuffer
         glClear(GL_COLOR_BUFFER_BIT);
 
         // be sure to activate the shader before any calls to glUniform
-        glUseProgram(shaderProgram);
+        glState.useProgram(shaderProgram);
 
         // update shader uniform
         /* - Once we have the index/location of the uniform, we can update its values. Instead of passing a
         single color to the fragment shader, let’s spice things up by gradually changing color over time.
         - First, we retrieve the running time in seconds via glfwGetTime(). Then we vary the color in the
         range of (0.0-1.0) by using the sin function and store the result in greenValue.
-        - Then we query for the location of the ourColor uniform using glGetUniformLocation.
+        - Then we use the location of the ourColor uniform, which we queried with glGetUniformLocation
+        before the render loop.
         We supply the shader program and the name of the uniform (that we want to retrieve the location from)
         to the query function. If glGetUniformLocation returns -1, it could not find the location.
         - Lastly we can set the uniform value using the glUniform4f function. Note that finding the
@@ -257,18 +351,90 @@ int main()
             green to black and back to green.
             - As you can see, uniforms are a useful tool for setting attributes that may change every frame,
             or for interchanging data between your application and your shaders. */
-        double  timeValue = glfwGetTime();
-        float greenValue = static_cast<float>(sin(timeValue) / 2.0 + 0.5); // (0.0-1.0)
-        int vertexColorLocation = glGetUniformLocation(shaderProgram, "ourColor");
-        glUniform4f(vertexColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
+        float greenValue = frame.greenValue;
+        if (UNIFORM_BENCHMARK)
+            benchmarkUniformUpdate(shaderProgram, vertexColorLocation, greenValue);
+        if (uniformArena)
+        {
+            FrameUniforms block = {};
+            for (int i = 0; i < 4; i++)
+                block.viewProjection[i * 5] = 1.0f; // identity, the triangle is already in clip space
+            block.viewport[2] = (float)frame.width;
+            block.viewport[3] = (float)frame.height;
+            block.time = (float)frame.time;
+            block.deltaTime = (float)frame.deltaTime;
+            uniformArena->push(FRAME_UNIFORMS_BINDING, block);
+            ObjectUniforms object = { { 0.0f, greenValue, 0.0f, 1.0f } };
+            uniformArena->push(OBJECT_UNIFORMS_BINDING, object);
+        }
+        else
+        {
+            glUniform4f(vertexColorLocation, 0.0f, greenValue, 0.0f, 1.0f);
+        }
 
         // render the triangle
         glDrawArrays(GL_TRIANGLES, 0, 3);
+        if (uniformArena)
+            uniformArena->endFrame();
 
-        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
-        // -------------------------------------------------------------------------------
         glfwSwapBuffers(window);
-        glfwPollEvents();
+    };
+
+    if (DECOUPLED_THREADS)
+    {
+        /* - The main thread polls events, reads the input and updates at a fixed rate, and publishes the result
+        as a snapshot; the render thread draws the latest snapshot whenever it is ready for the next frame.
+        Neither waits for the other: a blocking swap no longer delays the input, a slow update no longer
+        delays the swap. The first snapshot is published before the render thread starts. */
+        TripleBuffer<FrameSnapshot> snapshots;
+        update(snapshots.write());
+        snapshots.publish();
+        glfwMakeContextCurrent(NULL); // the context moves to the render thread
+        RenderThread renderThread(window, [&]()
+        {
+            snapshots.acquire();
+            draw(snapshots.read());
+        });
+        FixedTicker ticker(SIMULATION_TICK_RATE);
+        while (!glfwWindowShouldClose(window))
+        {
+            glfwPollEvents();
+            processInput(window);
+            update(snapshots.write());
+            snapshots.publish();
+            ticker.wait();
+        }
+        renderThread.stop();
+        glfwMakeContextCurrent(window);
+        std::cout << "decoupled threads: " << ticker.ticks << " ticks (" << ticker.skipped << " late), "
+                  << renderThread.frames() << " frames, " << snapshots.published - snapshots.consumed
+                  << " snapshots replaced before they were drawn" << std::endl;
+    }
+    else
+    {
+        // render loop
+        // -----------
+        while (!glfwWindowShouldClose(window))
+        {
+            // input
+            // -----
+            processInput(window);
+
+            FrameSnapshot frame;
+            update(frame);
+            draw(frame);
+
+            // glfw: poll IO events (keys pressed/released, mouse moved etc.); draw() swapped the buffers
+            // -----------------------------------------------------------------------------------------
+            glfwPollEvents();
+        }
+    }
+    glState.report();
+    if (uniformArena)
+    {
+        std::cout << "uniform arena: " << uniformArena->stalls() << " stalls" << std::endl;
+        uniformArena->release();
+        delete uniformArena;
     }
 
     // optional: de-allocate all resources once they've outlived their purpose:
@@ -291,11 +457,41 @@ void processInput(GLFWwindow *window)
         glfwSetWindowShouldClose(window, true);
 }
 
+// times UNIFORM_BENCHMARK_UPDATES uniform updates that look the location up every time against the
+// same updates through the cached location, and prints the average CPU time per frame every 120 frames
+// ---------------------------------------------------------------------------------------------------------
+void benchmarkUniformUpdate(unsigned int shaderProgram, int cachedLocation, float greenValue)
+{
+    static double lookupTime = 0.0, cachedTime = 0.0;
+    static int frames = 0;
+
+    double start = glfwGetTime();
+    for (int i = 0; i < UNIFORM_BENCHMARK_UPDATES; i++)
+        glUniform4f(glGetUniformLocation(shaderProgram, "ourColor"), 0.0f, greenValue, 0.0f, 1.0f);
+    double middle = glfwGetTime();
+    for (int i = 0; i < UNIFORM_BENCHMARK_UPDATES; i++)
+        glUniform4f(cachedLocation, 0.0f, greenValue, 0.0f, 1.0f);
+    double end = glfwGetTime();
+
+    lookupTime += middle - start;
+    cachedTime += end - middle;
+    if (++frames == 120)
+    {
+        std::cout << "uniform update CPU time per frame (" << UNIFORM_BENCHMARK_UPDATES << " updates): "
+                  << "glGetUniformLocation " << 1000.0 * lookupTime / frames << " ms, "
+                  << "cached location " << 1000.0 * cachedTime / frames << " ms" << std::endl;
+        lookupTime = cachedTime = 0.0;
+        frames = 0;
+    }
+}
+
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
     // make sure the viewport matches the new window dimensions; note that width and 
     // height will be significantly larger than specified on retina displays.
-    glViewport(0, 0, width, height);
+    // With DECOUPLED_THREADS the context is current on the render thread, which sets the viewport itself.
+    if (glfwGetCurrentContext() == window)
+        glViewport(0, 0, width, height);
 }
@@ -1,6 +1,8 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <learnopengl/gl_state.h>
+#include <learnopengl/hot_reload.h>
 #include <learnopengl/shader_s.h>
 
 #include <iostream>
@@ -12,6 +14,10 @@ void processInput(GLFWwindow *window);
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// recompiles the shader whenever 3.3.shader.vs or 3.3.shader.fs is saved while the sample runs (see
+// learnopengl/hot_reload.h); a shader that fails to compile is reported and the previous one stays
+const bool HOT_RELOAD = false;
+
 int main()
 {
     // glfw: initialize and configure
@@ -44,13 +50,26 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
 
     // build and compile our shader program
     // ------------------------------------
     /* - And there we have it, a completed shader class at /includes/learnopeng/shader_s.h. Using the shader class
     is fairly easy; we create a shader object once and from that point on simply start using it.
     - Here we stored the vertex and fragment shader source code in two files called shader.vs and shader.fs. */
-    Shader ourShader("3.3.shader.vs", "3.3.shader.fs"); // you can name your shader files however you like
+    /* - Passing a ProgramCache makes the class store the linked program with glGetProgramBinary, so the next
+    launch restores it instead of compiling the shader files again. */
+    ProgramCache programCache;
+    double buildStart = glfwGetTime();
+    Shader ourShader("3.3.shader.vs", "3.3.shader.fs", &programCache); // you can name your shader files however you like
+    std::cout << "shader program ready in " << 1000.0 * (glfwGetTime() - buildStart) << " ms ("
+              << (programCache.hits > 0 ? "warm start: restored from the program cache" : "cold start: compiled from source") << ")" << std::endl;
+    HotReloader* hotReloader = NULL;
+    if (HOT_RELOAD)
+    {
+        hotReloader = new HotReloader(&programCache);
+        hotReloader->watchShader(ourShader, "3.3.shader.vs", "3.3.shader.fs");
+    }
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
@@ -84,20 +103,26 @@ int main()
 
     // render loop
     // -----------
+    // the state never changes between frames, so after the first one every call below is skipped
+    GLState glState;
     while (!glfwWindowShouldClose(window))
     {
         // input
         // -----
         processInput(window);
 
+        // swap in the shader if it was edited; the program changes behind glState's back
+        if (hotReloader && hotReloader->update() > 0)
+            glState.invalidate();
+
         // render
         // ------
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glState.clearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
         // render the triangle
-        ourShader.use();
-        glBindVertexArray(VAO);
+        glState.useProgram(ourShader.ID);
+        glState.bindVertexArray(VAO);
         glDrawArrays(GL_TRIANGLES, 0, 3);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -105,11 +130,15 @@ int main()
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
+    glState.report();
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    if (hotReloader)
+        hotReloader->release();
+    delete hotReloader;
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -0,0 +1,778 @@
+/* The scene of 4.1.textures (the container quad) with the performance features of the shared headers wired in,
+each behind one of the settings below, so they can be tried and measured alone or together while 4.1.textures
+stays a texturing tutorial. With the defaults the loop draws what 4.1.textures draws, through the state cache,
+draw queue, profiler and pacer. perf_playground.vs/fs are 4.1.texture.vs/fs with the #defines of TextureFeature,
+perf_playground_instanced.vs/fs their instanced version for the stress mode. */
+
+// counts every operator new of the sample per subsystem, not only the growth of the pools and arenas (see
+// learnopengl/frame_allocator.h); it has to come before the includes
+// #define FRAME_ALLOCATOR_REPLACE_NEW
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <learnopengl/asset_pack.h>
+#include <learnopengl/bindless_textures.h>
+#include <learnopengl/compressed_texture.h>
+#include <learnopengl/draw_queue.h>
+#include <learnopengl/dynamic_resolution.h>
+#include <learnopengl/filesystem.h>
+#include <learnopengl/frame_allocator.h>
+#include <learnopengl/frame_pacer.h>
+#include <learnopengl/frame_profiler.h>
+#include <learnopengl/gl_capture.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/gl_window.h>
+#include <learnopengl/gpu_resources.h>
+#include <learnopengl/hot_reload.h>
+#include <learnopengl/instanced_quads.h>
+#include <learnopengl/job_system.h>
+#include <learnopengl/program_cache.h>
+#include <learnopengl/redraw_scheduler.h>
+#include <learnopengl/shader_s.h>
+#include <learnopengl/shader_variants.h>
+#include <learnopengl/simd_kernels.h>
+#include <learnopengl/texture_atlas.h>
+#include <learnopengl/texture_residency.h>
+#include <learnopengl/texture_streamer.h>
+#include <learnopengl/vertex_format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// an image decoded to RGBA8 by decodeImages(); pixels is NULL if it failed, and freed with stbi_image_free
+struct DecodedImage
+{
+    int width = 0, height = 0;
+    unsigned char* pixels = NULL;
+};
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow *window);
+std::vector<DecodedImage> decodeImages(JobSystem* jobs, const char* const* paths, size_t count);
+bool createAtlas(TextureAtlas& atlas, JobSystem* jobs);
+void assignAtlasRegions(std::vector<QuadInstance>& instances, const TextureAtlas& atlas, JobSystem* jobs);
+unsigned int createTexture(DecodedImage& image);
+void assignBindlessHandles(BindlessTextures& bindless, size_t count);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// frame profiler: the statistics are printed when the window closes
+const bool SHOW_PROFILER_OVERLAY = false; // draws the frame times as a graph in the bottom left corner
+const char *PROFILER_CSV_PATH = NULL;     // e.g. "frame_times.csv" to dump every measurement
+
+// frame pacing (see learnopengl/frame_pacer.h): PACING_VSYNC, PACING_ADAPTIVE_VSYNC, PACING_UNLOCKED or
+// PACING_LOW_LATENCY, at FRAME_RATE_LIMIT frames per second at most (0 for no limit); the input latency and the
+// pacing waits are part of the profiler statistics
+const PacingMode PACING_MODE = PACING_VSYNC;
+const double FRAME_RATE_LIMIT = 0.0;
+
+// draws a frame only when something changed (input, a resize, an upload or a hot reload) and otherwise sleeps
+// in glfwWaitEventsTimeout (see learnopengl/redraw_scheduler.h); the stress mode always draws
+const bool ON_DEMAND_RENDERING = false;
+
+// renders the scene into an offscreen target at a resolution that keeps its GPU time at
+// DYNAMIC_RESOLUTION_TARGET_MS, and scales it up to the window with a sharpening pass (see
+// learnopengl/dynamic_resolution.h); the profiler overlay is still drawn at the full resolution
+const bool DYNAMIC_RESOLUTION = false;
+const float DYNAMIC_RESOLUTION_TARGET_MS = 8.0f;
+
+// zero allocation policy: every frame after the first ZERO_ALLOCATION_AFTER_FRAMES that allocates on the heap is
+// reported with the subsystems it allocated in (the stress steps and hot reloads are exempt); the totals per
+// subsystem are printed when the window closes
+const unsigned long ZERO_ALLOCATION_AFTER_FRAMES = 120;
+
+// instancing stress mode: draws the container as a grid of instanced quads, doubling the count from 1 to
+// 1M every STRESS_FRAMES_PER_STEP frames (without vsync) and printing the throughput of each step
+const bool INSTANCING_STRESS = false;
+const int STRESS_FRAMES_PER_STEP = 120;
+const size_t STRESS_MAX_INSTANCES = 1 << 20;
+
+// samples the container from an array texture atlas (learnopengl/texture_atlas.h) instead of its own texture;
+// in the instancing stress mode every quad then shows another image of the atlas, still in one draw call.
+// The atlas written by tools/atlas_packer is used when it exists, otherwise ATLAS_IMAGES are packed at startup.
+const bool TEXTURE_ATLAS = false;
+const char *ATLAS_PATH = "resources/textures/atlas.bin";
+const char *const ATLAS_IMAGES[] = { "resources/textures/container.jpg", "resources/textures/awesomeface.png", "resources/textures/wall.jpg" };
+
+// in the instancing stress mode, loads every image of ATLAS_IMAGES as a texture of its own and lets each quad
+// sample one through an ARB_bindless_texture handle (learnopengl/bindless_textures.h), so there is nothing to
+// bind at all; drivers without the extension fall back to the atlas
+const bool BINDLESS_TEXTURES = false;
+
+// maps the asset pack written by tools/asset_packer (e.g. "resources/assets.pak") and takes the shader sources and
+// the container texture straight from the mapping instead of opening their files; whatever the pack lacks is
+// still loaded from its file
+const char *ASSET_PACK_PATH = NULL;
+
+// loads container.jpg through a TextureResidency (learnopengl/texture_residency.h) instead of the streamer: only the
+// mip levels the quad's size on screen needs are uploaded, within TEXTURE_BUDGET_MB of video memory; it is not
+// hot reloaded then
+const bool TEXTURE_RESIDENCY = false;
+const size_t TEXTURE_BUDGET_MB = 16;
+
+// records the GL calls of the first GL_CAPTURE_FRAMES frames into this file (e.g. "perf_playground.glcap"), for
+// tools/gl_replay to play back without a window (see learnopengl/gl_capture.h); NULL records nothing
+const char *GL_CAPTURE_PATH = NULL;
+const unsigned long GL_CAPTURE_FRAMES = 600;
+
+// reloads perf_playground.vs/fs and container.jpg whenever they are saved while the sample runs (see
+// learnopengl/hot_reload.h); the container's shader is recompiled as the same variant, the image is decoded
+// again on the streamer's workers. Only the jpg loaded through the streamer is watched, not a ktx2 or a packed one.
+const bool HOT_RELOAD = false;
+
+// uploads the vertices in 16 instead of 32 bytes (see compactLayout below)
+const bool COMPACT_VERTICES = false;
+
+// compact vertex layout: half float positions alone in stream 0, so a depth-only pass could fetch just those,
+// and normalized byte colors with normalized 16 bit texture coordinates in stream 1 (they are all in [0, 1])
+struct PackedAttributes
+{
+    unsigned char color[4];
+    unsigned short texCoord[2];
+};
+constexpr VertexAttribute compactAttributes[] = {
+    { 0, 4, GL_HALF_FLOAT, false, 0 },
+    { 1, 4, GL_UNSIGNED_BYTE, true, 1 },
+    { 2, 2, GL_UNSIGNED_SHORT, true, 1 }
+};
+constexpr VertexLayout<3> compactLayout(compactAttributes);
+static_assert(compactLayout.stride(0) == 4 * sizeof(unsigned short), "half float positions are padded to 4 components");
+static_assert(compactLayout.stride(1) == sizeof(PackedAttributes), "PackedAttributes does not match stream 1 of compactLayout");
+
+// shader features of perf_playground.fs, one #define each (see textureFeatureDefines); combine them with |
+enum class TextureFeature : unsigned int
+{
+    None = 0,
+    VertexColor = 1 << 0, // tints the texture with the vertex colors
+    Grayscale = 1 << 1,   // outputs the luminance only
+    TextureArray = 1 << 2, // samples a TextureAtlas layer instead of a GL_TEXTURE_2D
+    Bindless = 1 << 3      // instanced only: samples the texture handle of the instance
+};
+template <>
+struct IsFeatureMask<TextureFeature> : std::true_type {};
+const char* const textureFeatureDefines[] = { "VERTEX_COLOR", "GRAYSCALE", "TEXTURE_ARRAY", "BINDLESS" };
+const TextureFeature TEXTURE_FEATURES = TextureFeature::None;
+static_assert(variantKey(TextureFeature::VertexColor | TextureFeature::Grayscale) == 3, "one bit per feature");
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    // BINDLESS_TEXTURES asks for a 4.3 context, and gets the 3.3 one when the driver can't give it (see learnopengl/gl_window.h)
+    GLFWwindow* window = BINDLESS_TEXTURES ? createWindowPreferring(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", 4, 3)
+                                           : glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    // from here on, before anything is created that the calls later refer to
+    GLCapture& capture = GLCapture::instance();
+    if (GL_CAPTURE_PATH)
+        capture.begin(GL_CAPTURE_PATH);
+
+    // owns the container's buffers, vertex array and texture, and deletes them a few frames after they were
+    // released (see learnopengl/gpu_resources.h); its report shows the video memory they take
+    GpuResourceRegistry gpuResources;
+
+    // in the stress mode decoding the atlas images and updating the instances run on every core (see
+    // learnopengl/job_system.h); everything else does too little of it to be worth a pool of worker threads
+    JobSystem* jobs = NULL;
+    if (INSTANCING_STRESS)
+        jobs = new JobSystem();
+
+    // build and compile our shader zprogram
+    // ------------------------------------
+    // every combination of TextureFeature is its own program, compiled the first time it is asked for; while
+    // capturing they are always compiled, a glProgramBinary in the capture would only replay on this driver
+    ProgramCache programCache;
+    ProgramCache* shaderCache = GL_CAPTURE_PATH ? NULL : &programCache;
+    AssetPack assetPack;
+    if (ASSET_PACK_PATH && !assetPack.open(FileSystem::getPath(ASSET_PACK_PATH)))
+        std::cout << "Failed to open the asset pack " << ASSET_PACK_PATH << ", loading the files one by one" << std::endl;
+    const char* packedVertexSource = assetPack.text("1.getting_started/perf_playground/perf_playground.vs");
+    const char* packedFragmentSource = assetPack.text("1.getting_started/perf_playground/perf_playground.fs");
+    ShaderVariants<TextureFeature, 4> textureVariants = packedVertexSource && packedFragmentSource
+        ? ShaderVariants<TextureFeature, 4>::fromSource(packedVertexSource, packedFragmentSource, textureFeatureDefines, shaderCache)
+        : ShaderVariants<TextureFeature, 4>("perf_playground.vs", "perf_playground.fs", textureFeatureDefines, shaderCache);
+    TextureFeature containerFeatures = TEXTURE_ATLAS ? TEXTURE_FEATURES | TextureFeature::TextureArray : TEXTURE_FEATURES;
+    Shader& ourShader = textureVariants.get(containerFeatures);
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float vertices[] = {
+        // positions          // colors           // texture coords
+         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f, // top right
+         0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f, // bottom right
+        -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f, // bottom left
+        -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f  // top left 
+    };
+    unsigned int indices[] = {  
+        0, 1, 3, // first triangle
+        1, 2, 3  // second triangle
+    };
+    GpuVertexArray VAO = gpuResources.createVertexArray();
+    GpuBuffer VBO = gpuResources.createBuffer();
+    GpuBuffer EBO = gpuResources.createBuffer();
+
+    glBindVertexArray(VAO.ID);
+
+    VBO.data(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+    EBO.data(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // color attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    // texture coord attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    // the compact version replaces the data and attributes above; the shader stays the same, because the
+    // attributes are still read as vec3/vec2 of floats (the half floats and normalized integers are converted
+    // by the vertex fetch)
+    GpuBuffer attributeVBO;
+    if (COMPACT_VERTICES)
+    {
+        // gathered per attribute first, so the packing kernels of learnopengl/simd_kernels.h convert all the
+        // values of an attribute in one call, with the widest instruction set of the CPU
+        float positionValues[4][4], colorValues[4][4], texCoordValues[4][2];
+        for (int i = 0; i < 4; i++)
+        {
+            const float* vertex = &vertices[i * 8];
+            for (int j = 0; j < 3; j++)
+            {
+                positionValues[i][j] = vertex[j];
+                colorValues[i][j] = vertex[3 + j];
+            }
+            positionValues[i][3] = colorValues[i][3] = 1.0f;
+            texCoordValues[i][0] = vertex[6];
+            texCoordValues[i][1] = vertex[7];
+        }
+        unsigned short positions[4][4];
+        unsigned char colors[4][4];
+        unsigned short texCoords[4][2];
+        const SimdKernels& simd = simdKernels();
+        simd.packHalf(&positionValues[0][0], &positions[0][0], 16);
+        simd.packUnorm8(&colorValues[0][0], &colors[0][0], 16);
+        simd.packUnorm16(&texCoordValues[0][0], &texCoords[0][0], 8);
+        PackedAttributes attributes[4];
+        for (int i = 0; i < 4; i++)
+        {
+            std::memcpy(attributes[i].color, colors[i], sizeof(attributes[i].color));
+            std::memcpy(attributes[i].texCoord, texCoords[i], sizeof(attributes[i].texCoord));
+        }
+        attributeVBO = gpuResources.createBuffer();
+        VBO.data(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
+        attributeVBO.data(GL_ARRAY_BUFFER, sizeof(attributes), attributes, GL_STATIC_DRAW);
+        unsigned int streams[] = { VBO.ID, attributeVBO.ID };
+        compactLayout.apply(streams);
+    }
+
+
+    // load and create a texture 
+    // -------------------------
+    // prefer the pre-compressed container.ktx2 written by tools/texture_compressor: its blocks and mipmaps go
+    // straight to the GPU. Without the file, or if the driver lacks its format, fall back to the jpg.
+    // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
+    // An asset pack comes first, its texture is uploaded right out of the mapped file.
+    TextureStreamer textureStreamer;
+    TextureResidency* textureResidency = NULL;
+    if (TEXTURE_RESIDENCY)
+        textureResidency = new TextureResidency(TEXTURE_BUDGET_MB * 1024 * 1024);
+    HotReloader* hotReloader = NULL;
+    if (HOT_RELOAD)
+    {
+        hotReloader = new HotReloader(shaderCache, &textureStreamer);
+        hotReloader->watchShader(ourShader, "perf_playground.vs", "perf_playground.fs", textureVariants.defineHeader(containerFeatures));
+    }
+    unsigned int containerTexture = loadAssetPackTexture(assetPack, "resources/textures/container.ktx2");
+    if (containerTexture == 0)
+        containerTexture = loadAssetPackTexture(assetPack, "resources/textures/container.jpg");
+    if (containerTexture == 0)
+        containerTexture = loadCompressedTexture(FileSystem::getPath("resources/textures/container.ktx2"));
+    if (containerTexture == 0 && textureResidency)
+        containerTexture = textureResidency->load(FileSystem::getPath("resources/textures/container.jpg"));
+    if (containerTexture == 0)
+    {
+        // the streamer decodes the image on a worker thread and uploads it a few frames later; until then the
+        // texture holds a single grey texel, so the window is responsive right away
+        containerTexture = textureStreamer.load(FileSystem::getPath("resources/textures/container.jpg"));
+        if (hotReloader)
+            hotReloader->watchTexture(containerTexture, FileSystem::getPath("resources/textures/container.jpg"));
+    }
+    GpuTexture texture = gpuResources.adopt<GPU_TEXTURE>(containerTexture, measureTextureBytes(containerTexture));
+    glBindTexture(GL_TEXTURE_2D, texture.ID); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // everything in the pack was uploaded (the shader variants keep their own copy of the sources)
+    assetPack.close();
+
+    // with the atlas the container is one region of it; the uv rectangle and layer go to the shader as uniforms
+    bool bindless = BINDLESS_TEXTURES && INSTANCING_STRESS && bindlessTexturesSupported();
+    if (BINDLESS_TEXTURES && !bindless)
+        std::cout << "bindless textures need OpenGL 4.3, ARB_bindless_texture and the stress mode, using the texture atlas instead" << std::endl;
+    TextureAtlas atlas;
+    int containerRegion = -1;
+    if ((TEXTURE_ATLAS || (BINDLESS_TEXTURES && !bindless)) && createAtlas(atlas, jobs))
+        containerRegion = std::max(0, atlas.find(ATLAS_IMAGES[0]));
+
+    FrameProfiler profiler;
+    if (PROFILER_CSV_PATH)
+        profiler.openCsv(PROFILER_CSV_PATH);
+    FramePacer pacer(INSTANCING_STRESS ? PACING_UNLOCKED : PACING_MODE, INSTANCING_STRESS ? 0.0 : FRAME_RATE_LIMIT, &profiler);
+    RedrawScheduler redraw(window, ON_DEMAND_RENDERING && !INSTANCING_STRESS);
+    DynamicResolution* dynamicResolution = NULL;
+    if (DYNAMIC_RESOLUTION)
+        dynamicResolution = new DynamicResolution(DYNAMIC_RESOLUTION_TARGET_MS);
+
+    // the stress mode reuses the container VAO/EBO, with an instance buffer added to it
+    InstancedQuads* quads = NULL;
+    ShaderVariants<TextureFeature, 4>* instancedVariants = NULL;
+    Shader* instancedShader = NULL;
+    BindlessTextures* bindlessTextures = NULL;
+    std::vector<unsigned int> bindlessImages;
+    int stressFrames = 0;
+    double stressStart = glfwGetTime();
+    if (INSTANCING_STRESS)
+    {
+        quads = new InstancedQuads(VAO.ID);
+        instancedVariants = new ShaderVariants<TextureFeature, 4>("perf_playground_instanced.vs", "perf_playground_instanced.fs", textureFeatureDefines, shaderCache);
+        // the sources are GLSL 3.30; the handle buffer of the bindless variant is a std430 shader storage buffer
+        instancedVariants->requireVersion(TextureFeature::Bindless, "430 core");
+        if (bindless)
+        {
+            // the textures have to be complete before they get a handle, so they are loaded right here
+            bindlessTextures = new BindlessTextures();
+            std::vector<DecodedImage> images = decodeImages(jobs, ATLAS_IMAGES, sizeof(ATLAS_IMAGES) / sizeof(ATLAS_IMAGES[0]));
+            for (size_t i = 0; i < images.size(); i++)
+            {
+                unsigned int image = createTexture(images[i]);
+                if (image && bindlessTextures->makeResident(image) >= 0)
+                    bindlessImages.push_back(image);
+                else if (image)
+                    glDeleteTextures(1, &image);
+            }
+            if (bindlessImages.empty())
+            {
+                bindlessTextures->release();
+                delete bindlessTextures;
+                bindlessTextures = NULL;
+                // no handle could be made resident: fall back to the atlas, as without the extension
+                std::cout << "no texture could be made resident, using the texture atlas instead" << std::endl;
+                if (createAtlas(atlas, jobs))
+                    containerRegion = std::max(0, atlas.find(ATLAS_IMAGES[0]));
+            }
+        }
+        if (bindlessTextures)
+            instancedShader = &instancedVariants->get(TextureFeature::Bindless);
+        else
+            instancedShader = &instancedVariants->get(atlas.ID ? TextureFeature::TextureArray : TextureFeature::None);
+        fillQuadGrid(quads->instances, 1);
+        assignAtlasRegions(quads->instances, atlas, jobs);
+        if (bindlessTextures)
+            assignBindlessHandles(*bindlessTextures, quads->instances.size());
+        quads->upload();
+    }
+
+
+    // skips the binds that would not change anything; the texture, program and VAO stay the same every frame
+    GLState glState;
+    // the container is submitted as a draw item; with more objects the queue sorts and batches them
+    DrawQueue drawQueue;
+
+    // what the loop allocates per frame, by subsystem; loading is over, from here on every frame should reuse
+    // what the ones before it allocated
+    AllocationTracker& allocations = AllocationTracker::instance();
+    int streamingAllocations = allocations.subsystem("texture streamer");
+    int reloadAllocations = allocations.subsystem("hot reload", true);
+    int drawAllocations = allocations.subsystem("draw");
+    int stressAllocations = allocations.subsystem("stress steps", true);
+    allocations.enforceZeroAllocations(ZERO_ALLOCATION_AFTER_FRAMES);
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // glfw: poll IO events (keys pressed/released, mouse moved etc.), or wait for one while nothing changes
+        // -------------------------------------------------------------------------------
+        if (redraw.waitEvents())
+            pacer.inputSampled();
+
+        // input
+        // -----
+        processInput(window);
+
+        // upload the textures that finished decoding since the last frame (which binds them behind glState's back)
+        {
+            AllocationScope scope(streamingAllocations);
+            if (textureStreamer.update() > 0)
+            {
+                texture.setBytes(measureTextureBytes(texture.ID));
+                glState.invalidate();
+                redraw.requestRedraw();
+            }
+            if (textureStreamer.pending() > 0)
+                redraw.wakeWithin(0.01);
+        }
+        // refine (or evict) the mip levels the last frame asked for
+        if (textureResidency)
+        {
+            AllocationScope scope(streamingAllocations);
+            if (textureResidency->update() > 0)
+            {
+                texture.setBytes(textureResidency->residentBytes(texture.ID));
+                glState.invalidate();
+                redraw.requestRedraw();
+            }
+            if (textureResidency->pending() > 0)
+                redraw.wakeWithin(0.01);
+        }
+        // start recompiling and reloading what was edited, and swap in the shaders that finished
+        if (hotReloader)
+        {
+            AllocationScope scope(reloadAllocations);
+            if (hotReloader->update() > 0)
+            {
+                glState.invalidate();
+                redraw.requestRedraw();
+            }
+        }
+
+        // nothing changed since the last frame drawn: back to waiting
+        if (!redraw.beginFrame())
+            continue;
+        profiler.beginFrame();
+
+        // render
+        // ------
+        if (dynamicResolution)
+            dynamicResolution->beginScene(window);
+        glState.clearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        {
+            AllocationScope scope(drawAllocations);
+            FrameProfiler::CpuScope cpu(profiler, "draw");
+            FrameProfiler::GpuScope gpu(profiler, "draw");
+
+            // the container quad spans half the viewport, a quad of the grid a cell of it
+            if (textureResidency)
+            {
+                int viewportWidth, viewportHeight;
+                glfwGetFramebufferSize(window, &viewportWidth, &viewportHeight);
+                if (dynamicResolution)
+                {
+                    viewportWidth = dynamicResolution->width();
+                    viewportHeight = dynamicResolution->height();
+                }
+                float quadPixels = 0.5f * std::max(viewportWidth, viewportHeight);
+                if (quads)
+                    quadPixels /= std::ceil(std::sqrt((float)quads->instances.size()));
+                textureResidency->request(texture.ID, quadPixels);
+            }
+
+            // render container
+            if (quads)
+            {
+                // every quad of the grid in one draw call
+                if (bindlessTextures)
+                    bindlessTextures->bind(0);
+                else if (atlas.ID)
+                    glState.bindTexture(GL_TEXTURE_2D_ARRAY, atlas.ID);
+                else
+                    glState.bindTexture(GL_TEXTURE_2D, texture.ID);
+                glState.useProgram(instancedShader->ID);
+                glState.bindVertexArray(VAO.ID);
+                quads->draw();
+            }
+            else
+            {
+                DrawItem container;
+                container.shader = &ourShader;
+                container.VAO = VAO.ID;
+                container.texture = texture.ID;
+                container.indexCount = 6;
+                if (containerRegion >= 0)
+                {
+                    const AtlasRegion& region = atlas.regions[containerRegion];
+                    container.texture = atlas.ID;
+                    container.textureTarget = GL_TEXTURE_2D_ARRAY;
+                    container.setVec4(uniformHash("atlasRect"), region.uvRect[0], region.uvRect[1], region.uvRect[2], region.uvRect[3]);
+                    container.setFloat(uniformHash("atlasLayer"), (float)region.layer);
+                }
+                drawQueue.submit(container);
+                drawQueue.flush(glState);
+            }
+        }
+
+        if (dynamicResolution)
+        {
+            // the scale for the next frames follows the latest draw time the GPU reported, a few frames back
+            dynamicResolution->endScene();
+            dynamicResolution->update(profiler.latest("draw", true));
+            glState.invalidate();
+        }
+
+        if (SHOW_PROFILER_OVERLAY)
+        {
+            profiler.drawOverlay();
+            glState.invalidate();
+        }
+
+        // glfw: swap buffers
+        // -------------------------------------------------------------------------------
+        {
+            FrameProfiler::CpuScope cpu(profiler, "swap");
+            capture.endFrame();
+            if (capture.active() && capture.frames == GL_CAPTURE_FRAMES)
+                capture.end();
+            pacer.swap(window);
+        }
+        profiler.endFrame();
+        pacer.wait();
+
+        if (quads && ++stressFrames == STRESS_FRAMES_PER_STEP)
+        {
+            AllocationScope scope(stressAllocations);
+            double seconds = glfwGetTime() - stressStart;
+            size_t count = quads->instances.size();
+            std::cout << "instances " << count << ": " << 1000.0 * seconds / stressFrames << " ms/frame, gpu "
+                      << profiler.stats("draw", true).p50 << " ms, " << count * stressFrames / seconds / 1.0e6 << " M quads/s" << std::endl;
+            if (count >= STRESS_MAX_INSTANCES)
+                glfwSetWindowShouldClose(window, true);
+            else
+            {
+                fillQuadGrid(quads->instances, count * 2, *jobs);
+                assignAtlasRegions(quads->instances, atlas, jobs);
+                if (bindlessTextures)
+                    assignBindlessHandles(*bindlessTextures, quads->instances.size());
+                quads->upload();
+                glState.invalidate();
+                // the gpu median of the next step only covers the frames drawn with the new count
+                profiler.resetStats("draw");
+            }
+            stressFrames = 0;
+            stressStart = glfwGetTime();
+        }
+        gpuResources.endFrame();
+        allocations.endFrame();
+    }
+    profiler.report();
+    glState.report();
+    allocations.report();
+    redraw.report();
+    if (textureResidency)
+        textureResidency->report();
+    if (dynamicResolution)
+        dynamicResolution->report();
+    gpuResources.report();
+    profiler.release();
+    pacer.release();
+    if (dynamicResolution)
+    {
+        dynamicResolution->release();
+        delete dynamicResolution;
+    }
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    VAO.reset();
+    VBO.reset();
+    EBO.reset();
+    attributeVBO.reset();
+    texture.reset();
+    if (quads)
+    {
+        quads->release();
+        instancedVariants->release();
+        delete quads;
+        delete instancedVariants;
+        delete jobs;
+    }
+    if (atlas.ID)
+        atlas.release();
+    if (bindlessTextures)
+    {
+        // the handles go first, a resident texture must not be deleted
+        bindlessTextures->release();
+        delete bindlessTextures;
+    }
+    if (!bindlessImages.empty())
+        glDeleteTextures((GLsizei)bindlessImages.size(), bindlessImages.data());
+    // the reloader goes before the streamer and the variants, it refers to both
+    if (hotReloader)
+        hotReloader->release();
+    delete hotReloader;
+    textureStreamer.release();
+    if (textureResidency)
+    {
+        textureResidency->release();
+        delete textureResidency;
+    }
+    textureVariants.release();
+    gpuResources.release();
+    capture.end();
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+}
+
+// loads the atlas written by tools/atlas_packer, or packs ATLAS_IMAGES when there is none; returns false if
+// neither worked, and the sample then keeps using the container texture
+// ---------------------------------------------------------------------------------------------------------
+bool createAtlas(TextureAtlas& atlas, JobSystem* jobs)
+{
+    AtlasData data;
+    if (!loadAtlas(FileSystem::getPath(ATLAS_PATH), data))
+    {
+        AtlasBuilder builder(1024);
+        std::vector<DecodedImage> images = decodeImages(jobs, ATLAS_IMAGES, sizeof(ATLAS_IMAGES) / sizeof(ATLAS_IMAGES[0]));
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            if (!images[i].pixels)
+                continue;
+            builder.add(ATLAS_IMAGES[i], images[i].width, images[i].height, images[i].pixels);
+            stbi_image_free(images[i].pixels);
+        }
+        if (builder.imageCount() == 0 || !builder.pack(data))
+            return false;
+    }
+    std::cout << "texture atlas: " << data.regions.size() << " images in " << data.layers << " layers of " << data.size << "x" << data.size << std::endl;
+    return atlas.create(data);
+}
+
+// gives the quads the atlas regions in turn, so neighbours show different images
+// ---------------------------------------------------------------------------------------------------------
+void assignAtlasRegions(std::vector<QuadInstance>& instances, const TextureAtlas& atlas, JobSystem* jobs)
+{
+    if (atlas.regions.empty())
+        return;
+    auto assign = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const AtlasRegion& region = atlas.regions[i % atlas.regions.size()];
+            for (int j = 0; j < 4; j++)
+                instances[i].uvRect[j] = region.uvRect[j];
+            instances[i].layer = (float)region.layer;
+        }
+    };
+    if (jobs)
+        jobs->parallelFor(0, instances.size(), 16384, assign);
+    else
+        assign(0, instances.size());
+}
+
+// decodes the images at once on every thread of jobs (if any), instead of one stbi_load after another
+// ---------------------------------------------------------------------------------------------------------
+std::vector<DecodedImage> decodeImages(JobSystem* jobs, const char* const* paths, size_t count)
+{
+    std::vector<DecodedImage> images(count);
+    auto decode = [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            int nrChannels;
+            images[i].pixels = stbi_load(FileSystem::getPath(paths[i]).c_str(), &images[i].width, &images[i].height, &nrChannels, 4);
+        }
+    };
+    if (jobs)
+        jobs->parallelFor(0, count, 1, decode);
+    else
+        decode(0, count);
+    for (size_t i = 0; i < count; i++)
+        if (!images[i].pixels)
+            std::cout << "Failed to load texture " << paths[i] << std::endl;
+    return images;
+}
+
+// uploads a decoded image into a complete, mipmapped GL_TEXTURE_2D right away and frees its pixels; returns 0
+// for an image that failed to decode
+// ---------------------------------------------------------------------------------------------------------
+unsigned int createTexture(DecodedImage& image)
+{
+    if (!image.pixels)
+        return 0;
+    const unsigned char* data = image.pixels;
+    int width = image.width, height = image.height;
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    stbi_image_free(image.pixels);
+    image.pixels = NULL;
+    return texture;
+}
+
+// gives the quads the resident textures in turn, one handle per instance in the shader storage buffer
+// ---------------------------------------------------------------------------------------------------------
+void assignBindlessHandles(BindlessTextures& bindless, size_t count)
+{
+    bindless.instances.resize(count);
+    for (size_t i = 0; i < count; i++)
+        bindless.instances[i] = bindless.handle((int)(i % bindless.count()));
+    bindless.upload();
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
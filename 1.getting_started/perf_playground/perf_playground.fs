@@ -0,0 +1,30 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 ourColor;
+in vec2 TexCoord;
+
+// texture sampler
+#ifdef TEXTURE_ARRAY
+// an atlas layer (see learnopengl/texture_atlas.h): the image is the rectangle atlasRect of layer atlasLayer
+uniform sampler2DArray texture1;
+uniform vec4 atlasRect;
+uniform float atlasLayer;
+#else
+uniform sampler2D texture1;
+#endif
+
+void main()
+{
+#ifdef TEXTURE_ARRAY
+	FragColor = texture(texture1, vec3(atlasRect.xy + TexCoord * atlasRect.zw, atlasLayer));
+#else
+	FragColor = texture(texture1, TexCoord);
+#endif
+#ifdef VERTEX_COLOR
+	FragColor *= vec4(ourColor, 1.0);
+#endif
+#ifdef GRAYSCALE
+	FragColor.rgb = vec3(dot(FragColor.rgb, vec3(0.2126, 0.7152, 0.0722)));
+#endif
+}
@@ -0,0 +1,31 @@
+#version 330 core
+// BINDLESS variants are compiled as #version 430 core (see ShaderVariants::requireVersion)
+#ifdef BINDLESS
+#extension GL_ARB_bindless_texture : require
+#endif
+out vec4 FragColor;
+
+in vec3 ourColor;
+in vec2 TexCoord;
+in vec4 Tint;
+in float Layer;
+
+// texture sampler; with TEXTURE_ARRAY every quad picks its own atlas layer, with BINDLESS its own texture
+#if defined(BINDLESS)
+flat in uvec2 TextureHandle;
+#elif defined(TEXTURE_ARRAY)
+uniform sampler2DArray texture1;
+#else
+uniform sampler2D texture1;
+#endif
+
+void main()
+{
+#if defined(BINDLESS)
+	FragColor = texture(sampler2D(TextureHandle), TexCoord) * Tint;
+#elif defined(TEXTURE_ARRAY)
+	FragColor = texture(texture1, vec3(TexCoord, Layer)) * Tint;
+#else
+	FragColor = texture(texture1, TexCoord) * Tint;
+#endif
+}
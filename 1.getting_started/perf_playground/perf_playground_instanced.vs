@@ -0,0 +1,41 @@
+#version 330 core
+// BINDLESS variants are compiled as #version 430 core (see ShaderVariants::requireVersion), for the handle buffer
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+// per-instance attributes (glVertexAttribDivisor 1), see learnopengl/instanced_quads.h
+layout (location = 3) in vec4 aOffsetScale;
+layout (location = 4) in float aRotation;
+layout (location = 5) in vec4 aTint;
+layout (location = 6) in vec4 aUvRect;
+layout (location = 7) in float aLayer;
+
+out vec3 ourColor;
+out vec2 TexCoord;
+out vec4 Tint;
+out float Layer;
+
+#ifdef BINDLESS
+// the texture handle of every instance, see learnopengl/bindless_textures.h
+layout (std430, binding = 0) readonly buffer TextureHandles
+{
+	uvec2 handles[];
+};
+flat out uvec2 TextureHandle;
+#endif
+
+void main()
+{
+	float s = sin(aRotation);
+	float c = cos(aRotation);
+	vec2 pos = aPos.xy * aOffsetScale.zw;
+	pos = vec2(c * pos.x - s * pos.y, s * pos.x + c * pos.y);
+	gl_Position = vec4(pos + aOffsetScale.xy, aPos.z, 1.0);
+	ourColor = aColor;
+	TexCoord = aUvRect.xy + aTexCoord * aUvRect.zw;
+	Tint = aTint;
+	Layer = aLayer;
+#ifdef BINDLESS
+	TextureHandle = handles[gl_InstanceID];
+#endif
+}
@@ -0,0 +1,402 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/compressed_texture.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// what a blob of an asset pack holds, and what its params mean
+enum AssetType
+{
+    ASSET_BLOB = 0,               // anything else, as it was on disk
+    ASSET_TEXTURE_COMPRESSED = 1, // a .ktx2 or .dds file as it was on disk, uploaded without decoding
+    ASSET_TEXTURE_RGBA8 = 2,      // decoded pixels, params[0] x params[1] texels
+    ASSET_SHADER_SOURCE = 3,      // GLSL, followed by a terminating zero that is not part of size
+    ASSET_VERTEX_DATA = 5         // raw vertex or index data, params[0] is the stride in bytes
+};
+
+// File layout: the header, the index (one entry per blob, sorted by name), the names, then the blobs, each
+// starting at a multiple of ASSET_PACK_ALIGNMENT. All values are little endian.
+struct AssetPackHeader
+{
+    char magic[8];                 // "LOGLPAK1"
+    unsigned int version;
+    unsigned int entryCount;
+    unsigned long long indexOffset;
+    unsigned long long namesOffset;
+    unsigned long long namesSize;
+};
+struct AssetPackEntry
+{
+    unsigned long long offset;     // of the blob, from the start of the file
+    unsigned long long size;
+    unsigned int nameOffset;       // into the names, which are not zero terminated
+    unsigned int nameLength;
+    unsigned int type;             // AssetType
+    unsigned int params[3];
+};
+static_assert(sizeof(AssetPackHeader) == 40, "the pack header is written as it is");
+static_assert(sizeof(AssetPackEntry) == 40, "the index entries are read straight out of the mapping");
+
+const unsigned int ASSET_PACK_VERSION = 1;
+const unsigned int ASSET_PACK_ALIGNMENT = 64; // a cache line, and more than any GL upload path asks for
+
+// Read-only view of an asset pack: the whole file is memory-mapped (mmap, or MapViewOfFile on Windows) and the
+// index is used where it lies, so opening a pack costs one system call no matter how many assets it holds, and
+// nothing is read from disk until a blob is actually touched.
+// - data() points right into the mapping; hand it to glTexImage2D, glCompressedTexImage2D or glBufferData as it
+//   is and the driver copies it from the page cache, without an intermediate heap copy.
+// - Names are the paths relative to the repository, e.g. "resources/textures/container.jpg".
+// - The pointers are valid until close(); GL has copied the data once the upload call returns.
+class AssetPack
+{
+public:
+    AssetPack() : base(NULL), size(0), entries(NULL), entryCount(0), names(NULL)
+    {
+#ifdef _WIN32
+        file = INVALID_HANDLE_VALUE;
+        mapping = NULL;
+#endif
+    }
+    ~AssetPack()
+    {
+        close();
+    }
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // maps the pack and checks its index; returns false (and stays closed) if it is missing or damaged
+    // ------------------------------------------------------------------------
+    bool open(const std::string& path)
+    {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            size = (size_t)fileSize.QuadPart;
+            mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping)
+                base = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            size = (size_t)info.st_size;
+            void* view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+                base = (const unsigned char*)view;
+        }
+        ::close(fd); // the mapping keeps the file alive
+#endif
+        if (!base)
+        {
+            std::cout << "ERROR::ASSET_PACK::MAPPING_FAILED: " << path << std::endl;
+            close();
+            return false;
+        }
+        if (!readIndex())
+        {
+            std::cout << "ERROR::ASSET_PACK::INVALID: " << path << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+    // unmaps the pack; every pointer handed out before becomes invalid
+    // ------------------------------------------------------------------------
+    void close()
+    {
+#ifdef _WIN32
+        if (base)
+            UnmapViewOfFile(base);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base)
+            munmap((void*)base, size);
+#endif
+        base = NULL;
+        size = 0;
+        entries = NULL;
+        entryCount = 0;
+        names = NULL;
+    }
+    // ------------------------------------------------------------------------
+    bool isOpen() const
+    {
+        return base != NULL;
+    }
+    // the entry of the named blob, or NULL; a binary search over the sorted index
+    // ------------------------------------------------------------------------
+    const AssetPackEntry* find(const std::string& name) const
+    {
+        size_t first = 0, last = entryCount;
+        while (first < last)
+        {
+            size_t middle = (first + last) / 2;
+            int order = compareName(entries[middle], name);
+            if (order == 0)
+                return &entries[middle];
+            if (order < 0)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+        return NULL;
+    }
+    // ------------------------------------------------------------------------
+    const unsigned char* data(const AssetPackEntry& entry) const
+    {
+        return base + entry.offset;
+    }
+    // the zero-terminated source of a shader entry, or NULL
+    // ------------------------------------------------------------------------
+    const char* text(const std::string& name) const
+    {
+        const AssetPackEntry* entry = find(name);
+        if (!entry || entry->type != ASSET_SHADER_SOURCE)
+            return NULL;
+        return (const char*)data(*entry);
+    }
+    // ------------------------------------------------------------------------
+    size_t count() const
+    {
+        return entryCount;
+    }
+    // ------------------------------------------------------------------------
+    const AssetPackEntry& entry(size_t i) const
+    {
+        return entries[i];
+    }
+    // ------------------------------------------------------------------------
+    std::string name(const AssetPackEntry& entry) const
+    {
+        return std::string(names + entry.nameOffset, entry.nameLength);
+    }
+
+private:
+    const unsigned char* base;
+    size_t size;
+    const AssetPackEntry* entries;
+    size_t entryCount;
+    const char* names;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    // checks that the header, the index and every blob lie within the file, and that the index is sorted by name
+    // (find() is a binary search). Every range is checked as "size > limit || offset > limit - size", which can
+    // not wrap around however large the values in a damaged file are.
+    // ------------------------------------------------------------------------
+    bool readIndex()
+    {
+        if (size < sizeof(AssetPackHeader))
+            return false;
+        const AssetPackHeader* header = (const AssetPackHeader*)base;
+        if (std::memcmp(header->magic, "LOGLPAK1", 8) != 0 || header->version != ASSET_PACK_VERSION)
+            return false;
+        unsigned long long indexSize = (unsigned long long)header->entryCount * sizeof(AssetPackEntry);
+        if (header->indexOffset % 8 != 0 || !inFile(header->indexOffset, indexSize) || !inFile(header->namesOffset, header->namesSize))
+            return false;
+        entries = (const AssetPackEntry*)(base + header->indexOffset);
+        entryCount = header->entryCount;
+        names = (const char*)(base + header->namesOffset);
+        for (size_t i = 0; i < entryCount; i++)
+        {
+            const AssetPackEntry& entry = entries[i];
+            if (!inFile(entry.offset, entry.size) || entry.nameLength > header->namesSize || entry.nameOffset > header->namesSize - entry.nameLength)
+                return false;
+            // the terminating zero follows the blob, so the blob must end before the file does
+            if (entry.type == ASSET_SHADER_SOURCE && (entry.offset + entry.size == size || base[entry.offset + entry.size] != 0))
+                return false;
+            if (i > 0 && compareName(entries[i - 1], name(entry)) >= 0)
+                return false;
+        }
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    bool inFile(unsigned long long offset, unsigned long long length) const
+    {
+        return length <= size && offset <= size - length;
+    }
+    // ------------------------------------------------------------------------
+    int compareName(const AssetPackEntry& entry, const std::string& name) const
+    {
+        size_t length = std::min((size_t)entry.nameLength, name.size());
+        int order = std::memcmp(names + entry.nameOffset, name.data(), length);
+        if (order != 0)
+            return order;
+        return entry.nameLength < name.size() ? -1 : entry.nameLength > name.size() ? 1 : 0;
+    }
+};
+
+// Collects blobs and writes them as an asset pack (tools/asset_packer builds one from the resources tree).
+class AssetPackWriter
+{
+public:
+    // ------------------------------------------------------------------------
+    void add(const std::string& name, AssetType type, const void* data, size_t size,
+             unsigned int param0 = 0, unsigned int param1 = 0, unsigned int param2 = 0)
+    {
+        Blob blob;
+        blob.name = name;
+        blob.type = type;
+        blob.params[0] = param0;
+        blob.params[1] = param1;
+        blob.params[2] = param2;
+        blob.data.assign((const unsigned char*)data, (const unsigned char*)data + size);
+        blobs.push_back(blob);
+    }
+    // ------------------------------------------------------------------------
+    size_t count() const
+    {
+        return blobs.size();
+    }
+    // sorts the index by name and writes the pack; a name that was added twice keeps its first blob
+    // ------------------------------------------------------------------------
+    bool write(const std::string& path)
+    {
+        std::stable_sort(blobs.begin(), blobs.end(), [](const Blob& a, const Blob& b) { return a.name < b.name; });
+        for (size_t i = 1; i < blobs.size();)
+        {
+            if (blobs[i].name == blobs[i - 1].name)
+            {
+                std::cout << "ERROR::ASSET_PACK::DUPLICATE_NAME: " << blobs[i].name << std::endl;
+                blobs.erase(blobs.begin() + i);
+            }
+            else
+                i++;
+        }
+
+        AssetPackHeader header;
+        std::memcpy(header.magic, "LOGLPAK1", 8);
+        header.version = ASSET_PACK_VERSION;
+        header.entryCount = (unsigned int)blobs.size();
+        header.indexOffset = sizeof(AssetPackHeader);
+        header.namesOffset = header.indexOffset + blobs.size() * sizeof(AssetPackEntry);
+        std::string allNames;
+        std::vector<AssetPackEntry> index(blobs.size());
+        for (size_t i = 0; i < blobs.size(); i++)
+        {
+            index[i].nameOffset = (unsigned int)allNames.size();
+            index[i].nameLength = (unsigned int)blobs[i].name.size();
+            allNames += blobs[i].name;
+        }
+        header.namesSize = allNames.size();
+        unsigned long long offset = header.namesOffset + header.namesSize;
+        for (size_t i = 0; i < blobs.size(); i++)
+        {
+            offset = alignUp(offset);
+            index[i].offset = offset;
+            index[i].size = blobs[i].data.size();
+            index[i].type = blobs[i].type;
+            std::memcpy(index[i].params, blobs[i].params, sizeof(index[i].params));
+            offset += blobs[i].data.size() + (blobs[i].type == ASSET_SHADER_SOURCE ? 1 : 0);
+        }
+
+        std::ofstream file(path.c_str(), std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::ASSET_PACK::FILE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        file.write((const char*)&header, sizeof(header));
+        file.write((const char*)index.data(), index.size() * sizeof(AssetPackEntry));
+        file.write(allNames.data(), allNames.size());
+        unsigned long long written = header.namesOffset + header.namesSize;
+        static const char zeros[ASSET_PACK_ALIGNMENT] = { 0 };
+        for (size_t i = 0; i < blobs.size(); i++)
+        {
+            file.write(zeros, (std::streamsize)(index[i].offset - written));
+            file.write((const char*)blobs[i].data.data(), blobs[i].data.size());
+            written = index[i].offset + blobs[i].data.size();
+            if (blobs[i].type == ASSET_SHADER_SOURCE)
+            {
+                file.write(zeros, 1);
+                written++;
+            }
+        }
+        return (bool)file;
+    }
+
+private:
+    struct Blob
+    {
+        std::string name;
+        unsigned int type;
+        unsigned int params[3];
+        std::vector<unsigned char> data;
+    };
+    std::vector<Blob> blobs;
+
+    // ------------------------------------------------------------------------
+    static unsigned long long alignUp(unsigned long long offset)
+    {
+        return (offset + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+    }
+};
+
+// creates a texture from a texture entry, uploading straight from the mapping; returns 0 if there is no such
+// texture or the driver lacks its compressed format
+// ------------------------------------------------------------------------
+inline unsigned int loadAssetPackTexture(const AssetPack& pack, const std::string& name)
+{
+    const AssetPackEntry* entry = pack.find(name);
+    if (!entry)
+        return 0;
+    const unsigned char* bytes = pack.data(*entry);
+    if (entry->type == ASSET_TEXTURE_COMPRESSED)
+    {
+        // only the header is parsed into image, the levels are read from the mapping
+        CompressedImage image;
+        bool dds = entry->size >= 4 && std::memcmp(bytes, "DDS ", 4) == 0;
+        if (!(dds ? parseDDS(bytes, (size_t)entry->size, image) : parseKTX2(bytes, (size_t)entry->size, image, name)))
+            return 0;
+        return createCompressedTexture(image, bytes, name);
+    }
+    if (entry->type != ASSET_TEXTURE_RGBA8 || entry->size < (unsigned long long)entry->params[0] * entry->params[1] * 4)
+        return 0;
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, entry->params[0], entry->params[1], 0, GL_RGBA, GL_UNSIGNED_BYTE, bytes);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    return texture;
+}
+#endif
@@ -0,0 +1,99 @@
+#ifndef BINDLESS_TEXTURES_H
+#define BINDLESS_TEXTURES_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <iostream>
+#include <vector>
+
+// bindless textures need ARB_bindless_texture, and the handle table is a std430 shader storage buffer (GLSL 4.30)
+// ------------------------------------------------------------------------
+inline bool bindlessTexturesSupported()
+{
+    return GLAD_GL_ARB_bindless_texture && GLAD_GL_VERSION_4_3;
+}
+
+// Per-instance texture handles for ARB_bindless_texture: instead of binding a texture before a draw, every
+// instance finds the 64 bit handle of its texture in a shader storage buffer and samples through it, so any
+// number of different textures can go out in one draw call without an atlas.
+// - makeResident() turns a texture into a handle and makes it resident. From then on the texture's parameters
+//   and storage are frozen (the handle captured them), so it has to be complete, mipmaps included, before.
+// - Fill instances with one handle per instance (e.g. handle(i % count)), upload() and bind(); the vertex shader
+//   reads handles[gl_InstanceID] as a uvec2 and passes it flat to the fragment shader, which samples with
+//   texture(sampler2D(handle), uv). See perf_playground_instanced.vs/fs with BINDLESS defined.
+// - The shader declares the handle block with layout (std430, binding = 0) (the BINDLESS variant is compiled as
+//   430 core), so bind(0) is all the block needs; no per-program binding call.
+class BindlessTextures
+{
+public:
+    std::vector<GLuint64> instances; // the handle of every instance, uploaded by upload()
+
+    BindlessTextures() : capacity(0)
+    {
+        glGenBuffers(1, &handleBuffer);
+    }
+
+    // makes the texture resident and returns the index of its handle
+    // ------------------------------------------------------------------------
+    int makeResident(unsigned int texture)
+    {
+        GLuint64 handle = glGetTextureHandleARB(texture);
+        if (handle == 0)
+        {
+            std::cout << "ERROR::BINDLESS_TEXTURES::NO_HANDLE: texture " << texture << std::endl;
+            return -1;
+        }
+        glMakeTextureHandleResidentARB(handle);
+        handles.push_back(handle);
+        return (int)handles.size() - 1;
+    }
+    // ------------------------------------------------------------------------
+    GLuint64 handle(int index) const
+    {
+        return handles[index];
+    }
+    // ------------------------------------------------------------------------
+    int count() const
+    {
+        return (int)handles.size();
+    }
+    // copies the instance handles to the GPU; the buffer only grows
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, handleBuffer);
+        if (instances.size() > capacity)
+        {
+            capacity = instances.size();
+            glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(GLuint64), instances.data(), GL_DYNAMIC_DRAW);
+        }
+        else
+        {
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, instances.size() * sizeof(GLuint64), instances.data());
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    // ------------------------------------------------------------------------
+    void bind(unsigned int binding) const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, handleBuffer);
+    }
+    // makes every handle non-resident; do this before the textures are deleted
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (size_t i = 0; i < handles.size(); i++)
+            glMakeTextureHandleNonResidentARB(handles[i]);
+        handles.clear();
+        glDeleteBuffers(1, &handleBuffer);
+        handleBuffer = 0;
+    }
+
+private:
+    unsigned int handleBuffer;
+    size_t capacity;
+    std::vector<GLuint64> handles;
+};
+#endif
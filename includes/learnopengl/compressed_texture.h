@@ -0,0 +1,303 @@
+#ifndef COMPRESSED_TEXTURE_H
+#define COMPRESSED_TEXTURE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Loads pre-compressed textures (BC1/BC3/BC4/BC5/BC7, ETC2 and ASTC LDR) from KTX2 or DDS files and uploads
+// the whole mip chain stored in the file with glCompressedTexImage2D, so there's no decoding on the CPU and
+// no glGenerateMipmap at runtime. tools/texture_compressor writes these files from the resources/textures images.
+// The format checks use the extension flags from learnopengl/gl_extensions.h, so call loadGLExtensions first.
+
+struct CompressedLevel
+{
+    int width, height;
+    size_t offset, size; // into CompressedImage::data
+};
+
+struct CompressedImage
+{
+    GLenum internalFormat = 0;
+    int width = 0, height = 0;
+    std::vector<CompressedLevel> levels; // level 0 first
+    std::vector<unsigned char> data;
+};
+
+// Vulkan format numbers used by KTX2, and the matching GL formats
+// ------------------------------------------------------------------------
+struct CompressedFormatInfo
+{
+    unsigned int vkFormat;
+    unsigned int dxgiFormat;
+    GLenum glFormat;
+    int blockWidth, blockHeight, blockBytes;
+};
+inline const CompressedFormatInfo* compressedFormats(int& count)
+{
+    static const CompressedFormatInfo formats[] = {
+        { 131, 71, GL_COMPRESSED_RGB_S3TC_DXT1_EXT,      4, 4, 8 },  // BC1
+        { 137, 77, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,     4, 4, 16 }, // BC3
+        { 139, 80, GL_COMPRESSED_RED_RGTC1,              4, 4, 8 },  // BC4
+        { 141, 83, GL_COMPRESSED_RG_RGTC2,               4, 4, 16 }, // BC5
+        { 145, 98, GL_COMPRESSED_RGBA_BPTC_UNORM,        4, 4, 16 }, // BC7
+        { 146, 99, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,  4, 4, 16 }, // BC7 sRGB
+        { 147, 0,  GL_COMPRESSED_RGB8_ETC2,              4, 4, 8 },
+        { 151, 0,  GL_COMPRESSED_RGBA8_ETC2_EAC,         4, 4, 16 },
+        { 157, 0,  GL_COMPRESSED_RGBA_ASTC_4x4_KHR,      4, 4, 16 },
+        { 165, 0,  GL_COMPRESSED_RGBA_ASTC_6x6_KHR,      6, 6, 16 },
+        { 171, 0,  GL_COMPRESSED_RGBA_ASTC_8x8_KHR,      8, 8, 16 },
+    };
+    count = sizeof(formats) / sizeof(formats[0]);
+    return formats;
+}
+inline const CompressedFormatInfo* findCompressedFormat(GLenum glFormat)
+{
+    int count;
+    const CompressedFormatInfo* formats = compressedFormats(count);
+    for (int i = 0; i < count; i++)
+        if (formats[i].glFormat == glFormat)
+            return &formats[i];
+    return NULL;
+}
+
+// whether the driver can sample the given compressed format
+// ------------------------------------------------------------------------
+inline bool isCompressedFormatSupported(GLenum format)
+{
+    switch (format)
+    {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        return GLAD_GL_EXT_texture_compression_s3tc != 0;
+    case GL_COMPRESSED_RED_RGTC1:
+    case GL_COMPRESSED_RG_RGTC2:
+        return true; // core since OpenGL 3.0
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
+    case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        return GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_texture_compression_bptc;
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        return GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_ES3_compatibility;
+    case GL_COMPRESSED_RGBA_ASTC_4x4_KHR:
+    case GL_COMPRESSED_RGBA_ASTC_6x6_KHR:
+    case GL_COMPRESSED_RGBA_ASTC_8x8_KHR:
+        return GLAD_GL_KHR_texture_compression_astc_ldr != 0;
+    }
+    return false;
+}
+
+// size in bytes of one level: the number of blocks that cover it times the bytes per block
+// ------------------------------------------------------------------------
+inline size_t compressedLevelSize(const CompressedFormatInfo& info, int width, int height)
+{
+    return (size_t)((width + info.blockWidth - 1) / info.blockWidth) * ((height + info.blockHeight - 1) / info.blockHeight) * info.blockBytes;
+}
+
+inline bool readTextureFile(const std::string& path, std::vector<unsigned char>& data)
+{
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    data.resize((size_t)file.tellg());
+    file.seekg(0);
+    file.read((char*)data.data(), data.size());
+    return (bool)file;
+}
+
+// the most levels a full chain down to 1x1 can have: 1 + floor(log2(max(width, height)))
+// ------------------------------------------------------------------------
+inline unsigned int maxCompressedLevels(unsigned int width, unsigned int height)
+{
+    unsigned int levels = 1;
+    for (unsigned int edge = std::max(width, height); edge > 1; edge >>= 1)
+        levels++;
+    return levels;
+}
+
+// the header sizes are untrusted (the files may come out of an asset pack), so anything that isn't a positive
+// edge below 64k is refused before it reaches the level math
+// ------------------------------------------------------------------------
+inline bool validCompressedExtent(unsigned int width, unsigned int height)
+{
+    return width > 0 && height > 0 && width <= 65536 && height <= 65536;
+}
+
+template <typename T> inline T readTextureValue(const unsigned char* data, size_t offset)
+{
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+// KTX2: 12 byte identifier, 9 header words, the index and one (offset, length, uncompressed length) entry per level.
+// Only the header is read: the level offsets point into bytes, which is not copied (see loadAssetPackTexture).
+// Every count, offset and length is checked against size without overflowing, and each level must hold exactly
+// the blocks its dimensions need.
+// ------------------------------------------------------------------------
+inline bool parseKTX2(const unsigned char* bytes, size_t size, CompressedImage& image, const std::string& name)
+{
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    if (size < 80 || std::memcmp(bytes, identifier, 12) != 0)
+        return false;
+    unsigned int vkFormat = readTextureValue<unsigned int>(bytes, 12);
+    unsigned int width = readTextureValue<unsigned int>(bytes, 20);
+    unsigned int height = readTextureValue<unsigned int>(bytes, 24);
+    unsigned int levelCount = std::max(1u, readTextureValue<unsigned int>(bytes, 40));
+    if (!validCompressedExtent(width, height) || levelCount > maxCompressedLevels(width, height))
+        return false;
+    image.width = (int)width;
+    image.height = (int)height;
+    unsigned int supercompression = readTextureValue<unsigned int>(bytes, 44);
+    if (supercompression != 0)
+    {
+        std::cout << "ERROR::KTX2::SUPERCOMPRESSION_NOT_SUPPORTED: " << name << std::endl;
+        return false;
+    }
+    int count;
+    const CompressedFormatInfo* formats = compressedFormats(count);
+    const CompressedFormatInfo* info = NULL;
+    for (int i = 0; i < count; i++)
+        if (formats[i].vkFormat == vkFormat)
+            info = &formats[i];
+    if (!info || (size_t)levelCount > (size - 80) / 24)
+        return false;
+    image.internalFormat = info->glFormat;
+    image.levels.clear();
+    for (unsigned int i = 0; i < levelCount; i++)
+    {
+        CompressedLevel level;
+        level.width = std::max(1, image.width >> i);
+        level.height = std::max(1, image.height >> i);
+        unsigned long long offset = readTextureValue<unsigned long long>(bytes, 80 + (size_t)i * 24);
+        unsigned long long length = readTextureValue<unsigned long long>(bytes, 80 + (size_t)i * 24 + 8);
+        if (offset > size || length > size - offset)
+            return false;
+        level.offset = (size_t)offset;
+        level.size = (size_t)length;
+        if (level.size != compressedLevelSize(*info, level.width, level.height))
+            return false;
+        image.levels.push_back(level);
+    }
+    return true;
+}
+// ------------------------------------------------------------------------
+inline bool loadKTX2(const std::string& path, CompressedImage& image)
+{
+    return readTextureFile(path, image.data) && parseKTX2(image.data.data(), image.data.size(), image, path);
+}
+
+// DDS: "DDS " magic, a 124 byte header and, for the DX10 FourCC, a 20 byte extension with the DXGI format
+// ------------------------------------------------------------------------
+inline bool parseDDS(const unsigned char* bytes, size_t size, CompressedImage& image)
+{
+    if (size < 128 || std::memcmp(bytes, "DDS ", 4) != 0)
+        return false;
+    unsigned int height = readTextureValue<unsigned int>(bytes, 12);
+    unsigned int width = readTextureValue<unsigned int>(bytes, 16);
+    unsigned int mipCount = std::max(1u, readTextureValue<unsigned int>(bytes, 28));
+    if (!validCompressedExtent(width, height) || mipCount > maxCompressedLevels(width, height))
+        return false;
+    image.width = (int)width;
+    image.height = (int)height;
+    unsigned int fourCC = readTextureValue<unsigned int>(bytes, 84);
+    size_t offset = 128;
+    GLenum format = 0;
+    if (fourCC == 0x31545844) // "DXT1"
+        format = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    else if (fourCC == 0x35545844) // "DXT5"
+        format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    else if (fourCC == 0x31495441) // "ATI1"
+        format = GL_COMPRESSED_RED_RGTC1;
+    else if (fourCC == 0x32495441) // "ATI2"
+        format = GL_COMPRESSED_RG_RGTC2;
+    else if (fourCC == 0x30315844 && size >= 148) // "DX10"
+    {
+        unsigned int dxgiFormat = readTextureValue<unsigned int>(bytes, 128);
+        int count;
+        const CompressedFormatInfo* formats = compressedFormats(count);
+        for (int i = 0; i < count; i++)
+            if (formats[i].dxgiFormat != 0 && formats[i].dxgiFormat == dxgiFormat)
+                format = formats[i].glFormat;
+        offset = 148;
+    }
+    const CompressedFormatInfo* info = findCompressedFormat(format);
+    if (!info)
+        return false;
+    image.internalFormat = format;
+    image.levels.clear();
+    for (unsigned int i = 0; i < mipCount; i++)
+    {
+        CompressedLevel level;
+        level.width = std::max(1, image.width >> i);
+        level.height = std::max(1, image.height >> i);
+        level.offset = offset;
+        level.size = compressedLevelSize(*info, level.width, level.height);
+        if (offset > size || level.size > size - offset)
+            return false;
+        image.levels.push_back(level);
+        offset += level.size;
+    }
+    return true;
+}
+// ------------------------------------------------------------------------
+inline bool loadDDS(const std::string& path, CompressedImage& image)
+{
+    return readTextureFile(path, image.data) && parseDDS(image.data.data(), image.data.size(), image);
+}
+
+// uploads every level of the image into the texture currently bound to GL_TEXTURE_2D; the level offsets are
+// relative to bytes, which is image.data unless the image was parsed straight out of memory
+// ------------------------------------------------------------------------
+inline void uploadCompressedImage(const CompressedImage& image, const unsigned char* bytes)
+{
+    for (size_t i = 0; i < image.levels.size(); i++)
+    {
+        const CompressedLevel& level = image.levels[i];
+        glCompressedTexImage2D(GL_TEXTURE_2D, (int)i, image.internalFormat, level.width, level.height, 0,
+                               (GLsizei)level.size, bytes + level.offset);
+    }
+    // only the stored levels exist, so limit sampling to them instead of generating the rest
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)image.levels.size() - 1);
+}
+// ------------------------------------------------------------------------
+inline void uploadCompressedImage(const CompressedImage& image)
+{
+    uploadCompressedImage(image, image.data.data());
+}
+// creates a texture object from a parsed image; returns 0 if the driver lacks the format
+// ------------------------------------------------------------------------
+inline unsigned int createCompressedTexture(const CompressedImage& image, const unsigned char* bytes, const std::string& name)
+{
+    if (!isCompressedFormatSupported(image.internalFormat))
+    {
+        std::cout << "Compressed texture format 0x" << std::hex << image.internalFormat << std::dec << " not supported: " << name << std::endl;
+        return 0;
+    }
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    uploadCompressedImage(image, bytes);
+    return texture;
+}
+
+// loads a .ktx2 or .dds file into a new texture object; returns 0 if the file is missing, can't be parsed or
+// the driver lacks the format, so the caller can fall back to the uncompressed image
+// ------------------------------------------------------------------------
+inline unsigned int loadCompressedTexture(const std::string& path)
+{
+    CompressedImage image;
+    bool dds = path.size() > 4 && path.compare(path.size() - 4, 4, ".dds") == 0;
+    if (!(dds ? loadDDS(path, image) : loadKTX2(path, image)))
+        return 0;
+    return createCompressedTexture(image, image.data.data(), path);
+}
+#endif
@@ -0,0 +1,244 @@
+#ifndef DRAW_QUEUE_H
+#define DRAW_QUEUE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/frame_allocator.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/shader_s.h>
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// one uniform value of a draw item, set through the name hash of the Shader (see uniformHash)
+struct DrawUniform
+{
+    enum Type { INT, FLOAT, VEC4 };
+
+    unsigned int nameHash;
+    Type type;
+    float value[4];
+};
+
+// everything one indexed draw call needs: state, index range and up to MAX_UNIFORMS uniform values
+struct DrawItem
+{
+    static const int MAX_UNIFORMS = 4;
+
+    Shader* shader = NULL;
+    unsigned int VAO = 0;
+    unsigned int texture = 0;    // bound to textureTarget on unit 0, 0 for none
+    GLenum textureTarget = GL_TEXTURE_2D;
+    unsigned int layer = 0;      // drawn in ascending order (e.g. opaque before transparent), 0-255
+    GLsizei indexCount = 0;
+    unsigned int firstIndex = 0; // in indices, not bytes; the indices are GL_UNSIGNED_INT
+    int baseVertex = 0;
+    int uniformCount = 0;
+    DrawUniform uniforms[MAX_UNIFORMS];
+
+    // ------------------------------------------------------------------------
+    void setInt(unsigned int nameHash, int value)
+    {
+        DrawUniform& uniform = addUniform(nameHash, DrawUniform::INT);
+        uniform.value[0] = (float)value;
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(unsigned int nameHash, float value)
+    {
+        DrawUniform& uniform = addUniform(nameHash, DrawUniform::FLOAT);
+        uniform.value[0] = value;
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(unsigned int nameHash, float x, float y, float z, float w)
+    {
+        DrawUniform& uniform = addUniform(nameHash, DrawUniform::VEC4);
+        uniform.value[0] = x; uniform.value[1] = y; uniform.value[2] = z; uniform.value[3] = w;
+    }
+
+private:
+    // ------------------------------------------------------------------------
+    DrawUniform& addUniform(unsigned int nameHash, DrawUniform::Type type)
+    {
+        int i = uniformCount < MAX_UNIFORMS ? uniformCount++ : MAX_UNIFORMS - 1; // overflow overwrites the last one
+        uniforms[i].nameHash = nameHash;
+        uniforms[i].type = type;
+        std::memset(uniforms[i].value, 0, sizeof(uniforms[i].value));
+        return uniforms[i];
+    }
+};
+
+// per-flush counters
+struct DrawQueueStats
+{
+    int items = 0;        // submitted draw items
+    int draws = 0;        // draw calls that were issued for them
+    int programChanges = 0;
+    int vaoChanges = 0;
+    int textureChanges = 0;
+};
+
+// Retained draw queue: submit() the draw items of a frame in any order, flush() draws them with as few state
+// changes and draw calls as possible.
+// - Every item gets a 64 bit sort key, from the most to the least expensive state to change:
+//   layer (8 bits) | program (16) | VAO (16) | texture (16) | unused (8). flush() radix-sorts the keys, so
+//   all items with the same program end up together, within those the same VAO, and so on.
+// - The key only holds the low 16 bits of every GL name, so in the (unlikely) case two names collide the
+//   items still draw correctly, they just may not be grouped.
+// - Neighbours with the same state and uniforms whose index ranges follow each other are merged into one
+//   draw call; when only the uniforms differ just the uniforms are set in between. A uniform an item does
+//   not set keeps the value it had in the program.
+// - Binds go through a GLState, so they are also skipped against whatever was bound before the flush.
+// - The keys and the sort order only live for one flush; they come from a FrameArena that is reset at its end.
+class DrawQueue
+{
+public:
+    DrawQueueStats stats; // of the last flush()
+
+    // ------------------------------------------------------------------------
+    void submit(const DrawItem& item)
+    {
+        items.push_back(item);
+    }
+    // sorts, merges and draws everything submitted since the last flush, then empties the queue
+    // ------------------------------------------------------------------------
+    void flush(GLState& state)
+    {
+        stats = DrawQueueStats();
+        stats.items = (int)items.size();
+        size_t count = items.size();
+        const unsigned int* order = sortItems();
+
+        const DrawItem* previous = NULL;
+        size_t i = 0;
+        while (i < count)
+        {
+            const DrawItem& item = items[order[i]];
+            if (!previous || previous->shader != item.shader)
+            {
+                state.useProgram(item.shader->ID);
+                stats.programChanges++;
+            }
+            if (!previous || previous->VAO != item.VAO)
+            {
+                state.bindVertexArray(item.VAO);
+                stats.vaoChanges++;
+            }
+            if (!previous || previous->texture != item.texture || previous->textureTarget != item.textureTarget)
+            {
+                state.bindTexture(item.textureTarget, item.texture);
+                stats.textureChanges++;
+            }
+            if (!previous || !sameUniforms(*previous, item) || previous->shader != item.shader)
+                applyUniforms(item);
+
+            // extend the draw over every following item that continues the index range
+            GLsizei indexCount = item.indexCount;
+            size_t next = i + 1;
+            while (next < count && mergeable(item, indexCount, items[order[next]]))
+                indexCount += items[order[next++]].indexCount;
+
+            const void* indices = (const void*)(item.firstIndex * sizeof(unsigned int));
+            if (item.baseVertex != 0)
+                glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices, item.baseVertex);
+            else
+                glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indices);
+            stats.draws++;
+            previous = &items[order[next - 1]];
+            i = next;
+        }
+        items.clear();
+        scratch.reset();
+    }
+
+private:
+    std::vector<DrawItem> items;
+    FrameArena scratch{ 16 * 1024, "draw queue" };
+
+    // ------------------------------------------------------------------------
+    static unsigned long long sortKey(const DrawItem& item)
+    {
+        return ((unsigned long long)(item.layer & 0xFF) << 56)
+             | ((unsigned long long)(item.shader->ID & 0xFFFF) << 40)
+             | ((unsigned long long)(item.VAO & 0xFFFF) << 24)
+             | ((unsigned long long)(item.texture & 0xFFFF) << 8);
+    }
+    // LSD radix sort of the keys, 8 bits per pass; equal keys keep the submission order. Passes where every key
+    // has the same byte are skipped, so a frame with a single program or VAO only pays for the bytes that differ.
+    // Returns the item indices in key order, valid until the scratch arena is reset.
+    // ------------------------------------------------------------------------
+    const unsigned int* sortItems()
+    {
+        size_t count = items.size();
+        unsigned long long* keys = scratch.allocateArray<unsigned long long>(count);
+        unsigned long long* keysScratch = scratch.allocateArray<unsigned long long>(count);
+        unsigned int* order = scratch.allocateArray<unsigned int>(count);
+        unsigned int* orderScratch = scratch.allocateArray<unsigned int>(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            keys[i] = sortKey(items[i]);
+            order[i] = (unsigned int)i;
+        }
+        for (int shift = 8; shift < 64; shift += 8)
+        {
+            size_t histogram[256] = { 0 };
+            for (size_t i = 0; i < count; i++)
+                histogram[(keys[i] >> shift) & 0xFF]++;
+            if (count == 0 || histogram[(keys[0] >> shift) & 0xFF] == count)
+                continue;
+            size_t offsets[256];
+            size_t sum = 0;
+            for (int b = 0; b < 256; b++)
+            {
+                offsets[b] = sum;
+                sum += histogram[b];
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t to = offsets[(keys[i] >> shift) & 0xFF]++;
+                keysScratch[to] = keys[i];
+                orderScratch[to] = order[i];
+            }
+            std::swap(keys, keysScratch);
+            std::swap(order, orderScratch);
+        }
+        return order;
+    }
+    // ------------------------------------------------------------------------
+    static bool sameUniforms(const DrawItem& a, const DrawItem& b)
+    {
+        if (a.uniformCount != b.uniformCount)
+            return false;
+        for (int i = 0; i < a.uniformCount; i++)
+        {
+            const DrawUniform& x = a.uniforms[i];
+            const DrawUniform& y = b.uniforms[i];
+            if (x.nameHash != y.nameHash || x.type != y.type || std::memcmp(x.value, y.value, sizeof(x.value)) != 0)
+                return false;
+        }
+        return true;
+    }
+    // whether next can join a draw that starts at first and covers count indices so far
+    // ------------------------------------------------------------------------
+    static bool mergeable(const DrawItem& first, GLsizei count, const DrawItem& next)
+    {
+        return next.shader == first.shader && next.VAO == first.VAO && next.texture == first.texture && next.textureTarget == first.textureTarget
+            && next.baseVertex == first.baseVertex && next.firstIndex == first.firstIndex + (unsigned int)count
+            && sameUniforms(first, next);
+    }
+    // ------------------------------------------------------------------------
+    static void applyUniforms(const DrawItem& item)
+    {
+        for (int i = 0; i < item.uniformCount; i++)
+        {
+            const DrawUniform& uniform = item.uniforms[i];
+            if (uniform.type == DrawUniform::INT)
+                item.shader->setInt(uniform.nameHash, (int)uniform.value[0]);
+            else if (uniform.type == DrawUniform::FLOAT)
+                item.shader->setFloat(uniform.nameHash, uniform.value[0]);
+            else
+                item.shader->setVec4(uniform.nameHash, uniform.value[0], uniform.value[1], uniform.value[2], uniform.value[3]);
+        }
+    }
+};
+#endif
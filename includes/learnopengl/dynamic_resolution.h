@@ -0,0 +1,278 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// how DynamicResolution brings the scene up to the window size
+enum UpscaleFilter
+{
+    UPSCALE_BILINEAR, // glBlitFramebuffer with GL_LINEAR
+    UPSCALE_SHARPEN   // bilinear plus a sharpening pass limited to the local contrast, so it does not ring;
+                      // at scale 1 the scene is copied as it is
+};
+
+// Renders the scene into an offscreen target at a fraction of the window size and scales it up to the window,
+// with the fraction chosen so the scene's GPU time stays at the target.
+// - beginScene() binds the target and sets the viewport to the scaled size, endScene() draws it into the default
+//   framebuffer and restores the full viewport, so whatever comes after (an overlay, text) stays sharp.
+// - The target is allocated once for the largest size it has to hold and the scale only changes the viewport
+//   into it. The window size is read in beginScene(), not in the resize callback, and the target is only
+//   reallocated when the window outgrew it or shrank to a quarter of its area; sizes round up to 128 pixels,
+//   so dragging a window edge does not reallocate every frame.
+// - update() takes the GPU time of the scene (e.g. FrameProfiler::latest of its GpuScope) and steers the pixel
+//   count, which the fragment work is roughly proportional to: the scale moves by sqrt(target / time), after a
+//   moving average, at most MAX_STEP at a time and only when the time leaves a band of 80-100% of the target.
+//   After a change it waits SETTLE_FRAMES frames, as the timer queries show the new scale a few frames late.
+// - GL objects and binds go behind a GLState's back: invalidate() it after endScene().
+class DynamicResolution
+{
+public:
+    float targetMs;  // GPU time per frame the scene should take
+    float minScale;  // of the window size, per axis
+    float maxScale;
+    float scale;     // the current one
+    UpscaleFilter filter;
+    float sharpness; // UPSCALE_SHARPEN: 0 is plain bilinear, 1 the strongest
+    unsigned long reallocations = 0;
+    unsigned long scaleChanges = 0;
+
+    DynamicResolution(float targetMs = 12.0f, UpscaleFilter filter = UPSCALE_SHARPEN, float minScale = 0.5f, float maxScale = 1.0f)
+        : targetMs(targetMs), minScale(minScale), maxScale(maxScale), scale(maxScale), filter(filter), sharpness(0.5f),
+          framebuffer(0), colorTexture(0), depthBuffer(0), capacityWidth(0), capacityHeight(0), windowWidth(0), windowHeight(0),
+          sceneWidth(0), sceneHeight(0), smoothedMs(0.0f), settleFrames(0), sharpenProgram(0), sharpenVAO(0),
+          uvScaleLocation(-1), texelSizeLocation(-1), sharpnessLocation(-1)
+    {
+    }
+
+    // renders into the target from here on; window is the one whose default framebuffer endScene() draws to
+    // ------------------------------------------------------------------------
+    void beginScene(GLFWwindow* window)
+    {
+        glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+        windowWidth = std::max(windowWidth, 1);
+        windowHeight = std::max(windowHeight, 1);
+        int neededWidth = (int)std::ceil(windowWidth * maxScale), neededHeight = (int)std::ceil(windowHeight * maxScale);
+        if (neededWidth > capacityWidth || neededHeight > capacityHeight || 4 * neededWidth * neededHeight < capacityWidth * capacityHeight)
+            allocate(roundUp(neededWidth), roundUp(neededHeight));
+        sceneWidth = std::max(1, std::min(capacityWidth, (int)(windowWidth * scale + 0.5f)));
+        sceneHeight = std::max(1, std::min(capacityHeight, (int)(windowHeight * scale + 0.5f)));
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, sceneWidth, sceneHeight);
+    }
+    // scales the scene up into the default framebuffer and makes it the draw target again
+    // ------------------------------------------------------------------------
+    void endScene()
+    {
+        bool nativeSize = sceneWidth == windowWidth && sceneHeight == windowHeight;
+        if (filter == UPSCALE_SHARPEN && sharpness > 0.0f && !nativeSize)
+        {
+            if (sharpenProgram == 0)
+                createSharpenPass();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, windowWidth, windowHeight);
+            glUseProgram(sharpenProgram);
+            glUniform2f(uvScaleLocation, (float)sceneWidth / capacityWidth, (float)sceneHeight / capacityHeight);
+            glUniform2f(texelSizeLocation, 1.0f / capacityWidth, 1.0f / capacityHeight);
+            glUniform1f(sharpnessLocation, sharpness);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, colorTexture);
+            glBindVertexArray(sharpenVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glBindVertexArray(0);
+        }
+        else
+        {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, sceneWidth, sceneHeight, 0, 0, windowWidth, windowHeight, GL_COLOR_BUFFER_BIT,
+                              nativeSize ? GL_NEAREST : GL_LINEAR);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, windowWidth, windowHeight);
+        }
+    }
+    // adjusts the scale for the next frames to the GPU time a recent frame's scene took; call once per frame
+    // ------------------------------------------------------------------------
+    void update(float sceneGpuMs)
+    {
+        if (sceneGpuMs <= 0.0f)
+            return;
+        if (settleFrames > 0)
+        {
+            settleFrames--;
+            return;
+        }
+        smoothedMs = smoothedMs > 0.0f ? smoothedMs + SMOOTHING * (sceneGpuMs - smoothedMs) : sceneGpuMs;
+        if (smoothedMs <= targetMs && smoothedMs >= HEADROOM * targetMs)
+            return;
+        // pixels are scale squared, so the time goes with the square of the scale
+        float step = std::sqrt(targetMs / smoothedMs);
+        step = std::max(1.0f / MAX_STEP, std::min(MAX_STEP, step));
+        // rounded away from the current scale, so a small step still moves by a quantum instead of back to it
+        float quanta = scale * step / SCALE_QUANTUM;
+        quanta = smoothedMs > targetMs ? std::floor(quanta) : std::ceil(quanta);
+        float next = std::max(minScale, std::min(maxScale, quanta * SCALE_QUANTUM));
+        if (next == scale)
+            return;
+        scale = next;
+        scaleChanges++;
+        smoothedMs = 0.0f; // the average was of the old scale
+        settleFrames = SETTLE_FRAMES;
+    }
+    // the size the scene is rendered at this frame
+    // ------------------------------------------------------------------------
+    int width() const
+    {
+        return sceneWidth;
+    }
+    // ------------------------------------------------------------------------
+    int height() const
+    {
+        return sceneHeight;
+    }
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout) const
+    {
+        out << "DynamicResolution: scale " << scale << " (" << sceneWidth << "x" << sceneHeight << " of " << windowWidth << "x"
+            << windowHeight << "), " << scaleChanges << " scale changes, " << reallocations << " target allocations" << std::endl;
+    }
+    // deletes the target and the sharpening pass; call before the context is destroyed
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        freeTarget();
+        if (sharpenProgram != 0)
+        {
+            glDeleteProgram(sharpenProgram);
+            glDeleteVertexArrays(1, &sharpenVAO);
+            sharpenProgram = sharpenVAO = 0;
+            uvScaleLocation = texelSizeLocation = sharpnessLocation = -1;
+        }
+    }
+
+private:
+    static constexpr float SMOOTHING = 0.2f;       // weight of a new time in the moving average
+    static constexpr float HEADROOM = 0.8f;        // below this fraction of the target the scale goes up again
+    static constexpr float MAX_STEP = 1.15f;       // largest change of the scale at once, up or down
+    static constexpr float SCALE_QUANTUM = 0.025f; // scales are multiples of this, so tiny changes don't thrash
+    static const int SETTLE_FRAMES = 4;
+    static const int SIZE_QUANTUM = 128;
+
+    unsigned int framebuffer, colorTexture, depthBuffer;
+    int capacityWidth, capacityHeight; // of the target
+    int windowWidth, windowHeight;
+    int sceneWidth, sceneHeight;
+    float smoothedMs;
+    int settleFrames;
+    unsigned int sharpenProgram, sharpenVAO;
+    int uvScaleLocation, texelSizeLocation, sharpnessLocation; // looked up once in createSharpenPass()
+
+    // ------------------------------------------------------------------------
+    static int roundUp(int size)
+    {
+        return (size + SIZE_QUANTUM - 1) / SIZE_QUANTUM * SIZE_QUANTUM;
+    }
+    // ------------------------------------------------------------------------
+    void allocate(int width, int height)
+    {
+        freeTarget();
+        glGenTextures(1, &colorTexture);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE: " << width << "x" << height << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        capacityWidth = width;
+        capacityHeight = height;
+        reallocations++;
+    }
+    // ------------------------------------------------------------------------
+    void freeTarget()
+    {
+        if (framebuffer == 0)
+            return;
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        glDeleteTextures(1, &colorTexture);
+        framebuffer = depthBuffer = colorTexture = 0;
+        capacityWidth = capacityHeight = 0;
+    }
+    // a full screen triangle that samples the scene bilinearly and sharpens it with the four neighbours,
+    // clamped to their range
+    // ------------------------------------------------------------------------
+    void createSharpenPass()
+    {
+        const char* vertexCode = "#version 330 core\n"
+            "out vec2 TexCoord;\n"
+            "void main()\n"
+            "{\n"
+            "   vec2 corner = vec2(gl_VertexID == 1 ? 2.0 : 0.0, gl_VertexID == 2 ? 2.0 : 0.0);\n"
+            "   TexCoord = corner;\n"
+            "   gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);\n"
+            "}\0";
+        const char* fragmentCode = "#version 330 core\n"
+            "in vec2 TexCoord;\n"
+            "out vec4 FragColor;\n"
+            "uniform sampler2D scene;\n"
+            "uniform vec2 uvScale;\n"
+            "uniform vec2 texelSize;\n"
+            "uniform float sharpness;\n"
+            "vec3 fetch(vec2 uv)\n"
+            "{\n"
+            "   return texture(scene, clamp(uv, 0.5 * texelSize, uvScale - 0.5 * texelSize)).rgb;\n"
+            "}\n"
+            "void main()\n"
+            "{\n"
+            "   vec2 uv = TexCoord * uvScale;\n"
+            "   vec3 center = fetch(uv);\n"
+            "   vec3 north = fetch(uv + vec2(0.0, texelSize.y));\n"
+            "   vec3 south = fetch(uv - vec2(0.0, texelSize.y));\n"
+            "   vec3 east = fetch(uv + vec2(texelSize.x, 0.0));\n"
+            "   vec3 west = fetch(uv - vec2(texelSize.x, 0.0));\n"
+            "   vec3 low = min(center, min(min(north, south), min(east, west)));\n"
+            "   vec3 high = max(center, max(max(north, south), max(east, west)));\n"
+            "   vec3 sharpened = center + sharpness * (4.0 * center - north - south - east - west) * 0.5;\n"
+            "   FragColor = vec4(clamp(sharpened, low, high), 1.0);\n"
+            "}\n\0";
+        unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vertexCode, NULL);
+        glCompileShader(vertex);
+        unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fragmentCode, NULL);
+        glCompileShader(fragment);
+        sharpenProgram = glCreateProgram();
+        glAttachShader(sharpenProgram, vertex);
+        glAttachShader(sharpenProgram, fragment);
+        glLinkProgram(sharpenProgram);
+        int success;
+        glGetProgramiv(sharpenProgram, GL_LINK_STATUS, &success);
+        if (!success)
+            std::cout << "ERROR::DYNAMIC_RESOLUTION::SHARPEN_PROGRAM_LINKING_FAILED" << std::endl;
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+        glUseProgram(sharpenProgram);
+        glUniform1i(glGetUniformLocation(sharpenProgram, "scene"), 0);
+        uvScaleLocation = glGetUniformLocation(sharpenProgram, "uvScale");
+        texelSizeLocation = glGetUniformLocation(sharpenProgram, "texelSize");
+        sharpnessLocation = glGetUniformLocation(sharpenProgram, "sharpness");
+        // the triangle comes from gl_VertexID, but a core profile still wants a vertex array bound
+        glGenVertexArrays(1, &sharpenVAO);
+    }
+};
+#endif
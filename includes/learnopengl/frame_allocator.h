@@ -0,0 +1,441 @@
+#ifndef FRAME_ALLOCATOR_H
+#define FRAME_ALLOCATOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Counts the heap allocations of every frame per subsystem, to keep the steady state of a render loop free of
+// them: a general purpose new on the render thread takes a lock and now and then a page fault, which shows up
+// as a hitch in the frame times.
+// - A subsystem is a name registered with subsystem(); AllocationScope tags what the calling thread allocates
+//   until it goes out of scope, jobs of a JobSystem inherit the tag of the thread that ran them. Whatever is
+//   allocated outside a scope counts as "untagged".
+// - FrameArena and ObjectPool record their own blocks. To count every operator new of the program as well,
+//   #define FRAME_ALLOCATOR_REPLACE_NEW before including this header, in one .cpp file only (the samples are a
+//   single one each); the replacements forward to malloc and free.
+// - endFrame() closes the counts of a frame. After enforceZeroAllocations(frames) every frame after the first
+//   frames that allocates in a subsystem not marked exempt (loading, stress steps and the like) is reported
+//   as an error, with the subsystems it allocated in.
+// - Registration and the counters use fixed arrays and atomics, so the tracker itself never allocates.
+class AllocationTracker
+{
+public:
+    static constexpr int MAX_SUBSYSTEMS = 16;
+    static constexpr int UNTAGGED = 0;
+    static constexpr int IGNORED = -1; // a scope that is not counted, e.g. the tracker's own output
+
+    // the tracker of the program
+    // ------------------------------------------------------------------------
+    static AllocationTracker& instance()
+    {
+        static AllocationTracker tracker;
+        return tracker;
+    }
+    // the index of the subsystem name (which has to outlive the tracker, e.g. a literal), registered the first
+    // time it is asked for; allocations of an exempt subsystem never count against the zero allocation policy.
+    // Names beyond MAX_SUBSYSTEMS count as untagged.
+    // ------------------------------------------------------------------------
+    int subsystem(const char* name, bool exempt = false)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int registered = count.load(std::memory_order_relaxed);
+        for (int i = 0; i < registered; i++)
+            if (!strcmp(subsystems[i].name, name))
+                return i;
+        if (registered == MAX_SUBSYSTEMS)
+        {
+            std::cout << "ERROR::ALLOCATION::TOO_MANY_SUBSYSTEMS: " << name << " counts as untagged" << std::endl;
+            return UNTAGGED;
+        }
+        subsystems[registered].name = name;
+        subsystems[registered].exempt = exempt;
+        count.store(registered + 1, std::memory_order_release);
+        return registered;
+    }
+    // counts one allocation of bytes in subsystem in the current frame; any thread
+    // ------------------------------------------------------------------------
+    void record(int subsystem, size_t bytes)
+    {
+        if (subsystem < 0)
+            return;
+        subsystems[subsystem].frameBytes.fetch_add(bytes, std::memory_order_relaxed);
+        subsystems[subsystem].frameCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    // the subsystem the calling thread allocates for (see AllocationScope)
+    // ------------------------------------------------------------------------
+    static int& current()
+    {
+        static thread_local int subsystem = UNTAGGED;
+        return subsystem;
+    }
+    // reports the frames that allocate from frame afterFrames on (counted from the next endFrame())
+    // ------------------------------------------------------------------------
+    void enforceZeroAllocations(unsigned long afterFrames)
+    {
+        enforceFrom = frames + afterFrames;
+        enforcing = true;
+    }
+    // closes the counts of the frame; returns the number of allocations it made
+    // ------------------------------------------------------------------------
+    unsigned long endFrame()
+    {
+        unsigned long allocations = 0, violating = 0;
+        int registered = count.load(std::memory_order_acquire);
+        for (int i = 0; i < registered; i++)
+        {
+            Subsystem& s = subsystems[i];
+            s.lastBytes = s.frameBytes.exchange(0, std::memory_order_relaxed);
+            s.lastCount = s.frameCount.exchange(0, std::memory_order_relaxed);
+            s.totalBytes += s.lastBytes;
+            s.totalCount += s.lastCount;
+            s.peakBytes = std::max(s.peakBytes, s.lastBytes);
+            if (s.lastCount > 0)
+                s.framesAllocating++;
+            allocations += s.lastCount;
+            if (!s.exempt)
+                violating += s.lastCount;
+        }
+        frames++;
+        if (enforcing && frames > enforceFrom && violating > 0)
+        {
+            // printing may allocate (the first time a stream is written to), which is not the frame's doing
+            AllocationScope quiet(IGNORED);
+            if (violations++ < MAX_REPORTED_VIOLATIONS)
+            {
+                std::cout << "ERROR::ALLOCATION::STEADY_STATE: frame " << frames << " allocated";
+                for (int i = 0; i < registered; i++)
+                    if (subsystems[i].lastCount > 0 && !subsystems[i].exempt)
+                        std::cout << " " << subsystems[i].name << " " << subsystems[i].lastCount << "x (" << subsystems[i].lastBytes << " bytes)";
+                std::cout << std::endl;
+            }
+        }
+        return allocations;
+    }
+    // what every subsystem allocated over all frames, and in how many of them
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout)
+    {
+        AllocationScope quiet(IGNORED);
+        for (int i = 0; i < count.load(std::memory_order_acquire); i++)
+        {
+            const Subsystem& s = subsystems[i];
+            if (s.totalCount == 0)
+                continue;
+            out << "allocations " << s.name << ": " << s.totalCount << " (" << s.totalBytes << " bytes) in " << s.framesAllocating
+                << " of " << frames << " frames, peak " << s.peakBytes << " bytes/frame" << (s.exempt ? " (exempt)" : "") << std::endl;
+        }
+        if (enforcing)
+            out << "allocations: " << violations << " frames broke the zero allocation policy" << std::endl;
+    }
+    // ------------------------------------------------------------------------
+    unsigned long violationCount() const
+    {
+        return violations;
+    }
+
+    // Tags what the calling thread allocates with a subsystem until the scope ends; scopes nest.
+    class AllocationScope
+    {
+    public:
+        AllocationScope(int subsystem) : previous(current())
+        {
+            current() = subsystem;
+        }
+        ~AllocationScope()
+        {
+            current() = previous;
+        }
+        AllocationScope(const AllocationScope&) = delete;
+        AllocationScope& operator=(const AllocationScope&) = delete;
+
+    private:
+        int previous;
+    };
+
+private:
+    static const unsigned long MAX_REPORTED_VIOLATIONS = 10; // report() still counts all of them
+
+    struct Subsystem
+    {
+        const char* name = NULL;
+        bool exempt = false;
+        std::atomic<size_t> frameBytes{ 0 };
+        std::atomic<unsigned long> frameCount{ 0 };
+        size_t lastBytes = 0, totalBytes = 0, peakBytes = 0;
+        unsigned long lastCount = 0, totalCount = 0, framesAllocating = 0;
+    };
+
+    std::mutex mutex;
+    Subsystem subsystems[MAX_SUBSYSTEMS];
+    std::atomic<int> count{ 1 }; // registered subsystems, untagged included
+    unsigned long frames = 0;
+    unsigned long enforceFrom = 0;
+    bool enforcing = false;
+    unsigned long violations = 0;
+
+    AllocationTracker()
+    {
+        subsystems[UNTAGGED].name = "untagged";
+    }
+};
+typedef AllocationTracker::AllocationScope AllocationScope;
+
+// allocates a block for one of the allocators below: recorded under their own subsystem, not the caller's
+// ------------------------------------------------------------------------
+inline void* allocateTrackedBlock(int subsystem, size_t bytes)
+{
+    AllocationTracker::instance().record(subsystem, bytes);
+    AllocationScope quiet(AllocationTracker::IGNORED);
+    return ::operator new(bytes);
+}
+
+// A linear allocator for data that lives for one frame: allocate() bumps an offset into a block, reset() at the
+// frame boundary gives all of it back at once. Nothing is freed or destructed one by one, so only trivially
+// destructible types go in (create() checks).
+// - When a frame needs more than the block holds, the arena chains overflow blocks and keeps going; the next
+//   reset() replaces everything with a single block as large as that frame needed, so the arena stops
+//   allocating once it has seen the largest frame. The growth is counted under the arena's subsystem.
+// - Not thread-safe: use one arena per thread.
+class FrameArena
+{
+public:
+    size_t peak = 0; // most bytes used by one frame so far
+
+    FrameArena(size_t capacity = 64 * 1024, const char* name = "frame arena")
+        : subsystem(AllocationTracker::instance().subsystem(name)), blockSize(0), offset(0), overflowBytes(0)
+    {
+        grow(capacity);
+    }
+    ~FrameArena()
+    {
+        for (size_t i = 0; i < blocks.size(); i++)
+            ::operator delete(blocks[i]);
+    }
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // size bytes aligned to align (a power of two), valid until the next reset()
+    // ------------------------------------------------------------------------
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        size_t aligned = alignedOffset(align);
+        if (aligned + size > blockSize)
+        {
+            // the rest of this block is wasted; the frame is added up in used() either way
+            overflowBytes += offset;
+            grow(std::max(blockSize, size + align));
+            aligned = alignedOffset(align);
+        }
+        offset = aligned + size;
+        return blocks.back() + aligned;
+    }
+    // an uninitialised array of count T
+    // ------------------------------------------------------------------------
+    template <typename T>
+    T* allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+    // a T constructed from args
+    // ------------------------------------------------------------------------
+    template <typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never runs destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+    // gives back everything allocated since the last reset(); call it at the frame boundary
+    // ------------------------------------------------------------------------
+    void reset()
+    {
+        size_t frameBytes = used();
+        peak = std::max(peak, frameBytes);
+        if (blocks.size() > 1)
+        {
+            for (size_t i = 0; i < blocks.size(); i++)
+                ::operator delete(blocks[i]);
+            blocks.clear();
+            size_t capacity = blockSize;
+            while (capacity < peak)
+                capacity *= 2;
+            blockSize = 0;
+            grow(capacity);
+        }
+        offset = 0;
+        overflowBytes = 0;
+    }
+    // bytes handed out since the last reset(), alignment included
+    // ------------------------------------------------------------------------
+    size_t used() const
+    {
+        return overflowBytes + offset;
+    }
+    // bytes the current block holds
+    // ------------------------------------------------------------------------
+    size_t capacity() const
+    {
+        return blockSize;
+    }
+
+private:
+    int subsystem;
+    std::vector<unsigned char*> blocks; // the last one is being filled
+    size_t blockSize;
+    size_t offset;
+    size_t overflowBytes; // used in the blocks before the last one
+
+    // the first offset from offset on whose address (not just the offset: operator new only aligns the block to
+    // max_align_t) is a multiple of align
+    // ------------------------------------------------------------------------
+    size_t alignedOffset(size_t align) const
+    {
+        uintptr_t address = reinterpret_cast<uintptr_t>(blocks.back()) + offset;
+        return offset + (size_t)(((address + align - 1) & ~(uintptr_t)(align - 1)) - address);
+    }
+    // ------------------------------------------------------------------------
+    void grow(size_t size)
+    {
+        AllocationScope quiet(AllocationTracker::IGNORED); // the push_back is part of the growth
+        blocks.push_back(static_cast<unsigned char*>(allocateTrackedBlock(subsystem, size)));
+        blockSize = size;
+        offset = 0;
+    }
+};
+
+// Fixed-size slots for objects that come and go all the time (GL object wrappers, jobs): create() takes a slot
+// off a free list and destroy() puts it back, both O(1) and without touching the heap once the pool is large
+// enough. The pool grows by blocks of blockSize slots, counted under its subsystem; reserve() the expected
+// number up front to keep that out of the render loop. Slots never move, so pointers stay valid until destroy().
+// - Not thread-safe: guard a pool shared by threads with a mutex.
+template <typename T>
+class ObjectPool
+{
+public:
+    ObjectPool(size_t blockSize = 256, const char* name = "object pool")
+        : subsystem(AllocationTracker::instance().subsystem(name)), blockSize(std::max<size_t>(blockSize, 1)), freeList(NULL), liveCount(0)
+    {
+    }
+    ~ObjectPool()
+    {
+        if (liveCount > 0)
+            std::cout << "ERROR::OBJECT_POOL::LEAK: " << liveCount << " objects were not destroyed" << std::endl;
+        for (size_t i = 0; i < blocks.size(); i++)
+            ::operator delete(blocks[i]);
+    }
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // ------------------------------------------------------------------------
+    template <typename... Args>
+    T* create(Args&&... args)
+    {
+        if (!freeList)
+            grow();
+        Slot* slot = freeList;
+        freeList = slot->next;
+        liveCount++;
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+    // destructs object, which came from create() of this pool, and recycles its slot
+    // ------------------------------------------------------------------------
+    void destroy(T* object)
+    {
+        if (!object)
+            return;
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = freeList;
+        freeList = slot;
+        liveCount--;
+    }
+    // grows the pool to at least count slots
+    // ------------------------------------------------------------------------
+    void reserve(size_t count)
+    {
+        while (capacity() < count)
+            grow();
+    }
+    // objects created and not destroyed yet
+    // ------------------------------------------------------------------------
+    size_t live() const
+    {
+        return liveCount;
+    }
+    // ------------------------------------------------------------------------
+    size_t capacity() const
+    {
+        return blocks.size() * blockSize;
+    }
+
+private:
+    union Slot
+    {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    int subsystem;
+    size_t blockSize;
+    std::vector<Slot*> blocks;
+    Slot* freeList;
+    size_t liveCount;
+
+    // ------------------------------------------------------------------------
+    void grow()
+    {
+        AllocationScope quiet(AllocationTracker::IGNORED);
+        Slot* block = static_cast<Slot*>(allocateTrackedBlock(subsystem, blockSize * sizeof(Slot)));
+        blocks.push_back(block);
+        for (size_t i = blockSize; i-- > 0;)
+        {
+            block[i].next = freeList;
+            freeList = &block[i];
+        }
+    }
+};
+
+#ifdef FRAME_ALLOCATOR_REPLACE_NEW
+// the replaceable global allocation functions, counted under the subsystem of the calling thread; the nothrow
+// variants of the standard library end up in these, the over-aligned ones are not counted
+void* operator new(std::size_t size)
+{
+    AllocationTracker::instance().record(AllocationTracker::current(), size);
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+void operator delete[](void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+#endif
+#endif
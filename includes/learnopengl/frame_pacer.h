@@ -0,0 +1,217 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <learnopengl/frame_profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+// how FramePacer paces the frames of a render loop
+enum PacingMode
+{
+    PACING_VSYNC,          // swap interval 1: one frame per refresh, the driver may queue a few of them
+    PACING_ADAPTIVE_VSYNC, // swap interval -1 (EXT_swap_control_tear): like vsync, but a late frame tears instead of waiting a whole refresh
+    PACING_UNLOCKED,       // swap interval 0, paced by the limiter (targetFps) if there is one
+    PACING_LOW_LATENCY,    // vsync, and waits for the GPU before input is sampled, so at most maxQueuedFrames frames are in flight
+    PACING_MODE_COUNT
+};
+const char* const pacingModeNames[] = { "vsync", "adaptive vsync", "unlocked", "low latency" };
+
+// Paces a render loop and measures its input latency.
+// - The swap interval follows the mode; a driver without EXT_swap_control_tear gets plain vsync instead of
+//   adaptive vsync.
+// - With targetFps set, the limiter holds every frame to 1 / targetFps: it sleeps until a little before the
+//   deadline and spins the rest of the way, because a sleep alone wakes up a millisecond or two late. The deadlines
+//   are scheduled from each other, so the rate does not drift; a frame that is late by a whole interval starts
+//   the schedule over.
+// - Every swap is followed by a GL_TIMESTAMP query and a fence. The time from wait() (right before the events are
+//   polled) to the GPU reaching them is the input latency of the frame, recorded in the profiler as "input
+//   latency"; it leaves out the scanout after the GPU finished, which the driver does not report. The GPU time is
+//   moved onto the CPU clock with a GL_TIMESTAMP read at the swap, so the latency does not grow with how late the
+//   fence is polled; the fence only says when the query can be read without stalling. In the low latency mode
+//   wait() blocks on the fence of the frame maxQueuedFrames + 1 back, so the driver can not buffer frames (and
+//   their stale input) on top of the ones the GPU works on; 0 has the GPU idle whenever input is read.
+// Usage in a render loop:
+//     ...draw...
+//     pacer.swap(window);
+//     pacer.wait();
+//     glfwPollEvents();
+class FramePacer
+{
+public:
+    double targetFps;    // frame rate limit of the limiter, 0 for none
+    int maxQueuedFrames; // low latency mode: frames the GPU may still be working on when input is read
+    float latencyMs;     // input latency of the last frame the GPU finished
+
+    FramePacer(PacingMode mode = PACING_VSYNC, double targetFps = 0.0, FrameProfiler* profiler = NULL)
+        : targetFps(targetFps), maxQueuedFrames(1), latencyMs(0.0f), profiler(profiler), pacingMode(mode), first(0), queued(0)
+    {
+        setMode(mode);
+        for (int i = 0; i < MAX_QUEUED; i++)
+        {
+            frames[i].fence = 0;
+            glGenQueries(1, &frames[i].query);
+        }
+        nextDeadline = Clock::now();
+        inputTime = Clock::now();
+    }
+
+    // sets the swap interval of the current context for mode
+    // ------------------------------------------------------------------------
+    void setMode(PacingMode mode)
+    {
+        pacingMode = mode;
+        if (mode == PACING_ADAPTIVE_VSYNC && !glfwExtensionSupported("WGL_EXT_swap_control_tear") && !glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+        {
+            std::cout << "adaptive vsync needs EXT_swap_control_tear, using vsync" << std::endl;
+            pacingMode = PACING_VSYNC;
+        }
+        glfwSwapInterval(pacingMode == PACING_ADAPTIVE_VSYNC ? -1 : pacingMode == PACING_UNLOCKED ? 0 : 1);
+    }
+    // ------------------------------------------------------------------------
+    PacingMode mode() const
+    {
+        return pacingMode;
+    }
+    // presents the frame and puts a fence behind it
+    // ------------------------------------------------------------------------
+    void swap(GLFWwindow* window)
+    {
+        glfwSwapBuffers(window);
+        if (queued == MAX_QUEUED)
+        {
+            // the GPU is further behind than the ring holds: drop the oldest measurement rather than wait for it
+            glDeleteSync(frames[first].fence);
+            first = (first + 1) % MAX_QUEUED;
+            queued--;
+        }
+        InFlight& frame = frames[(first + queued) % MAX_QUEUED];
+        glQueryCounter(frame.query, GL_TIMESTAMP);
+        frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        frame.input = inputTime;
+        // the GPU clock against the CPU clock, to put the timestamp on the CPU clock once it is known
+        glGetInteger64v(GL_TIMESTAMP, &frame.gpuSubmit);
+        frame.cpuSubmit = Clock::now();
+        queued++;
+        collect(false);
+    }
+    // waits for the limiter and (in the low latency mode) the GPU; call right before the input is sampled
+    // ------------------------------------------------------------------------
+    void wait()
+    {
+        Clock::time_point start = Clock::now();
+        if (pacingMode == PACING_LOW_LATENCY)
+            while (queued > maxQueuedFrames)
+                collect(true);
+        if (targetFps > 0.0)
+            limit();
+        collect(false);
+        inputSampled();
+        if (profiler)
+            profiler->addSample("pacing wait", elapsedMs(start, inputTime));
+    }
+    // restarts the input latency of the next frame; wait() calls it, call it again after blocking for events
+    // (e.g. RedrawScheduler::waitEvents) so the time spent idle does not count as latency
+    // ------------------------------------------------------------------------
+    void inputSampled()
+    {
+        inputTime = Clock::now();
+    }
+    // deletes the fences and queries; call before the context is destroyed
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (; queued > 0; queued--, first = (first + 1) % MAX_QUEUED)
+            glDeleteSync(frames[first].fence);
+        for (int i = 0; i < MAX_QUEUED; i++)
+        {
+            glDeleteQueries(1, &frames[i].query);
+            frames[i].query = 0;
+        }
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static const int MAX_QUEUED = 8;
+    static constexpr double SPIN_MS = 2.0; // the part of a limiter wait that is spun instead of slept
+    static constexpr GLuint64 FENCE_TIMEOUT_NS = 100000000; // a blocking wait is retried in slices of this length
+
+    struct InFlight
+    {
+        GLsync fence;
+        GLuint query;                // GL_TIMESTAMP of the GPU reaching the end of the frame
+        Clock::time_point input;
+        GLint64 gpuSubmit;           // GL_TIMESTAMP and CPU time read together at the swap
+        Clock::time_point cpuSubmit;
+    };
+
+    FrameProfiler* profiler;
+    PacingMode pacingMode;
+    InFlight frames[MAX_QUEUED]; // oldest first, starting at first
+    int first, queued;
+    Clock::time_point nextDeadline;
+    Clock::time_point inputTime; // of the frame being built
+
+    // records the latency of the frames the GPU finished, oldest first; block waits for the oldest one
+    // ------------------------------------------------------------------------
+    void collect(bool block)
+    {
+        while (queued > 0)
+        {
+            GLenum status = glClientWaitSync(frames[first].fence, block ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, block ? FENCE_TIMEOUT_NS : 0);
+            // a slow frame is still a valid measurement, so a blocking wait keeps going until the fence signals
+            while (block && status == GL_TIMEOUT_EXPIRED)
+                status = glClientWaitSync(frames[first].fence, 0, FENCE_TIMEOUT_NS);
+            if (status == GL_TIMEOUT_EXPIRED)
+                return;
+            if (status == GL_WAIT_FAILED)
+            {
+                // the frame is given up on rather than waited for again, a broken fence would stall the ring for good
+                std::cout << "ERROR::FRAME_PACER::FENCE_WAIT: failed" << std::endl;
+            }
+            else
+            {
+                // the fence came after the query, so its result is there
+                const InFlight& frame = frames[first];
+                GLuint64 stamp = 0;
+                glGetQueryObjectui64v(frame.query, GL_QUERY_RESULT, &stamp);
+                Clock::time_point signalled = frame.cpuSubmit + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::nanoseconds((GLint64)stamp - frame.gpuSubmit));
+                // the two clocks are read one after the other, keep their small offset from leaving the frame
+                signalled = std::max(frame.input, std::min(signalled, Clock::now()));
+                latencyMs = elapsedMs(frame.input, signalled);
+                if (profiler)
+                    profiler->addSample("input latency", latencyMs);
+            }
+            glDeleteSync(frames[first].fence);
+            first = (first + 1) % MAX_QUEUED;
+            queued--;
+            block = false;
+        }
+    }
+    // ------------------------------------------------------------------------
+    void limit()
+    {
+        Clock::duration interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+        Clock::time_point now = Clock::now();
+        if (now - nextDeadline > interval)
+            nextDeadline = now; // too late to catch up
+        Clock::time_point wake = nextDeadline - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(SPIN_MS));
+        if (now < wake)
+            std::this_thread::sleep_until(wake);
+        while (Clock::now() < nextDeadline)
+            std::this_thread::yield();
+        nextDeadline += interval;
+    }
+    // ------------------------------------------------------------------------
+    static float elapsedMs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<float, std::milli>(end - start).count();
+    }
+};
+#endif
@@ -0,0 +1,172 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+// Hands the latest snapshot of a frame from one thread to another without locks.
+// - The writer fills write() and calls publish(); the reader calls acquire() and then reads read(). Of three
+//   slots one belongs to each side and the third holds the snapshot in transit, so neither side ever waits for
+//   the other: a writer that is faster overwrites the snapshot the reader had not picked up yet, a reader that
+//   is faster keeps the one it has.
+// - A slot is reused, not cleared, so write() starts with whatever the writer put into that slot two
+//   publishes earlier; fill in every field.
+// - Keep T small and plain (no pointers into data the writer changes later), the reader has it for a whole frame.
+template <typename T>
+class TripleBuffer
+{
+public:
+    unsigned long published = 0; // snapshots published by the writer
+    unsigned long consumed = 0;  // snapshots the reader picked up; published - consumed were never read
+
+    TripleBuffer() : middle(1), back(0), front(2)
+    {
+    }
+
+    // the writer's slot, to be filled before publish()
+    // ------------------------------------------------------------------------
+    T& write()
+    {
+        return slots[back];
+    }
+    // makes the writer's slot the latest snapshot and gives the writer the slot in transit
+    // ------------------------------------------------------------------------
+    void publish()
+    {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+        published++;
+    }
+    // takes the latest snapshot if one was published since the last call; returns whether read() changed
+    // ------------------------------------------------------------------------
+    bool acquire()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        consumed++;
+        return true;
+    }
+    // the reader's slot; stays the same until the next acquire() that returns true
+    // ------------------------------------------------------------------------
+    const T& read() const
+    {
+        return slots[front];
+    }
+
+private:
+    static constexpr unsigned int INDEX = 3;
+    static constexpr unsigned int FRESH = 4; // set by publish(), cleared by acquire()
+
+    T slots[3];
+    std::atomic<unsigned int> middle; // index of the slot in transit, plus FRESH
+    unsigned int back;                // only touched by the writer
+    unsigned int front;               // only touched by the reader
+};
+
+// Paces a loop at a fixed rate: wait() sleeps until the next tick is due.
+// - Ticks are scheduled from the start time, not from the end of the last wait, so the rate does not drift with
+//   the work done in between.
+// - When the loop falls behind by more than a tick, the missed ticks are dropped (and counted in skipped)
+//   rather than run back to back to catch up.
+class FixedTicker
+{
+public:
+    unsigned long ticks = 0;   // ticks waited for so far
+    unsigned long skipped = 0; // ticks dropped because the loop was late
+
+    FixedTicker(double ticksPerSecond)
+        : interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / ticksPerSecond))),
+          next(std::chrono::steady_clock::now() + interval)
+    {
+    }
+
+    // ------------------------------------------------------------------------
+    void wait()
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now < next)
+            std::this_thread::sleep_until(next);
+        else if (now - next > interval)
+        {
+            unsigned long late = (unsigned long)((now - next) / interval);
+            skipped += late;
+            next += interval * late;
+        }
+        next += interval;
+        ticks++;
+    }
+    // length of a tick in seconds, the time step of a simulation driven by the ticker
+    // ------------------------------------------------------------------------
+    double step() const
+    {
+        return std::chrono::duration<double>(interval).count();
+    }
+
+private:
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point next;
+};
+
+// Runs the GL side of a sample on a thread of its own: makes the window's context current there and calls frame()
+// (which draws and swaps) until stop(). The thread that created the window keeps polling events and updating,
+// so a blocking glfwSwapBuffers no longer holds up input, and a slow update no longer delays presentation.
+// - GLFW only lets the main thread poll events and query windows and input, so that side stays on the main
+//   thread and passes its results to frame() through a TripleBuffer; frame() calls GL, glfwSwapBuffers,
+//   glfwGetTime and nothing else of GLFW.
+// - The context must not be current on the calling thread when the RenderThread starts (glfwMakeContextCurrent(NULL)),
+//   and is current on no thread once stop() returns; make it current again to delete the GL objects.
+class RenderThread
+{
+public:
+    RenderThread(GLFWwindow* window, std::function<void()> frame) : window(window), frame(frame), running(true), frameCount(0)
+    {
+        thread = std::thread(&RenderThread::renderLoop, this);
+    }
+    ~RenderThread()
+    {
+        stop();
+    }
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // lets the current frame finish and joins the thread
+    // ------------------------------------------------------------------------
+    void stop()
+    {
+        running = false;
+        if (thread.joinable())
+            thread.join();
+    }
+    // frames drawn so far
+    // ------------------------------------------------------------------------
+    unsigned long frames() const
+    {
+        return frameCount.load(std::memory_order_relaxed);
+    }
+
+private:
+    GLFWwindow* window;
+    std::function<void()> frame;
+    std::atomic<bool> running;
+    std::atomic<unsigned long> frameCount;
+    std::thread thread;
+
+    // ------------------------------------------------------------------------
+    void renderLoop()
+    {
+        glfwMakeContextCurrent(window);
+        while (running)
+        {
+            frame();
+            frameCount.fetch_add(1, std::memory_order_relaxed);
+        }
+        glFinish();
+        glfwMakeContextCurrent(NULL);
+    }
+};
+#endif
@@ -0,0 +1,411 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// rolling statistics of one scope, in milliseconds
+struct ScopeStats
+{
+    float avg = 0.0f;
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+    int samples = 0;
+    int missed = 0; // GPU only: frames not measured because every query of the scope was still in flight
+};
+
+// Measures CPU and GPU time per frame for named scopes and keeps rolling p50/p95/p99 statistics.
+// - CPU scopes use std::chrono::steady_clock.
+// - GPU scopes use GL_TIME_ELAPSED queries. Every scope owns a ring of QUERY_SLOTS query objects; a query
+//   stays in the ring until its result is available and is read back at the start of a later frame, so the
+//   CPU never waits for the GPU and a GPU running a few frames behind is still measured. A frame that finds
+//   every query of a scope in flight isn't measured and is counted in ScopeStats::missed instead.
+//   GL_TIME_ELAPSED queries can't be nested, so GPU scopes can't either.
+// Usage in a render loop:
+//     profiler.beginFrame();
+//     { FrameProfiler::CpuScope cpu(profiler, "draw"); FrameProfiler::GpuScope gpu(profiler, "draw"); ... }
+//     glfwSwapBuffers(window);
+//     profiler.endFrame();
+class FrameProfiler
+{
+public:
+    // number of frames the rolling statistics are computed over
+    static const int WINDOW = 240;
+    // GPU queries in flight per scope, i.e. how many frames the GPU may run behind before frames go unmeasured
+    static const int QUERY_SLOTS = 4;
+
+    // RAII helpers so a scope can't be left open by an early return
+    // ------------------------------------------------------------------------
+    class CpuScope
+    {
+    public:
+        CpuScope(FrameProfiler& profiler, const char* name) : profiler(profiler), name(name) { profiler.beginCpu(name); }
+        ~CpuScope() { profiler.endCpu(name); }
+    private:
+        FrameProfiler& profiler;
+        const char* name;
+    };
+    // ------------------------------------------------------------------------
+    class GpuScope
+    {
+    public:
+        GpuScope(FrameProfiler& profiler, const char* name) : profiler(profiler), started(profiler.beginGpu(name)) {}
+        ~GpuScope() { if (started) profiler.endGpu(); }
+    private:
+        FrameProfiler& profiler;
+        bool started; // false when refused (nested, or no free query), so its end leaves the outer query running
+    };
+
+    FrameProfiler() : frameIndex(0), activeGpuScope(-1), overlayVAO(0), overlayVBO(0), overlayProgram(0) {}
+    ~FrameProfiler()
+    {
+        // the GL objects are only released by release(), the context may already be gone here
+        if (csv.is_open())
+            csv.close();
+    }
+
+    // writes one "frame,scope,type,ms" row per measurement to the given file
+    // ------------------------------------------------------------------------
+    bool openCsv(const char* path)
+    {
+        csv.open(path);
+        if (!csv)
+        {
+            std::cout << "ERROR::PROFILER::CSV_NOT_OPENED: " << path << std::endl;
+            return false;
+        }
+        csv << "frame,scope,type,ms\n";
+        return true;
+    }
+    // call at the start of every render loop iteration
+    // ------------------------------------------------------------------------
+    void beginFrame()
+    {
+        collectGpuResults();
+        frameStart = Clock::now();
+    }
+    // call after glfwSwapBuffers; records the total CPU time of the frame under "frame"
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        record(findScope("frame"), false, elapsedMs(frameStart, Clock::now()));
+        frameIndex++;
+    }
+    // ------------------------------------------------------------------------
+    void beginCpu(const char* name)
+    {
+        scopes[findScope(name)].cpuStart = Clock::now();
+    }
+    // ------------------------------------------------------------------------
+    void endCpu(const char* name)
+    {
+        int scope = findScope(name);
+        record(scope, false, elapsedMs(scopes[scope].cpuStart, Clock::now()));
+    }
+    // returns false (and measures nothing) when another GPU scope is still open, since GL_TIME_ELAPSED queries can't nest,
+    // or when every query of the scope is still in flight (counted as missed); the caller must then skip the matching endGpu()
+    // ------------------------------------------------------------------------
+    bool beginGpu(const char* name)
+    {
+        if (activeGpuScope >= 0)
+        {
+            std::cout << "ERROR::PROFILER::NESTED_GPU_SCOPE: " << name << std::endl;
+            return false;
+        }
+        int index = findScope(name);
+        Scope& scope = scopes[index];
+        if (scope.inFlight == QUERY_SLOTS)
+        {
+            scope.missed++;
+            return false;
+        }
+        if (scope.queries[0] == 0)
+            glGenQueries(QUERY_SLOTS, scope.queries);
+        int slot = (scope.oldest + scope.inFlight) % QUERY_SLOTS;
+        glBeginQuery(GL_TIME_ELAPSED, scope.queries[slot]);
+        scope.issuedFrame[slot] = frameIndex;
+        scope.inFlight++;
+        activeGpuScope = index;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void endGpu()
+    {
+        if (activeGpuScope < 0)
+            return;
+        glEndQuery(GL_TIME_ELAPSED);
+        activeGpuScope = -1;
+    }
+    // records a CPU measurement made elsewhere (e.g. the input latency of a FramePacer) as a sample of the scope name
+    // ------------------------------------------------------------------------
+    void addSample(const char* name, float ms)
+    {
+        record(findScope(name), false, ms);
+    }
+    // statistics over the last WINDOW frames; gpu selects the GPU or the CPU timings of the scope
+    // ------------------------------------------------------------------------
+    ScopeStats stats(const char* name, bool gpu = false)
+    {
+        ScopeStats result;
+        for (size_t i = 0; i < scopes.size(); i++)
+        {
+            if (std::strcmp(scopes[i].name, name) != 0)
+                continue;
+            const History& history = gpu ? scopes[i].gpu : scopes[i].cpu;
+            result.samples = history.count;
+            result.missed = gpu ? scopes[i].missed : 0;
+            if (history.count == 0)
+                return result;
+            sorted.assign(history.values, history.values + history.count);
+            std::sort(sorted.begin(), sorted.end());
+            float sum = 0.0f;
+            for (size_t j = 0; j < sorted.size(); j++)
+                sum += sorted[j];
+            result.avg = sum / sorted.size();
+            result.p50 = percentile(0.50f);
+            result.p95 = percentile(0.95f);
+            result.p99 = percentile(0.99f);
+            return result;
+        }
+        return result;
+    }
+    // starts the statistics of a scope over, e.g. when the workload changed; GPU results still in flight for
+    // the frames before are read back but not recorded
+    // ------------------------------------------------------------------------
+    void resetStats(const char* name)
+    {
+        Scope& scope = scopes[findScope(name)];
+        scope.cpu = History();
+        scope.gpu = History();
+        scope.missed = 0;
+        scope.resetFrame = frameIndex;
+    }
+    // the most recent measurement of a scope, 0 before the first one; GPU times are at least a frame old
+    // ------------------------------------------------------------------------
+    float latest(const char* name, bool gpu = false)
+    {
+        for (size_t i = 0; i < scopes.size(); i++)
+        {
+            if (std::strcmp(scopes[i].name, name) != 0)
+                continue;
+            const History& history = gpu ? scopes[i].gpu : scopes[i].cpu;
+            return history.count > 0 ? history.values[(history.next + WINDOW - 1) % WINDOW] : 0.0f;
+        }
+        return 0.0f;
+    }
+    // prints the statistics of every scope
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout)
+    {
+        for (size_t i = 0; i < scopes.size(); i++)
+        {
+            for (int gpu = 0; gpu < 2; gpu++)
+            {
+                ScopeStats s = stats(scopes[i].name, gpu == 1);
+                if (s.samples == 0 && s.missed == 0)
+                    continue;
+                out << scopes[i].name << (gpu ? " (gpu)" : " (cpu)") << ": avg " << s.avg << " ms, p50 " << s.p50
+                    << " ms, p95 " << s.p95 << " ms, p99 " << s.p99 << " ms";
+                if (s.missed > 0)
+                    out << ", " << s.missed << " frames missed";
+                out << std::endl;
+            }
+        }
+    }
+    // draws the CPU time of the last WINDOW frames as a bar graph in the bottom left corner of the
+    // current framebuffer; the line marks 16.6 ms (60 fps)
+    // ------------------------------------------------------------------------
+    void drawOverlay()
+    {
+        if (overlayProgram == 0)
+            createOverlay();
+        const History& history = scopes[findScope("frame")].cpu;
+        // 2 vertices per bar plus the 60 fps line, in a 0..1 space the vertex shader maps to the corner
+        float vertices[(WINDOW + 1) * 4];
+        for (int i = 0; i < WINDOW; i++)
+        {
+            float ms = i < history.count ? history.values[(history.next + WINDOW - history.count + i) % WINDOW] : 0.0f;
+            float x = (i + 0.5f) / WINDOW;
+            vertices[i * 4 + 0] = x;
+            vertices[i * 4 + 1] = 0.0f;
+            vertices[i * 4 + 2] = x;
+            vertices[i * 4 + 3] = std::min(ms / 33.3f, 1.0f);
+        }
+        float* line = vertices + WINDOW * 4;
+        line[0] = 0.0f; line[1] = 0.5f; line[2] = 1.0f; line[3] = 0.5f;
+
+        glUseProgram(overlayProgram);
+        glBindVertexArray(overlayVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
+        glDrawArrays(GL_LINES, 0, (WINDOW + 1) * 2);
+        glBindVertexArray(0);
+    }
+    // deletes the query objects and overlay resources; call before the context is destroyed
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (size_t i = 0; i < scopes.size(); i++)
+        {
+            if (scopes[i].queries[0] != 0)
+                glDeleteQueries(QUERY_SLOTS, scopes[i].queries);
+            for (int slot = 0; slot < QUERY_SLOTS; slot++)
+                scopes[i].queries[slot] = 0;
+            scopes[i].oldest = scopes[i].inFlight = 0;
+        }
+        if (overlayProgram != 0)
+        {
+            glDeleteVertexArrays(1, &overlayVAO);
+            glDeleteBuffers(1, &overlayVBO);
+            glDeleteProgram(overlayProgram);
+            overlayProgram = 0;
+        }
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // fixed size ring of the last WINDOW measurements
+    struct History
+    {
+        float values[WINDOW];
+        int next = 0;
+        int count = 0;
+        void push(float ms)
+        {
+            values[next] = ms;
+            next = (next + 1) % WINDOW;
+            count = std::min(count + 1, (int)WINDOW);
+        }
+    };
+    struct Scope
+    {
+        const char* name;
+        Clock::time_point cpuStart;
+        unsigned int queries[QUERY_SLOTS] = {};
+        unsigned long long issuedFrame[QUERY_SLOTS] = {};
+        int oldest = 0;   // slot of the oldest query in flight
+        int inFlight = 0; // queries issued and not read back yet
+        int missed = 0;
+        unsigned long long resetFrame = 0; // GPU results of frames before it are not recorded
+        History cpu;
+        History gpu;
+    };
+
+    std::vector<Scope> scopes;
+    std::vector<float> sorted;
+    std::ofstream csv;
+    Clock::time_point frameStart;
+    unsigned long long frameIndex;
+    int activeGpuScope;
+    unsigned int overlayVAO, overlayVBO, overlayProgram;
+
+    // scopes are few, so a linear search by name is cheaper than hashing
+    // ------------------------------------------------------------------------
+    int findScope(const char* name)
+    {
+        for (size_t i = 0; i < scopes.size(); i++)
+            if (scopes[i].name == name || std::strcmp(scopes[i].name, name) == 0)
+                return (int)i;
+        scopes.push_back(Scope());
+        scopes.back().name = name;
+        return (int)scopes.size() - 1;
+    }
+    // ------------------------------------------------------------------------
+    void record(int scope, bool gpu, float ms, unsigned long long frame)
+    {
+        (gpu ? scopes[scope].gpu : scopes[scope].cpu).push(ms);
+        if (csv.is_open())
+            csv << frame << ',' << scopes[scope].name << ',' << (gpu ? "gpu" : "cpu") << ',' << ms << '\n';
+    }
+    void record(int scope, bool gpu, float ms)
+    {
+        record(scope, gpu, ms, frameIndex);
+    }
+    // reads back every query the GPU is done with, oldest first; the rest stay in flight for a later frame
+    // ------------------------------------------------------------------------
+    void collectGpuResults()
+    {
+        for (size_t i = 0; i < scopes.size(); i++)
+        {
+            Scope& scope = scopes[i];
+            while (scope.inFlight > 0)
+            {
+                int slot = scope.oldest;
+                int available = 0;
+                glGetQueryObjectiv(scope.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+                // queries complete in order, so nothing newer is available either
+                if (!available)
+                    break;
+                if (scope.issuedFrame[slot] >= scope.resetFrame)
+                {
+                    GLuint64 ns = 0;
+                    glGetQueryObjectui64v(scope.queries[slot], GL_QUERY_RESULT, &ns);
+                    record((int)i, true, ns / 1.0e6f, scope.issuedFrame[slot]);
+                }
+                scope.oldest = (scope.oldest + 1) % QUERY_SLOTS;
+                scope.inFlight--;
+            }
+        }
+    }
+    // ------------------------------------------------------------------------
+    float percentile(float p) const
+    {
+        size_t rank = (size_t)(p * (sorted.size() - 1) + 0.5f);
+        return sorted[rank];
+    }
+    // ------------------------------------------------------------------------
+    static float elapsedMs(Clock::time_point start, Clock::time_point end)
+    {
+        return std::chrono::duration<float, std::milli>(end - start).count();
+    }
+    // ------------------------------------------------------------------------
+    void createOverlay()
+    {
+        const char* vertexCode = "#version 330 core\n"
+            "layout (location = 0) in vec2 aPos;\n"
+            "void main()\n"
+            "{\n"
+            "   gl_Position = vec4(aPos * vec2(0.5, 0.25) - vec2(0.98, 0.98), 0.0, 1.0);\n"
+            "}\0";
+        const char* fragmentCode = "#version 330 core\n"
+            "out vec4 FragColor;\n"
+            "void main()\n"
+            "{\n"
+            "   FragColor = vec4(1.0, 0.85, 0.1, 1.0);\n"
+            "}\n\0";
+        unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(vertex, 1, &vertexCode, NULL);
+        glCompileShader(vertex);
+        unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(fragment, 1, &fragmentCode, NULL);
+        glCompileShader(fragment);
+        overlayProgram = glCreateProgram();
+        glAttachShader(overlayProgram, vertex);
+        glAttachShader(overlayProgram, fragment);
+        glLinkProgram(overlayProgram);
+        int success;
+        glGetProgramiv(overlayProgram, GL_LINK_STATUS, &success);
+        if (!success)
+            std::cout << "ERROR::PROFILER::OVERLAY_PROGRAM_LINKING_FAILED" << std::endl;
+        glDeleteShader(vertex);
+        glDeleteShader(fragment);
+
+        glGenVertexArrays(1, &overlayVAO);
+        glGenBuffers(1, &overlayVBO);
+        glBindVertexArray(overlayVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
+        glBufferData(GL_ARRAY_BUFFER, (WINDOW + 1) * 4 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+};
+#endif
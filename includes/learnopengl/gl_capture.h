@@ -0,0 +1,783 @@
+#ifndef GL_CAPTURE_H
+#define GL_CAPTURE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GL capture files, written by GLCapture and played back by tools/gl_replay.
+// Layout: a GLCaptureHeader, then one record per call:
+//     unsigned short command; unsigned int ns (CPU time of the call); unsigned int size; size bytes of arguments
+// The arguments are stored in the order of the call, each with its own size; pointers into a bound buffer
+// (attribute, index and indirect offsets) as 8 bytes; client memory as a blob: unsigned int length, then the
+// bytes (0xffffffff for NULL). GL_CAPTURE_FRAME_END records mark the swaps, with the frame time in 8 bytes.
+const char GL_CAPTURE_MAGIC[8] = { 'G', 'L', 'C', 'A', 'P', 'T', 'R', '1' };
+const unsigned int GL_CAPTURE_NULL_BLOB = 0xffffffffu;
+
+struct GLCaptureHeader
+{
+    char magic[8];
+    int majorVersion, minorVersion; // of the captured context
+    int width, height;              // its default framebuffer
+};
+
+// Commands whose arguments are plain values. The letters say what replay has to translate, one per argument:
+// v a value as it is; b buffer, t texture, a vertex array, f framebuffer, r renderbuffer, q query, p program and
+// s shader names; u a uniform location of the program in use; k a uniform block index of the program before it
+#define GL_CAPTURE_SCALAR_COMMANDS(X) \
+    X(Viewport, "vvvv") \
+    X(ClearColor, "vvvv") \
+    X(Clear, "v") \
+    X(Enable, "v") \
+    X(Disable, "v") \
+    X(BlendFunc, "vv") \
+    X(DepthFunc, "v") \
+    X(DepthMask, "v") \
+    X(PolygonMode, "vv") \
+    X(Hint, "vv") \
+    X(PixelStorei, "vv") \
+    X(BindBuffer, "vb") \
+    X(BindBufferBase, "vvb") \
+    X(BindBufferRange, "vvbvv") \
+    X(BindVertexArray, "a") \
+    X(EnableVertexAttribArray, "v") \
+    X(VertexAttribPointer, "vvvvvv") \
+    X(VertexAttribIPointer, "vvvvv") \
+    X(VertexAttribDivisor, "vv") \
+    X(VertexAttribFormat, "vvvvv") \
+    X(VertexAttribBinding, "vv") \
+    X(BindVertexBuffer, "vbvv") \
+    X(ActiveTexture, "v") \
+    X(BindTexture, "vt") \
+    X(TexParameteri, "vvv") \
+    X(GenerateMipmap, "v") \
+    X(BindFramebuffer, "vf") \
+    X(BindRenderbuffer, "vr") \
+    X(RenderbufferStorage, "vvvv") \
+    X(FramebufferRenderbuffer, "vvvr") \
+    X(FramebufferTexture2D, "vvvtv") \
+    X(BlitFramebuffer, "vvvvvvvvvv") \
+    X(AttachShader, "ps") \
+    X(CompileShader, "s") \
+    X(LinkProgram, "p") \
+    X(UseProgram, "p") \
+    X(DeleteShader, "s") \
+    X(DeleteProgram, "p") \
+    X(ProgramParameteri, "pvv") \
+    X(UniformBlockBinding, "pkv") \
+    X(Uniform1i, "uv") \
+    X(Uniform1ui, "uv") \
+    X(Uniform1f, "uv") \
+    X(Uniform2f, "uvv") \
+    X(Uniform4f, "uvvvv") \
+    X(DrawArrays, "vvv") \
+    X(DrawElements, "vvvv") \
+    X(DrawElementsBaseVertex, "vvvvv") \
+    X(DrawElementsInstanced, "vvvvv") \
+    X(MultiDrawElementsIndirect, "vvvvv") \
+    X(MultiDrawElementsIndirectCount, "vvvvvv") \
+    X(MultiDrawElementsIndirectCountARB, "vvvvvv") \
+    X(DispatchCompute, "vvv") \
+    X(MemoryBarrier, "v") \
+    X(BeginQuery, "vq") \
+    X(EndQuery, "v") \
+    X(Flush, "") \
+    X(Finish, "")
+
+// glGen* and glDelete*: a count and that many names, of the kind given by the letter (the generated ones, for glGen*)
+#define GL_CAPTURE_GEN_COMMANDS(X) \
+    X(GenBuffers, 'b') \
+    X(GenVertexArrays, 'a') \
+    X(GenTextures, 't') \
+    X(GenFramebuffers, 'f') \
+    X(GenRenderbuffers, 'r') \
+    X(GenQueries, 'q')
+#define GL_CAPTURE_DELETE_COMMANDS(X) \
+    X(DeleteBuffers, 'b') \
+    X(DeleteVertexArrays, 'a') \
+    X(DeleteTextures, 't') \
+    X(DeleteFramebuffers, 'f') \
+    X(DeleteRenderbuffers, 'r') \
+    X(DeleteQueries, 'q')
+
+// commands with results or client memory, recorded by a GLCapture member of the same name:
+// CreateShader     type, the name it returned
+// CreateProgram    the name it returned
+// ShaderSource     shader, count, count blobs (the strings, without terminators)
+// GetUniformLocation, GetUniformBlockIndex   program, blob (the name), the result
+// BufferData, BufferStorage   target, 8 byte size, blob (NULL or size bytes), usage / flags
+// BufferSubData    target, 8 byte offset, blob
+// UnmapBuffer      target, 8 byte offset, access, blob: what was written through the mapping that ends here
+// TexImage2D, TexImage3D, CompressedTexImage2D   the arguments up to the pixels (imageSize included), then
+//                  a source: 0 NULL, 1 blob, 2 an 8 byte offset into the bound GL_PIXEL_UNPACK_BUFFER
+// Uniform4fv       location (u), count, blob
+// FenceSync        condition, flags, the sync it returned (8 bytes, as an ID)
+// ClientWaitSync   sync, flags, 8 byte timeout
+// DeleteSync       sync
+// ProgramBinary    program, format, blob
+#define GL_CAPTURE_CUSTOM_COMMANDS(X) \
+    X(CreateShader) \
+    X(CreateProgram) \
+    X(ShaderSource) \
+    X(GetUniformLocation) \
+    X(GetUniformBlockIndex) \
+    X(BufferData) \
+    X(BufferStorage) \
+    X(BufferSubData) \
+    X(UnmapBuffer) \
+    X(TexImage2D) \
+    X(TexImage3D) \
+    X(CompressedTexImage2D) \
+    X(Uniform4fv) \
+    X(FenceSync) \
+    X(ClientWaitSync) \
+    X(DeleteSync) \
+    X(ProgramBinary)
+
+#define GL_CAPTURE_ENUMERATE(name, ...) GL_CAPTURE_##name,
+#define GL_CAPTURE_TO_STRING(name, ...) #name,
+enum GLCaptureCommand
+{
+    GL_CAPTURE_FRAME_END,
+    GL_CAPTURE_SCALAR_COMMANDS(GL_CAPTURE_ENUMERATE)
+    GL_CAPTURE_GEN_COMMANDS(GL_CAPTURE_ENUMERATE)
+    GL_CAPTURE_DELETE_COMMANDS(GL_CAPTURE_ENUMERATE)
+    GL_CAPTURE_CUSTOM_COMMANDS(GL_CAPTURE_ENUMERATE)
+    GL_CAPTURE_COMMAND_COUNT
+};
+const char* const glCaptureCommandNames[] = {
+    "FrameEnd",
+    GL_CAPTURE_SCALAR_COMMANDS(GL_CAPTURE_TO_STRING)
+    GL_CAPTURE_GEN_COMMANDS(GL_CAPTURE_TO_STRING)
+    GL_CAPTURE_DELETE_COMMANDS(GL_CAPTURE_TO_STRING)
+    GL_CAPTURE_CUSTOM_COMMANDS(GL_CAPTURE_TO_STRING)
+};
+
+// bytes of client memory glTexImage* reads for an image of that size, format and type, rows aligned to alignment
+// ------------------------------------------------------------------------
+inline size_t glCaptureImageBytes(GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, int alignment)
+{
+    size_t components = 4;
+    switch (format)
+    {
+    case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: case GL_DEPTH_STENCIL:
+        components = 1;
+        break;
+    case GL_RG: case GL_RG_INTEGER:
+        components = 2;
+        break;
+    case GL_RGB: case GL_BGR: case GL_RGB_INTEGER:
+        components = 3;
+        break;
+    }
+    size_t texel;
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE: case GL_BYTE:
+        texel = components;
+        break;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+        texel = 2 * components;
+        break;
+    case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+        texel = 2;
+        break;
+    case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        texel = 8;
+        break;
+    case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+        texel = 4 * components;
+        break;
+    default: // the packed 32 bit types
+        texel = 4;
+        break;
+    }
+    size_t row = (size_t)width * texel;
+    row = (row + alignment - 1) / alignment * alignment;
+    return row * std::max(height, 1) * std::max(depth, 1);
+}
+
+template <int COMMAND, typename F> struct GLCaptureScalar;
+template <int COMMAND, typename F> struct GLCaptureNames;
+
+// Records the GL calls of a context into a capture file for tools/gl_replay.
+// - begin() replaces glad's function pointers (the glad_gl* variables gladLoadGLLoader filled in) with
+//   recording ones for the commands listed above, which call the real entry point, time it and append the
+//   record to a buffer that is written out in large blocks; end() puts the real pointers back. Everything that
+//   calls GL through glad is captured, the shared headers included, and nothing has to change at the call sites.
+// - Call begin() right after loadGLExtensions(), so the capture holds every object the calls later refer to.
+//   Before it the 4.x pointers are still NULL, so they would not be wrapped and the loader would then write the
+//   real, uncaptured ones over them; begin() refuses to start until the loader has run.
+//   Other entry points (glGet*, glReadPixels, bindless handles, ...) are not recorded; queries have no effect
+//   to replay, the rest is reported by gl_replay as it would be missing.
+// - Writes through a glMapBufferRange mapping are recorded when it is unmapped. A persistent mapping is never
+//   unmapped: its writes are recorded only where a glTexImage* reads them from a GL_PIXEL_UNPACK_BUFFER (the
+//   TextureStreamer's ring). To capture the data streamed through a StreamBuffer or UniformArena, create it with
+//   persistentMapping false while recording, e.g. StreamBuffer(size, 3, !GLCapture::instance().active()), so it
+//   maps and unmaps every range.
+// - Pixel uploads from client memory assume rows tightly packed to GL_UNPACK_ALIGNMENT (no GL_UNPACK_ROW_LENGTH),
+//   as every sample uploads them. A program loaded with glProgramBinary only replays on the same driver, so a
+//   sample that captures skips its ProgramCache.
+// - GL is called from one thread, so is the capture; there is one per process (instance()).
+class GLCapture
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+    unsigned long calls = 0;
+    unsigned long frames = 0;
+    unsigned long long bytesWritten = 0;
+
+    static GLCapture& instance()
+    {
+        static GLCapture capture;
+        return capture;
+    }
+
+    // starts recording into path; call with the context current, right after loadGLExtensions()
+    // ------------------------------------------------------------------------
+    bool begin(const char* path)
+    {
+        if (recording)
+            return false;
+        if (!glExtensionsLoaded)
+        {
+            std::cout << "ERROR::GL_CAPTURE::EXTENSIONS_NOT_LOADED: call loadGLExtensions before begin()" << std::endl;
+            return false;
+        }
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            std::cout << "ERROR::GL_CAPTURE::FILE_NOT_OPENED: " << path << std::endl;
+            return false;
+        }
+        GLCaptureHeader header;
+        std::memcpy(header.magic, GL_CAPTURE_MAGIC, sizeof(header.magic));
+        glGetIntegerv(GL_MAJOR_VERSION, &header.majorVersion);
+        glGetIntegerv(GL_MINOR_VERSION, &header.minorVersion);
+        GLint viewport[4] = { 0, 0, 0, 0 };
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        header.width = viewport[2];
+        header.height = viewport[3];
+        file.write((const char*)&header, sizeof(header));
+        bytesWritten = sizeof(header);
+        this->path = path;
+        buffer.reserve(FLUSH_BYTES + 64 * 1024); // so recording does not reallocate in the middle of a frame
+        calls = frames = 0;
+        frameStart = Clock::now();
+        install();
+        recording = true;
+        return true;
+    }
+    // marks the end of a frame; call right before the swap
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        if (!recording)
+            return;
+        Clock::time_point now = Clock::now();
+        beginRecord(GL_CAPTURE_FRAME_END, 0);
+        put((unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(now - frameStart).count());
+        endRecord();
+        frameStart = now;
+        frames++;
+        if (buffer.size() >= FLUSH_BYTES)
+            flush();
+    }
+    // restores the real entry points and closes the file
+    // ------------------------------------------------------------------------
+    void end()
+    {
+        if (!recording)
+            return;
+        restore();
+        recording = false;
+        flush();
+        file.close();
+        mappings.clear();
+        report();
+    }
+    // ------------------------------------------------------------------------
+    bool active() const
+    {
+        return recording;
+    }
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout) const
+    {
+        out << "GLCapture: " << frames << " frames, " << calls << " calls, " << bytesWritten / (1024.0 * 1024.0) << " MB in "
+            << path << std::endl;
+    }
+
+    // record encoding, used by the recording entry points
+    // ------------------------------------------------------------------------
+    void beginRecord(int command, unsigned long long ns)
+    {
+        put((unsigned short)command);
+        put((unsigned int)std::min<unsigned long long>(ns, UINT_MAX));
+        recordStart = buffer.size();
+        put((unsigned int)0);
+    }
+    // ------------------------------------------------------------------------
+    void endRecord()
+    {
+        unsigned int size = (unsigned int)(buffer.size() - recordStart - sizeof(unsigned int));
+        std::memcpy(&buffer[recordStart], &size, sizeof(size));
+        calls++;
+    }
+    // ------------------------------------------------------------------------
+    template <typename T> void put(T value)
+    {
+        const char* bytes = (const char*)&value;
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+    // an offset into a bound buffer, or a sync object
+    // ------------------------------------------------------------------------
+    template <typename T> void put(T* pointer)
+    {
+        put((unsigned long long)(uintptr_t)pointer);
+    }
+    // ------------------------------------------------------------------------
+    void putBlob(const void* data, size_t size)
+    {
+        if (!data)
+        {
+            put(GL_CAPTURE_NULL_BLOB);
+            return;
+        }
+        put((unsigned int)size);
+        buffer.insert(buffer.end(), (const char*)data, (const char*)data + size);
+    }
+    // ------------------------------------------------------------------------
+    static unsigned long long elapsedNs(Clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    }
+
+private:
+    static const size_t FLUSH_BYTES = 4 * 1024 * 1024;
+
+    struct Mapping
+    {
+        GLenum target;
+        GLuint buffer;   // for persistent ones
+        GLintptr offset;
+        GLsizeiptr length;
+        GLbitfield access;
+        void* pointer;
+    };
+    // the real entry points of the commands with members of their own
+#define GL_CAPTURE_DECLARE_REAL(name) decltype(glad_gl##name) name = NULL;
+    struct RealEntryPoints
+    {
+        GL_CAPTURE_CUSTOM_COMMANDS(GL_CAPTURE_DECLARE_REAL)
+        GL_CAPTURE_DECLARE_REAL(MapBufferRange)
+    };
+#undef GL_CAPTURE_DECLARE_REAL
+
+    RealEntryPoints real;
+    bool recording = false;
+    bool warnedPersistent = false;
+    std::ofstream file;
+    std::string path;
+    std::vector<char> buffer;
+    size_t recordStart = 0;
+    Clock::time_point frameStart;
+    std::vector<Mapping> mappings; // write mappings not unmapped yet, persistent ones included
+
+    GLCapture()
+    {
+    }
+
+    // ------------------------------------------------------------------------
+    void flush()
+    {
+        file.write(buffer.data(), buffer.size());
+        bytesWritten += buffer.size();
+        buffer.clear();
+    }
+    // swap glad's pointers for the recording ones and back, below the recording entry points they refer to
+    void install();
+    void restore();
+    // the pixels a glTexImage* reads: from client memory, the bound pixel unpack buffer or, when that buffer
+    // is persistently mapped, from the mapping, which is recorded as if it came from client memory
+    // ------------------------------------------------------------------------
+    void putPixels(const void* pixels, size_t bytes)
+    {
+        GLint unpackBuffer = 0;
+        glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+        if (unpackBuffer == 0)
+        {
+            put((unsigned char)(pixels ? 1 : 0));
+            if (pixels)
+                putBlob(pixels, bytes);
+            return;
+        }
+        GLintptr offset = (GLintptr)(uintptr_t)pixels;
+        for (size_t i = 0; i < mappings.size(); i++)
+        {
+            const Mapping& mapping = mappings[i];
+            if ((mapping.access & GL_MAP_PERSISTENT_BIT) && mapping.buffer == (GLuint)unpackBuffer && offset >= mapping.offset &&
+                offset + (GLintptr)bytes <= mapping.offset + mapping.length)
+            {
+                put((unsigned char)1);
+                putBlob((const char*)mapping.pointer + (offset - mapping.offset), bytes);
+                return;
+            }
+        }
+        put((unsigned char)2);
+        put(pixels);
+    }
+    // ------------------------------------------------------------------------
+    static int unpackAlignment()
+    {
+        GLint alignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        return alignment;
+    }
+
+    // the recording entry points of GL_CAPTURE_CUSTOM_COMMANDS
+    // ------------------------------------------------------------------------
+    static GLuint APIENTRY recordCreateShader(GLenum type)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        GLuint shader = capture.real.CreateShader(type);
+        capture.beginRecord(GL_CAPTURE_CreateShader, elapsedNs(start));
+        capture.put(type);
+        capture.put(shader);
+        capture.endRecord();
+        return shader;
+    }
+    static GLuint APIENTRY recordCreateProgram()
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        GLuint program = capture.real.CreateProgram();
+        capture.beginRecord(GL_CAPTURE_CreateProgram, elapsedNs(start));
+        capture.put(program);
+        capture.endRecord();
+        return program;
+    }
+    static void APIENTRY recordShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.ShaderSource(shader, count, strings, lengths);
+        capture.beginRecord(GL_CAPTURE_ShaderSource, elapsedNs(start));
+        capture.put(shader);
+        capture.put(count);
+        for (GLsizei i = 0; i < count; i++)
+            capture.putBlob(strings[i], lengths && lengths[i] >= 0 ? lengths[i] : std::strlen(strings[i]));
+        capture.endRecord();
+    }
+    static GLint APIENTRY recordGetUniformLocation(GLuint program, const GLchar* name)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        GLint location = capture.real.GetUniformLocation(program, name);
+        capture.beginRecord(GL_CAPTURE_GetUniformLocation, elapsedNs(start));
+        capture.put(program);
+        capture.putBlob(name, std::strlen(name));
+        capture.put(location);
+        capture.endRecord();
+        return location;
+    }
+    static GLuint APIENTRY recordGetUniformBlockIndex(GLuint program, const GLchar* name)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        GLuint index = capture.real.GetUniformBlockIndex(program, name);
+        capture.beginRecord(GL_CAPTURE_GetUniformBlockIndex, elapsedNs(start));
+        capture.put(program);
+        capture.putBlob(name, std::strlen(name));
+        capture.put(index);
+        capture.endRecord();
+        return index;
+    }
+    static void APIENTRY recordBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.BufferData(target, size, data, usage);
+        capture.beginRecord(GL_CAPTURE_BufferData, elapsedNs(start));
+        capture.put(target);
+        capture.put((unsigned long long)size);
+        capture.putBlob(data, size);
+        capture.put(usage);
+        capture.endRecord();
+    }
+    static void APIENTRY recordBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.BufferStorage(target, size, data, flags);
+        capture.beginRecord(GL_CAPTURE_BufferStorage, elapsedNs(start));
+        capture.put(target);
+        capture.put((unsigned long long)size);
+        capture.putBlob(data, size);
+        capture.put(flags);
+        capture.endRecord();
+    }
+    static void APIENTRY recordBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.BufferSubData(target, offset, size, data);
+        capture.beginRecord(GL_CAPTURE_BufferSubData, elapsedNs(start));
+        capture.put(target);
+        capture.put((unsigned long long)offset);
+        capture.putBlob(data, size);
+        capture.endRecord();
+    }
+    // not a command of its own: the writes are recorded when the mapping ends
+    static void* APIENTRY recordMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+        GLCapture& capture = instance();
+        void* pointer = capture.real.MapBufferRange(target, offset, length, access);
+        if (pointer && (access & GL_MAP_WRITE_BIT))
+        {
+            Mapping mapping = { target, 0, offset, length, access, pointer };
+            if (access & GL_MAP_PERSISTENT_BIT)
+            {
+                GLint buffer = 0;
+                if (target == GL_PIXEL_UNPACK_BUFFER)
+                    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &buffer);
+                else if (!capture.warnedPersistent)
+                {
+                    std::cout << "ERROR::GL_CAPTURE::PERSISTENT_MAPPING: writes through a persistent mapping of this "
+                                 "target are not captured" << std::endl;
+                    capture.warnedPersistent = true;
+                }
+                mapping.buffer = buffer;
+            }
+            capture.mappings.push_back(mapping);
+        }
+        return pointer;
+    }
+    static GLboolean APIENTRY recordUnmapBuffer(GLenum target)
+    {
+        GLCapture& capture = instance();
+        for (size_t i = capture.mappings.size(); i-- > 0;)
+        {
+            // the latest mapping of the target is the one of the buffer bound to it
+            Mapping mapping = capture.mappings[i];
+            if (mapping.target != target)
+                continue;
+            capture.mappings.erase(capture.mappings.begin() + i);
+            // the bytes have to be read before the mapping goes away, the time is the unmap's alone
+            size_t recordBegin = capture.buffer.size();
+            capture.beginRecord(GL_CAPTURE_UnmapBuffer, 0);
+            capture.put(target);
+            capture.put((unsigned long long)mapping.offset);
+            capture.put(mapping.access);
+            capture.putBlob(mapping.pointer, mapping.length);
+            capture.endRecord();
+            Clock::time_point start = Clock::now();
+            GLboolean result = capture.real.UnmapBuffer(target);
+            unsigned int ns = (unsigned int)std::min<unsigned long long>(elapsedNs(start), UINT_MAX);
+            std::memcpy(&capture.buffer[recordBegin + sizeof(unsigned short)], &ns, sizeof(ns));
+            return result;
+        }
+        return capture.real.UnmapBuffer(target); // a read-only mapping
+    }
+    static void APIENTRY recordTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                          GLint border, GLenum format, GLenum type, const void* pixels)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.TexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+        capture.beginRecord(GL_CAPTURE_TexImage2D, elapsedNs(start));
+        capture.put(target);
+        capture.put(level);
+        capture.put(internalformat);
+        capture.put(width);
+        capture.put(height);
+        capture.put(border);
+        capture.put(format);
+        capture.put(type);
+        capture.putPixels(pixels, glCaptureImageBytes(width, height, 1, format, type, unpackAlignment()));
+        capture.endRecord();
+    }
+    static void APIENTRY recordTexImage3D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height,
+                                          GLsizei depth, GLint border, GLenum format, GLenum type, const void* pixels)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.TexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
+        capture.beginRecord(GL_CAPTURE_TexImage3D, elapsedNs(start));
+        capture.put(target);
+        capture.put(level);
+        capture.put(internalformat);
+        capture.put(width);
+        capture.put(height);
+        capture.put(depth);
+        capture.put(border);
+        capture.put(format);
+        capture.put(type);
+        capture.putPixels(pixels, glCaptureImageBytes(width, height, depth, format, type, unpackAlignment()));
+        capture.endRecord();
+    }
+    static void APIENTRY recordCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width,
+                                                    GLsizei height, GLint border, GLsizei imageSize, const void* data)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.CompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+        capture.beginRecord(GL_CAPTURE_CompressedTexImage2D, elapsedNs(start));
+        capture.put(target);
+        capture.put(level);
+        capture.put(internalformat);
+        capture.put(width);
+        capture.put(height);
+        capture.put(border);
+        capture.put(imageSize);
+        capture.putPixels(data, imageSize);
+        capture.endRecord();
+    }
+    static void APIENTRY recordUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.Uniform4fv(location, count, value);
+        capture.beginRecord(GL_CAPTURE_Uniform4fv, elapsedNs(start));
+        capture.put(location);
+        capture.put(count);
+        capture.putBlob(value, 4 * sizeof(GLfloat) * count);
+        capture.endRecord();
+    }
+    static GLsync APIENTRY recordFenceSync(GLenum condition, GLbitfield flags)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        GLsync sync = capture.real.FenceSync(condition, flags);
+        capture.beginRecord(GL_CAPTURE_FenceSync, elapsedNs(start));
+        capture.put(condition);
+        capture.put(flags);
+        capture.put(sync);
+        capture.endRecord();
+        return sync;
+    }
+    static GLenum APIENTRY recordClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        GLenum status = capture.real.ClientWaitSync(sync, flags, timeout);
+        capture.beginRecord(GL_CAPTURE_ClientWaitSync, elapsedNs(start));
+        capture.put(sync);
+        capture.put(flags);
+        capture.put(timeout);
+        capture.endRecord();
+        return status;
+    }
+    static void APIENTRY recordDeleteSync(GLsync sync)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.DeleteSync(sync);
+        capture.beginRecord(GL_CAPTURE_DeleteSync, elapsedNs(start));
+        capture.put(sync);
+        capture.endRecord();
+    }
+    static void APIENTRY recordProgramBinary(GLuint program, GLenum format, const void* binary, GLsizei length)
+    {
+        GLCapture& capture = instance();
+        Clock::time_point start = Clock::now();
+        capture.real.ProgramBinary(program, format, binary, length);
+        capture.beginRecord(GL_CAPTURE_ProgramBinary, elapsedNs(start));
+        capture.put(program);
+        capture.put(format);
+        capture.putBlob(binary, length);
+        capture.endRecord();
+    }
+};
+
+// the recording entry point of a GL_CAPTURE_SCALAR_COMMANDS command: calls the real one and records its arguments
+template <int COMMAND, typename... Args>
+struct GLCaptureScalar<COMMAND, void (APIENTRYP)(Args...)>
+{
+    static void (APIENTRYP real)(Args...);
+    static void APIENTRY call(Args... args)
+    {
+        GLCapture& capture = GLCapture::instance();
+        GLCapture::Clock::time_point start = GLCapture::Clock::now();
+        real(args...);
+        capture.beginRecord(COMMAND, GLCapture::elapsedNs(start));
+        (capture.put(args), ...);
+        capture.endRecord();
+    }
+};
+template <int COMMAND, typename... Args>
+void (APIENTRYP GLCaptureScalar<COMMAND, void (APIENTRYP)(Args...)>::real)(Args...) = NULL;
+
+// the recording entry point of a glGen* or glDelete* command: the count, then the names (after the call)
+template <int COMMAND, typename Names>
+struct GLCaptureNames<COMMAND, void (APIENTRYP)(GLsizei, Names*)>
+{
+    static void (APIENTRYP real)(GLsizei, Names*);
+    static void APIENTRY call(GLsizei n, Names* names)
+    {
+        GLCapture& capture = GLCapture::instance();
+        GLCapture::Clock::time_point start = GLCapture::Clock::now();
+        real(n, names);
+        capture.beginRecord(COMMAND, GLCapture::elapsedNs(start));
+        capture.put(n);
+        for (GLsizei i = 0; i < n; i++)
+            capture.put((GLuint)names[i]);
+        capture.endRecord();
+    }
+};
+template <int COMMAND, typename Names>
+void (APIENTRYP GLCaptureNames<COMMAND, void (APIENTRYP)(GLsizei, Names*)>::real)(GLsizei, Names*) = NULL;
+
+// swaps glad's pointers for the recording ones; an entry point the driver lacks stays NULL
+// ------------------------------------------------------------------------
+inline void GLCapture::install()
+{
+#define GL_CAPTURE_INSTALL_SCALAR(name, ...) \
+    GLCaptureScalar<GL_CAPTURE_##name, decltype(glad_gl##name)>::real = glad_gl##name; \
+    if (glad_gl##name) \
+        glad_gl##name = GLCaptureScalar<GL_CAPTURE_##name, decltype(glad_gl##name)>::call;
+#define GL_CAPTURE_INSTALL_NAMES(name, ...) \
+    GLCaptureNames<GL_CAPTURE_##name, decltype(glad_gl##name)>::real = glad_gl##name; \
+    if (glad_gl##name) \
+        glad_gl##name = GLCaptureNames<GL_CAPTURE_##name, decltype(glad_gl##name)>::call;
+#define GL_CAPTURE_INSTALL_CUSTOM(name) \
+    real.name = glad_gl##name; \
+    if (glad_gl##name) \
+        glad_gl##name = record##name;
+    GL_CAPTURE_SCALAR_COMMANDS(GL_CAPTURE_INSTALL_SCALAR)
+    GL_CAPTURE_GEN_COMMANDS(GL_CAPTURE_INSTALL_NAMES)
+    GL_CAPTURE_DELETE_COMMANDS(GL_CAPTURE_INSTALL_NAMES)
+    GL_CAPTURE_CUSTOM_COMMANDS(GL_CAPTURE_INSTALL_CUSTOM)
+    GL_CAPTURE_INSTALL_CUSTOM(MapBufferRange)
+#undef GL_CAPTURE_INSTALL_SCALAR
+#undef GL_CAPTURE_INSTALL_NAMES
+#undef GL_CAPTURE_INSTALL_CUSTOM
+}
+// puts glad's pointers back to the real entry points
+// ------------------------------------------------------------------------
+inline void GLCapture::restore()
+{
+#define GL_CAPTURE_RESTORE_SCALAR(name, ...) glad_gl##name = GLCaptureScalar<GL_CAPTURE_##name, decltype(glad_gl##name)>::real;
+#define GL_CAPTURE_RESTORE_NAMES(name, ...) glad_gl##name = GLCaptureNames<GL_CAPTURE_##name, decltype(glad_gl##name)>::real;
+#define GL_CAPTURE_RESTORE_CUSTOM(name) glad_gl##name = real.name;
+    GL_CAPTURE_SCALAR_COMMANDS(GL_CAPTURE_RESTORE_SCALAR)
+    GL_CAPTURE_GEN_COMMANDS(GL_CAPTURE_RESTORE_NAMES)
+    GL_CAPTURE_DELETE_COMMANDS(GL_CAPTURE_RESTORE_NAMES)
+    GL_CAPTURE_CUSTOM_COMMANDS(GL_CAPTURE_RESTORE_CUSTOM)
+    GL_CAPTURE_RESTORE_CUSTOM(MapBufferRange)
+#undef GL_CAPTURE_RESTORE_SCALAR
+#undef GL_CAPTURE_RESTORE_NAMES
+#undef GL_CAPTURE_RESTORE_CUSTOM
+}
+#endif
@@ -0,0 +1,324 @@
+#ifndef GL_EXTENSIONS_H
+#define GL_EXTENSIONS_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+// Entry points, tokens and feature flags past the stock 3.3 core glad the samples ship with. The first user is
+// TextureStreamer (glBufferStorage for its persistently mapped pixel buffer); every later header that takes a
+// 4.x or extension path includes this file instead of requiring a regenerated glad.
+//
+// The fallback contract:
+// - Everything is declared behind the guard glad itself uses (the token, the glX macro, the GL_VERSION_x_y or
+//   GL_ARB_... feature macro), so with a glad generated for 4.6 and these extensions this header is empty and
+//   glad's own declarations are used.
+// - Call loadGLExtensions with the same loader right after gladLoadGLLoader, before any shared header creates
+//   GL objects and before GLCapture::begin, which wraps the pointers it finds loaded.
+// - The GLAD_GL_VERSION_4_x and GLAD_GL_ARB_/KHR_/EXT_ flags read 0 until then, and afterwards report what the
+//   context really offers. An entry point may be non-NULL while its flag is 0 (some drivers export everything),
+//   so the headers test the flag, never the pointer, and keep their 3.3 path when it is 0.
+
+// extension tokens
+// ----------------
+#ifndef GL_ATOMIC_COUNTER_BARRIER_BIT
+#define GL_ATOMIC_COUNTER_BARRIER_BIT 0x00001000
+#endif
+#ifndef GL_ATOMIC_COUNTER_BUFFER
+#define GL_ATOMIC_COUNTER_BUFFER 0x92C0
+#endif
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_6x6_KHR
+#define GL_COMPRESSED_RGBA_ASTC_6x6_KHR 0x93B4
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_8x8_KHR
+#define GL_COMPRESSED_RGBA_ASTC_8x8_KHR 0x93B7
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_SHADER_STORAGE_BLOCK
+#define GL_SHADER_STORAGE_BLOCK 0x92E6
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+
+// entry points
+// ------------
+#ifndef glBindVertexBuffer
+typedef void (APIENTRYP PFNGLBINDVERTEXBUFFERPROC)(GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+inline PFNGLBINDVERTEXBUFFERPROC glad_glBindVertexBuffer = NULL;
+#define glBindVertexBuffer glad_glBindVertexBuffer
+#endif
+#ifndef glBufferStorage
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+inline PFNGLBUFFERSTORAGEPROC glad_glBufferStorage = NULL;
+#define glBufferStorage glad_glBufferStorage
+#endif
+#ifndef glDispatchCompute
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+inline PFNGLDISPATCHCOMPUTEPROC glad_glDispatchCompute = NULL;
+#define glDispatchCompute glad_glDispatchCompute
+#endif
+#ifndef glGetProgramBinary
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+inline PFNGLGETPROGRAMBINARYPROC glad_glGetProgramBinary = NULL;
+#define glGetProgramBinary glad_glGetProgramBinary
+#endif
+#ifndef glGetTextureHandleARB
+typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+inline PFNGLGETTEXTUREHANDLEARBPROC glad_glGetTextureHandleARB = NULL;
+#define glGetTextureHandleARB glad_glGetTextureHandleARB
+#endif
+#ifndef glMakeTextureHandleNonResidentARB
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+inline PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glad_glMakeTextureHandleNonResidentARB = NULL;
+#define glMakeTextureHandleNonResidentARB glad_glMakeTextureHandleNonResidentARB
+#endif
+#ifndef glMakeTextureHandleResidentARB
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+inline PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glad_glMakeTextureHandleResidentARB = NULL;
+#define glMakeTextureHandleResidentARB glad_glMakeTextureHandleResidentARB
+#endif
+#ifndef glMaxShaderCompilerThreadsARB
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSARBPROC)(GLuint count);
+inline PFNGLMAXSHADERCOMPILERTHREADSARBPROC glad_glMaxShaderCompilerThreadsARB = NULL;
+#define glMaxShaderCompilerThreadsARB glad_glMaxShaderCompilerThreadsARB
+#endif
+#ifndef glMaxShaderCompilerThreadsKHR
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+inline PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glad_glMaxShaderCompilerThreadsKHR = NULL;
+#define glMaxShaderCompilerThreadsKHR glad_glMaxShaderCompilerThreadsKHR
+#endif
+#ifndef glMemoryBarrier
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+inline PFNGLMEMORYBARRIERPROC glad_glMemoryBarrier = NULL;
+#define glMemoryBarrier glad_glMemoryBarrier
+#endif
+#ifndef glMultiDrawElementsIndirect
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+inline PFNGLMULTIDRAWELEMENTSINDIRECTPROC glad_glMultiDrawElementsIndirect = NULL;
+#define glMultiDrawElementsIndirect glad_glMultiDrawElementsIndirect
+#endif
+#ifndef glMultiDrawElementsIndirectCount
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+inline PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC glad_glMultiDrawElementsIndirectCount = NULL;
+#define glMultiDrawElementsIndirectCount glad_glMultiDrawElementsIndirectCount
+#endif
+#ifndef glMultiDrawElementsIndirectCountARB
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC)(GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+inline PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC glad_glMultiDrawElementsIndirectCountARB = NULL;
+#define glMultiDrawElementsIndirectCountARB glad_glMultiDrawElementsIndirectCountARB
+#endif
+#ifndef glProgramBinary
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+inline PFNGLPROGRAMBINARYPROC glad_glProgramBinary = NULL;
+#define glProgramBinary glad_glProgramBinary
+#endif
+#ifndef glProgramParameteri
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+inline PFNGLPROGRAMPARAMETERIPROC glad_glProgramParameteri = NULL;
+#define glProgramParameteri glad_glProgramParameteri
+#endif
+#ifndef glVertexAttribBinding
+typedef void (APIENTRYP PFNGLVERTEXATTRIBBINDINGPROC)(GLuint attribindex, GLuint bindingindex);
+inline PFNGLVERTEXATTRIBBINDINGPROC glad_glVertexAttribBinding = NULL;
+#define glVertexAttribBinding glad_glVertexAttribBinding
+#endif
+#ifndef glVertexAttribFormat
+typedef void (APIENTRYP PFNGLVERTEXATTRIBFORMATPROC)(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+inline PFNGLVERTEXATTRIBFORMATPROC glad_glVertexAttribFormat = NULL;
+#define glVertexAttribFormat glad_glVertexAttribFormat
+#endif
+#ifndef glVertexAttribIFormat
+typedef void (APIENTRYP PFNGLVERTEXATTRIBIFORMATPROC)(GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+inline PFNGLVERTEXATTRIBIFORMATPROC glad_glVertexAttribIFormat = NULL;
+#define glVertexAttribIFormat glad_glVertexAttribIFormat
+#endif
+
+// flags, set by loadGLExtensions
+// ------------------------------
+#ifndef GL_VERSION_4_0
+inline int GLAD_GL_VERSION_4_0 = 0;
+#endif
+#ifndef GL_VERSION_4_1
+inline int GLAD_GL_VERSION_4_1 = 0;
+#endif
+#ifndef GL_VERSION_4_2
+inline int GLAD_GL_VERSION_4_2 = 0;
+#endif
+#ifndef GL_VERSION_4_3
+inline int GLAD_GL_VERSION_4_3 = 0;
+#endif
+#ifndef GL_VERSION_4_4
+inline int GLAD_GL_VERSION_4_4 = 0;
+#endif
+#ifndef GL_VERSION_4_5
+inline int GLAD_GL_VERSION_4_5 = 0;
+#endif
+#ifndef GL_VERSION_4_6
+inline int GLAD_GL_VERSION_4_6 = 0;
+#endif
+#ifndef GL_ARB_ES3_compatibility
+inline int GLAD_GL_ARB_ES3_compatibility = 0;
+#endif
+#ifndef GL_ARB_bindless_texture
+inline int GLAD_GL_ARB_bindless_texture = 0;
+#endif
+#ifndef GL_ARB_buffer_storage
+inline int GLAD_GL_ARB_buffer_storage = 0;
+#endif
+#ifndef GL_ARB_get_program_binary
+inline int GLAD_GL_ARB_get_program_binary = 0;
+#endif
+#ifndef GL_ARB_indirect_parameters
+inline int GLAD_GL_ARB_indirect_parameters = 0;
+#endif
+#ifndef GL_ARB_parallel_shader_compile
+inline int GLAD_GL_ARB_parallel_shader_compile = 0;
+#endif
+#ifndef GL_ARB_shader_draw_parameters
+inline int GLAD_GL_ARB_shader_draw_parameters = 0;
+#endif
+#ifndef GL_ARB_texture_compression_bptc
+inline int GLAD_GL_ARB_texture_compression_bptc = 0;
+#endif
+#ifndef GL_ARB_vertex_attrib_binding
+inline int GLAD_GL_ARB_vertex_attrib_binding = 0;
+#endif
+#ifndef GL_EXT_texture_compression_s3tc
+inline int GLAD_GL_EXT_texture_compression_s3tc = 0;
+#endif
+#ifndef GL_KHR_parallel_shader_compile
+inline int GLAD_GL_KHR_parallel_shader_compile = 0;
+#endif
+#ifndef GL_KHR_texture_compression_astc_ldr
+inline int GLAD_GL_KHR_texture_compression_astc_ldr = 0;
+#endif
+
+// whether loadGLExtensions ran, for code that must not run before it (GLCapture::begin)
+inline bool glExtensionsLoaded = false;
+
+// loads the entry points and sets the flags above from the current context; loading again what glad already
+// loaded is harmless, so this does not need to know which of them glad declared itself
+// ------------------------------------------------------------------------
+inline void loadGLExtensions(GLADloadproc load)
+{
+    glad_glBindVertexBuffer = (PFNGLBINDVERTEXBUFFERPROC)load("glBindVertexBuffer");
+    glad_glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+    glad_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC)load("glDispatchCompute");
+    glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+    glad_glGetTextureHandleARB = (PFNGLGETTEXTUREHANDLEARBPROC)load("glGetTextureHandleARB");
+    glad_glMakeTextureHandleNonResidentARB = (PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)load("glMakeTextureHandleNonResidentARB");
+    glad_glMakeTextureHandleResidentARB = (PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)load("glMakeTextureHandleResidentARB");
+    glad_glMaxShaderCompilerThreadsARB = (PFNGLMAXSHADERCOMPILERTHREADSARBPROC)load("glMaxShaderCompilerThreadsARB");
+    glad_glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+    glad_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC)load("glMemoryBarrier");
+    glad_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC)load("glMultiDrawElementsIndirect");
+    glad_glMultiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)load("glMultiDrawElementsIndirectCount");
+    glad_glMultiDrawElementsIndirectCountARB = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTARBPROC)load("glMultiDrawElementsIndirectCountARB");
+    glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+    glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+    glad_glVertexAttribBinding = (PFNGLVERTEXATTRIBBINDINGPROC)load("glVertexAttribBinding");
+    glad_glVertexAttribFormat = (PFNGLVERTEXATTRIBFORMATPROC)load("glVertexAttribFormat");
+    glad_glVertexAttribIFormat = (PFNGLVERTEXATTRIBIFORMATPROC)load("glVertexAttribIFormat");
+
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    int version = major * 10 + minor;
+    GLAD_GL_VERSION_4_0 = version >= 40;
+    GLAD_GL_VERSION_4_1 = version >= 41;
+    GLAD_GL_VERSION_4_2 = version >= 42;
+    GLAD_GL_VERSION_4_3 = version >= 43;
+    GLAD_GL_VERSION_4_4 = version >= 44;
+    GLAD_GL_VERSION_4_5 = version >= 45;
+    GLAD_GL_VERSION_4_6 = version >= 46;
+
+    struct Extension
+    {
+        int* flag;
+        const char* name;
+    };
+    const Extension extensions[] = {
+        { &GLAD_GL_ARB_ES3_compatibility, "GL_ARB_ES3_compatibility" },
+        { &GLAD_GL_ARB_bindless_texture, "GL_ARB_bindless_texture" },
+        { &GLAD_GL_ARB_buffer_storage, "GL_ARB_buffer_storage" },
+        { &GLAD_GL_ARB_get_program_binary, "GL_ARB_get_program_binary" },
+        { &GLAD_GL_ARB_indirect_parameters, "GL_ARB_indirect_parameters" },
+        { &GLAD_GL_ARB_parallel_shader_compile, "GL_ARB_parallel_shader_compile" },
+        { &GLAD_GL_ARB_shader_draw_parameters, "GL_ARB_shader_draw_parameters" },
+        { &GLAD_GL_ARB_texture_compression_bptc, "GL_ARB_texture_compression_bptc" },
+        { &GLAD_GL_ARB_vertex_attrib_binding, "GL_ARB_vertex_attrib_binding" },
+        { &GLAD_GL_EXT_texture_compression_s3tc, "GL_EXT_texture_compression_s3tc" },
+        { &GLAD_GL_KHR_parallel_shader_compile, "GL_KHR_parallel_shader_compile" },
+        { &GLAD_GL_KHR_texture_compression_astc_ldr, "GL_KHR_texture_compression_astc_ldr" }
+    };
+    for (const Extension& extension : extensions)
+        *extension.flag = 0;
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+    {
+        const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+        for (const Extension& extension : extensions)
+            if (name && std::strcmp(name, extension.name) == 0)
+                *extension.flag = 1;
+    }
+    glExtensionsLoaded = true;
+}
+#endif
@@ -0,0 +1,225 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <iostream>
+
+// Shadows the GL state that render loops set over and over, and skips the calls that would not change it.
+// - Every setter compares against the value it set last and only calls into GL when the value differs.
+//   issued and elided count both cases, so the saved driver calls can be measured as a scene grows.
+// - The shadow starts out unknown, so the first call of every setter always goes through.
+// - It only knows about the calls made through it. After code that changes the same state directly (a
+//   helper class, a texture upload, the profiler overlay), call invalidate() and it starts over.
+// - The GL_ELEMENT_ARRAY_BUFFER binding belongs to the VAO, so changing the VAO forgets it.
+// - Deleting an object does not unbind it here; invalidate() too if the name is going to be reused.
+class GLState
+{
+public:
+    static const int MAX_TEXTURE_UNITS = 32;
+
+    unsigned long long issued = 0;
+    unsigned long long elided = 0;
+
+    GLState()
+    {
+        invalidate();
+    }
+
+    // forgets everything, the next call of every setter reaches GL again
+    // ------------------------------------------------------------------------
+    void invalidate()
+    {
+        program = vertexArray = UNKNOWN;
+        for (int i = 0; i < BUFFER_TARGETS; i++)
+            buffers[i] = UNKNOWN;
+        activeUnit = UNKNOWN;
+        for (int i = 0; i < MAX_TEXTURE_UNITS; i++)
+            for (int j = 0; j < TEXTURE_TARGETS; j++)
+                textures[i][j] = UNKNOWN;
+        blend = depthTest = cullFace = -1;
+        blendSource = blendDestination = depthFunction = UNKNOWN;
+        depthMask = -1;
+        clearColorKnown = false;
+    }
+    // ------------------------------------------------------------------------
+    void useProgram(unsigned int id)
+    {
+        if (changed(program, id))
+            glUseProgram(id);
+    }
+    // ------------------------------------------------------------------------
+    void bindVertexArray(unsigned int id)
+    {
+        if (!changed(vertexArray, id))
+            return;
+        glBindVertexArray(id);
+        buffers[bufferIndex(GL_ELEMENT_ARRAY_BUFFER)] = UNKNOWN;
+    }
+    // ------------------------------------------------------------------------
+    void bindBuffer(GLenum target, unsigned int id)
+    {
+        int index = bufferIndex(target);
+        if (index < 0)
+        {
+            issued++;
+            glBindBuffer(target, id);
+        }
+        else if (changed(buffers[index], id))
+            glBindBuffer(target, id);
+    }
+    // binds a texture to the given unit, switching the active texture unit only if needed
+    // ------------------------------------------------------------------------
+    void bindTexture(GLenum target, unsigned int id, unsigned int unit = 0)
+    {
+        int index = textureIndex(target);
+        if (index >= 0 && unit < MAX_TEXTURE_UNITS && textures[unit][index] == id)
+        {
+            elided++;
+            return;
+        }
+        activeTexture(unit);
+        issued++;
+        glBindTexture(target, id);
+        if (index >= 0 && unit < MAX_TEXTURE_UNITS)
+            textures[unit][index] = id;
+    }
+    // ------------------------------------------------------------------------
+    void activeTexture(unsigned int unit)
+    {
+        if (changed(activeUnit, unit))
+            glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    // GL_BLEND, GL_DEPTH_TEST and GL_CULL_FACE are shadowed, every other capability is passed through
+    // ------------------------------------------------------------------------
+    void setEnabled(GLenum capability, bool enabled)
+    {
+        int* shadow = capability == GL_BLEND ? &blend : capability == GL_DEPTH_TEST ? &depthTest : capability == GL_CULL_FACE ? &cullFace : NULL;
+        if (shadow && *shadow == (int)enabled)
+        {
+            elided++;
+            return;
+        }
+        issued++;
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+        if (shadow)
+            *shadow = (int)enabled;
+    }
+    // ------------------------------------------------------------------------
+    void blendFunc(GLenum source, GLenum destination)
+    {
+        if (blendSource == source && blendDestination == destination)
+        {
+            elided++;
+            return;
+        }
+        issued++;
+        glBlendFunc(source, destination);
+        blendSource = source;
+        blendDestination = destination;
+    }
+    // ------------------------------------------------------------------------
+    void depthFunc(GLenum function)
+    {
+        if (changed(depthFunction, function))
+            glDepthFunc(function);
+    }
+    // ------------------------------------------------------------------------
+    void setDepthMask(bool write)
+    {
+        if (depthMask == (int)write)
+        {
+            elided++;
+            return;
+        }
+        issued++;
+        glDepthMask(write ? GL_TRUE : GL_FALSE);
+        depthMask = (int)write;
+    }
+    // ------------------------------------------------------------------------
+    void clearColor(float r, float g, float b, float a)
+    {
+        if (clearColorKnown && color[0] == r && color[1] == g && color[2] == b && color[3] == a)
+        {
+            elided++;
+            return;
+        }
+        issued++;
+        glClearColor(r, g, b, a);
+        color[0] = r; color[1] = g; color[2] = b; color[3] = a;
+        clearColorKnown = true;
+    }
+    // prints the counters, e.g. when the window closes
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout) const
+    {
+        unsigned long long total = issued + elided;
+        out << "GLState: " << issued << " state calls issued, " << elided << " elided";
+        if (total > 0)
+            out << " (" << 100.0 * elided / total << "%)";
+        out << std::endl;
+    }
+
+private:
+    // no GL object or enum has this value, so it never compares equal to a real one
+    static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+    static const int BUFFER_TARGETS = 7;
+    static const int TEXTURE_TARGETS = 4;
+
+    unsigned int program, vertexArray;
+    unsigned int buffers[BUFFER_TARGETS];
+    unsigned int activeUnit;
+    unsigned int textures[MAX_TEXTURE_UNITS][TEXTURE_TARGETS];
+    int blend, depthTest, cullFace; // -1 unknown
+    GLenum blendSource, blendDestination, depthFunction;
+    int depthMask;
+    float color[4];
+    bool clearColorKnown;
+
+    // updates the shadow and returns whether the call has to be made
+    // ------------------------------------------------------------------------
+    bool changed(unsigned int& shadow, unsigned int value)
+    {
+        if (shadow == value)
+        {
+            elided++;
+            return false;
+        }
+        shadow = value;
+        issued++;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    static int bufferIndex(GLenum target)
+    {
+        switch (target)
+        {
+        case GL_ARRAY_BUFFER: return 0;
+        case GL_ELEMENT_ARRAY_BUFFER: return 1;
+        case GL_UNIFORM_BUFFER: return 2;
+        case GL_SHADER_STORAGE_BUFFER: return 3;
+        case GL_DRAW_INDIRECT_BUFFER: return 4;
+        case GL_PIXEL_UNPACK_BUFFER: return 5;
+        case GL_COPY_WRITE_BUFFER: return 6;
+        default: return -1;
+        }
+    }
+    // ------------------------------------------------------------------------
+    static int textureIndex(GLenum target)
+    {
+        switch (target)
+        {
+        case GL_TEXTURE_2D: return 0;
+        case GL_TEXTURE_2D_ARRAY: return 1;
+        case GL_TEXTURE_CUBE_MAP: return 2;
+        case GL_TEXTURE_3D: return 3;
+        default: return -1;
+        }
+    }
+};
+#endif
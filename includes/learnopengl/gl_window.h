@@ -0,0 +1,25 @@
+#ifndef GL_WINDOW_H
+#define GL_WINDOW_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+
+// Creates a window with an OpenGL major.minor core context for the optional paths that need one (e.g. 4.3 for
+// the indirect draws), and with the tutorial's 3.3 core context when the driver can't give it (a 3.3 driver, or
+// macOS with 4.1). The window hints are left at 3.3 either way. The samples check at runtime which context they
+// got (GLAD_GL_VERSION_4_3 etc., see loadGLExtensions) and fall back themselves.
+// ------------------------------------------------------------------------
+inline GLFWwindow* createWindowPreferring(int width, int height, const char* title, int major, int minor)
+{
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, major);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minor);
+    GLFWwindow* window = glfwCreateWindow(width, height, title, NULL, NULL);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    if (window == NULL)
+        window = glfwCreateWindow(width, height, title, NULL, NULL);
+    return window;
+}
+#endif
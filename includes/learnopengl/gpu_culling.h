@@ -0,0 +1,243 @@
+#ifndef GPU_CULLING_H
+#define GPU_CULLING_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+#include <learnopengl/multi_draw.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// bounding sphere of one object, in the same space as the frustum planes
+struct BoundingSphere
+{
+    float center[3];
+    float radius;
+};
+
+// extracts the six frustum planes (left, right, bottom, top, near, far) of a column-major view-projection matrix,
+// normalized, as (a, b, c, d) with a*x + b*y + c*z + d >= 0 inside
+// ------------------------------------------------------------------------
+inline void frustumPlanes(const float m[16], float planes[6][4])
+{
+    for (int i = 0; i < 6; i++)
+    {
+        int row = i / 2;
+        float sign = i % 2 ? -1.0f : 1.0f;
+        for (int j = 0; j < 4; j++)
+            planes[i][j] = m[j * 4 + 3] + sign * m[j * 4 + row];
+        float length = std::sqrt(planes[i][0] * planes[i][0] + planes[i][1] * planes[i][1] + planes[i][2] * planes[i][2]);
+        for (int j = 0; j < 4; j++)
+            planes[i][j] /= length;
+    }
+}
+
+// Culls the draws of a MultiDrawBatch on the GPU, so objects outside the view never reach the vertex shader and the
+// CPU never touches them per frame.
+// - cull() runs a compute shader with one invocation per object that tests its bounding sphere against the
+//   frustum planes. With glMultiDrawElementsIndirectCount (OpenGL 4.6 or ARB_indirect_parameters) the visible
+//   commands are appended to the output buffer through an atomic counter, and draw() takes the draw count
+//   straight from that counter, without reading it back.
+// - Without it every command is kept in place and the invisible ones get instanceCount 0; the draw call still
+//   covers all objects, but the GPU skips the empty ones before any vertex work.
+// - Either way every command keeps baseInstance = the object index, so draw with the program built from
+//   multiDrawVertexShader(true), which finds the DrawData through gl_BaseInstance instead of gl_DrawID.
+class GpuCuller
+{
+public:
+    GpuCuller(MeshPool& pool) : pool(pool), objectCount(0), capacity(0)
+    {
+        compact = GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_indirect_parameters;
+        glGenBuffers(1, &sourceBuffer);
+        glGenBuffers(1, &boundsBuffer);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &counterBuffer);
+        unsigned int zero = 0;
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+        glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(zero), &zero, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+        program = compileCullProgram();
+        planesLocation = glGetUniformLocation(program, "planes");
+        objectCountLocation = glGetUniformLocation(program, "objectCount");
+    }
+
+    // copies the commands of the batch and one bounding sphere per command; call again whenever they change
+    // ------------------------------------------------------------------------
+    void upload(const MultiDrawBatch& batch, const std::vector<BoundingSphere>& bounds)
+    {
+        objectCount = (unsigned int)batch.commands.size();
+        if (bounds.size() != objectCount)
+        {
+            std::cout << "ERROR::GPU_CULLER::BOUNDS_MISMATCH: " << objectCount << " commands but " << bounds.size() << " bounds" << std::endl;
+            objectCount = 0;
+            return;
+        }
+        pool.reserveDraws(objectCount);
+        if (objectCount > capacity)
+        {
+            capacity = objectCount;
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_COPY);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, sourceBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, objectCount * sizeof(DrawElementsIndirectCommand), batch.commands.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, boundsBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, objectCount * sizeof(BoundingSphere), bounds.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    // writes this frame's draw commands; planes as returned by frustumPlanes()
+    // ------------------------------------------------------------------------
+    void cull(const float planes[6][4])
+    {
+        if (objectCount == 0)
+            return;
+        unsigned int zero = 0;
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+        glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zero), &zero);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+
+        glUseProgram(program);
+        glUniform4fv(planesLocation, 6, &planes[0][0]);
+        glUniform1ui(objectCountLocation, objectCount);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, sourceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, boundsBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, commandBuffer);
+        glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counterBuffer);
+        glDispatchCompute((objectCount + GROUP_SIZE - 1) / GROUP_SIZE, 1, 1);
+        // the commands and the count are read by the draw call that follows, the count also by readVisibleCount()
+        // (glGetBufferSubData) and overwritten by the glBufferSubData reset of the next cull()
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_ATOMIC_COUNTER_BARRIER_BIT
+                        | GL_BUFFER_UPDATE_BARRIER_BIT);
+    }
+    // draws the commands that survived cull(); the program of the batch has to be in use (see the class comment)
+    // ------------------------------------------------------------------------
+    void draw(const MultiDrawBatch& batch)
+    {
+        if (objectCount == 0)
+            return;
+        glBindVertexArray(pool.VAO);
+        batch.bindDrawData();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        if (compact)
+        {
+            glBindBuffer(GL_PARAMETER_BUFFER, counterBuffer);
+            if (GLAD_GL_VERSION_4_6)
+                glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, 0, (GLsizei)objectCount, 0);
+            else
+                glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, 0, (GLsizei)objectCount, 0);
+            glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        }
+        else
+        {
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)objectCount, 0);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    // reads the number of visible objects back from the GPU. This waits for the culling pass to finish, so it is
+    // meant for statistics and debugging, not for every frame; without compaction it always returns 0.
+    // ------------------------------------------------------------------------
+    unsigned int readVisibleCount()
+    {
+        unsigned int count = 0;
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+        glGetBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(count), &count);
+        glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, 0);
+        return count;
+    }
+    // whether draw() uses the compacted, GPU-counted path
+    // ------------------------------------------------------------------------
+    bool compacting() const
+    {
+        return compact;
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteBuffers(1, &sourceBuffer);
+        glDeleteBuffers(1, &boundsBuffer);
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &counterBuffer);
+        glDeleteProgram(program);
+        sourceBuffer = boundsBuffer = commandBuffer = counterBuffer = program = 0;
+    }
+
+private:
+    static const unsigned int GROUP_SIZE = 64;
+
+    MeshPool& pool;
+    unsigned int sourceBuffer, boundsBuffer, commandBuffer, counterBuffer;
+    unsigned int program;
+    int planesLocation, objectCountLocation;
+    unsigned int objectCount, capacity;
+    bool compact;
+
+    // ------------------------------------------------------------------------
+    unsigned int compileCullProgram()
+    {
+        std::string source = "#version 430 core\n";
+        if (compact)
+            source += "#define COMPACT\n";
+        source +=
+            "layout (local_size_x = 64) in;\n"
+            "struct Command\n"
+            "{\n"
+            "   uint count;\n"
+            "   uint instanceCount;\n"
+            "   uint firstIndex;\n"
+            "   int baseVertex;\n"
+            "   uint baseInstance;\n"
+            "};\n"
+            "layout (std430, binding = 1) readonly buffer SourceCommands { Command sources[]; };\n"
+            "layout (std430, binding = 2) readonly buffer Bounds { vec4 spheres[]; };\n"
+            "layout (std430, binding = 3) writeonly buffer Commands { Command commands[]; };\n"
+            "layout (binding = 0, offset = 0) uniform atomic_uint drawCount;\n"
+            "uniform vec4 planes[6];\n"
+            "uniform uint objectCount;\n"
+            "void main()\n"
+            "{\n"
+            "   uint i = gl_GlobalInvocationID.x;\n"
+            "   if (i >= objectCount)\n"
+            "       return;\n"
+            "   vec4 sphere = spheres[i];\n"
+            "   bool visible = true;\n"
+            "   for (int p = 0; p < 6; p++)\n"
+            "       visible = visible && dot(planes[p].xyz, sphere.xyz) + planes[p].w >= -sphere.w;\n"
+            "   Command command = sources[i];\n"
+            "   command.baseInstance = i;\n"
+            "#ifdef COMPACT\n"
+            "   if (visible)\n"
+            "       commands[atomicCounterIncrement(drawCount)] = command;\n"
+            "#else\n"
+            "   command.instanceCount = visible ? 1u : 0u;\n"
+            "   commands[i] = command;\n"
+            "#endif\n"
+            "}\n";
+        const char* code = source.c_str();
+        int success;
+        char infoLog[1024];
+        unsigned int shader = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(shader, 1, &code, NULL);
+        glCompileShader(shader);
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+            std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: COMPUTE\n" << infoLog << std::endl;
+        }
+        unsigned int cullProgram = glCreateProgram();
+        glAttachShader(cullProgram, shader);
+        glLinkProgram(cullProgram);
+        glGetProgramiv(cullProgram, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glGetProgramInfoLog(cullProgram, 1024, NULL, infoLog);
+            std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n" << infoLog << std::endl;
+        }
+        glDeleteShader(shader);
+        return cullProgram;
+    }
+};
+#endif
@@ -0,0 +1,389 @@
+#ifndef GPU_RESOURCES_H
+#define GPU_RESOURCES_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// the kinds of GL objects a GpuResourceRegistry keeps track of
+enum GpuResourceType
+{
+    GPU_BUFFER,
+    GPU_VERTEX_ARRAY,
+    GPU_TEXTURE,
+    GPU_PROGRAM,
+    GPU_RESOURCE_TYPE_COUNT
+};
+const char* const gpuResourceTypeNames[] = { "buffers", "vertex arrays", "textures", "programs" };
+
+class GpuResourceRegistry;
+
+// Owns one GL object: move-only, and the destructor (or reset()) hands the object to its registry, which deletes
+// it once the GPU is done with it. bytes() is what the object takes in video memory as far as the registry knows;
+// update it with setBytes() whenever the storage changes (see GpuBuffer::data and measureTextureBytes).
+// - A default constructed or moved from handle owns nothing and has ID 0.
+// - Release (or destroy) every handle before the registry's release(), while the context is still current.
+template <GpuResourceType TYPE>
+class GpuResource
+{
+public:
+    unsigned int ID; // the GL name; read only
+
+    GpuResource() : ID(0), registry(NULL), size(0)
+    {
+    }
+    GpuResource(GpuResourceRegistry& registry, unsigned int name);
+    ~GpuResource()
+    {
+        reset();
+    }
+    GpuResource(GpuResource&& other) : ID(other.ID), registry(other.registry), size(other.size)
+    {
+        other.ID = 0;
+        other.registry = NULL;
+        other.size = 0;
+    }
+    GpuResource& operator=(GpuResource&& other)
+    {
+        if (this != &other)
+        {
+            reset();
+            std::swap(ID, other.ID);
+            std::swap(registry, other.registry);
+            std::swap(size, other.size);
+        }
+        return *this;
+    }
+    GpuResource(const GpuResource&) = delete;
+    GpuResource& operator=(const GpuResource&) = delete;
+
+    // gives the object back to the registry for deferred deletion; the handle owns nothing afterwards
+    // ------------------------------------------------------------------------
+    void reset();
+    // ------------------------------------------------------------------------
+    void setBytes(size_t bytes);
+    // ------------------------------------------------------------------------
+    size_t bytes() const
+    {
+        return size;
+    }
+    // (re)allocates the storage of a buffer bound to target with glBufferData and records its size
+    // ------------------------------------------------------------------------
+    void data(GLenum target, size_t bytes, const void* data, GLenum usage)
+    {
+        static_assert(TYPE == GPU_BUFFER, "only buffers have data");
+        glBindBuffer(target, ID);
+        glBufferData(target, bytes, data, usage);
+        setBytes(bytes);
+    }
+
+private:
+    GpuResourceRegistry* registry;
+    size_t size;
+};
+typedef GpuResource<GPU_BUFFER> GpuBuffer;
+typedef GpuResource<GPU_VERTEX_ARRAY> GpuVertexArray;
+typedef GpuResource<GPU_TEXTURE> GpuTexture;
+typedef GpuResource<GPU_PROGRAM> GpuProgram;
+
+// live objects and their video memory of one GpuResourceType
+struct GpuResourceStats
+{
+    size_t count = 0;
+    size_t bytes = 0;
+    size_t peakBytes = 0;
+    size_t pendingCount = 0; // released, waiting for the GPU to finish with them
+    size_t pendingBytes = 0;
+    unsigned long deleted = 0;
+};
+
+// Creates GL objects as GpuResource handles and deletes them for the handles, a few frames late.
+// - Deleting (or reallocating) an object a frame in flight still reads makes the driver either wait for the
+//   GPU or keep a copy around. A released object therefore goes into the batch of the current frame instead;
+//   endFrame() puts a glFenceSync behind every batch, and its objects are deleted once the fence signaled and
+//   at least retireFrames frames have passed, so deleting never waits for anything.
+// - Counts the objects and their bytes per type, including the ones waiting for deletion, which the driver
+//   still holds. Above the optional budget (setBudget) the registry reports an error once, until the total
+//   drops below it again; report() prints everything.
+// - The pending batches and their lists are reused, so a steady stream of releases does not allocate.
+// - Needs a GL 3.2 context (or ARB_sync) for the fences.
+class GpuResourceRegistry
+{
+public:
+    GpuResourceStats stats[GPU_RESOURCE_TYPE_COUNT];
+
+    GpuResourceRegistry(unsigned int retireFrames = 2) : retireFrames(retireFrames), frame(0), budget(0), overBudget(false)
+    {
+    }
+    GpuResourceRegistry(const GpuResourceRegistry&) = delete;
+    GpuResourceRegistry& operator=(const GpuResourceRegistry&) = delete;
+
+    // ------------------------------------------------------------------------
+    GpuBuffer createBuffer()
+    {
+        unsigned int name;
+        glGenBuffers(1, &name);
+        return GpuBuffer(*this, name);
+    }
+    // ------------------------------------------------------------------------
+    GpuVertexArray createVertexArray()
+    {
+        unsigned int name;
+        glGenVertexArrays(1, &name);
+        return GpuVertexArray(*this, name);
+    }
+    // ------------------------------------------------------------------------
+    GpuTexture createTexture()
+    {
+        unsigned int name;
+        glGenTextures(1, &name);
+        return GpuTexture(*this, name);
+    }
+    // takes over an object made elsewhere (a loader, a Shader); a name of 0 gives an empty handle
+    // ------------------------------------------------------------------------
+    template <GpuResourceType TYPE>
+    GpuResource<TYPE> adopt(unsigned int name, size_t bytes = 0)
+    {
+        if (name == 0)
+            return GpuResource<TYPE>();
+        GpuResource<TYPE> resource(*this, name);
+        resource.setBytes(bytes);
+        return resource;
+    }
+    // the video memory above which the registry reports an error, 0 for none
+    // ------------------------------------------------------------------------
+    void setBudget(size_t bytes)
+    {
+        budget = bytes;
+        checkBudget();
+    }
+    // fences the objects released this frame and deletes the ones the GPU is done with; call it once per frame,
+    // after the frame's last draw call
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        if (!current.objects.empty())
+        {
+            current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            current.frame = frame;
+            inFlight.push_back(Batch());
+            std::swap(inFlight.back(), current);
+            if (!spare.empty())
+            {
+                std::swap(current, spare.back());
+                spare.pop_back();
+            }
+        }
+        frame++;
+        // the batches are in submission order, so the first one that is not done ends the search
+        size_t retired = 0;
+        while (retired < inFlight.size() && frame >= inFlight[retired].frame + retireFrames)
+        {
+            GLenum status = glClientWaitSync(inFlight[retired].fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            deleteBatch(inFlight[retired]);
+            retired++;
+        }
+        if (retired > 0)
+        {
+            for (size_t i = 0; i < retired; i++)
+                spare.push_back(std::move(inFlight[i]));
+            inFlight.erase(inFlight.begin(), inFlight.begin() + retired);
+        }
+    }
+    // deletes everything still waiting, after the GPU finished; the handles have to be gone already
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        if (!current.objects.empty())
+        {
+            current.fence = 0;
+            inFlight.push_back(std::move(current));
+            current.objects.clear();
+        }
+        if (!inFlight.empty())
+            glFinish();
+        for (size_t i = 0; i < inFlight.size(); i++)
+            deleteBatch(inFlight[i]);
+        inFlight.clear();
+        spare.clear();
+        for (int type = 0; type < GPU_RESOURCE_TYPE_COUNT; type++)
+            if (stats[type].count > 0)
+                std::cout << "ERROR::GPU_RESOURCES::LEAK: " << stats[type].count << " " << gpuResourceTypeNames[type] << " still have a handle" << std::endl;
+    }
+    // video memory of every live object, plus what waits for deletion
+    // ------------------------------------------------------------------------
+    size_t totalBytes() const
+    {
+        size_t total = 0;
+        for (int type = 0; type < GPU_RESOURCE_TYPE_COUNT; type++)
+            total += stats[type].bytes + stats[type].pendingBytes;
+        return total;
+    }
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout) const
+    {
+        for (int type = 0; type < GPU_RESOURCE_TYPE_COUNT; type++)
+        {
+            const GpuResourceStats& s = stats[type];
+            out << "GPU " << gpuResourceTypeNames[type] << ": " << s.count << " live, " << s.bytes / 1024.0 << " KB (peak "
+                << s.peakBytes / 1024.0 << " KB), " << s.pendingCount << " pending deletion, " << s.deleted << " deleted" << std::endl;
+        }
+        out << "GPU memory: " << totalBytes() / (1024.0 * 1024.0) << " MB";
+        if (budget > 0)
+            out << " of a " << budget / (1024.0 * 1024.0) << " MB budget";
+        out << std::endl;
+    }
+
+private:
+    template <GpuResourceType TYPE>
+    friend class GpuResource;
+
+    struct PendingObject
+    {
+        GpuResourceType type;
+        unsigned int name;
+        size_t bytes;
+    };
+    struct Batch
+    {
+        GLsync fence = 0;
+        unsigned long frame = 0;
+        std::vector<PendingObject> objects;
+    };
+
+    unsigned int retireFrames;
+    unsigned long frame;
+    size_t budget;
+    bool overBudget;
+    Batch current;               // released this frame
+    std::vector<Batch> inFlight; // fenced, oldest first
+    std::vector<Batch> spare;    // retired batches whose lists are reused
+
+    // ------------------------------------------------------------------------
+    void added(GpuResourceType type)
+    {
+        stats[type].count++;
+    }
+    // ------------------------------------------------------------------------
+    void resized(GpuResourceType type, size_t oldBytes, size_t newBytes)
+    {
+        GpuResourceStats& s = stats[type];
+        s.bytes = s.bytes - oldBytes + newBytes;
+        s.peakBytes = std::max(s.peakBytes, s.bytes);
+        checkBudget();
+    }
+    // ------------------------------------------------------------------------
+    void released(GpuResourceType type, unsigned int name, size_t bytes)
+    {
+        GpuResourceStats& s = stats[type];
+        s.count--;
+        s.bytes -= bytes;
+        s.pendingCount++;
+        s.pendingBytes += bytes;
+        current.objects.push_back(PendingObject{ type, name, bytes });
+    }
+    // ------------------------------------------------------------------------
+    void deleteBatch(Batch& batch)
+    {
+        for (size_t i = 0; i < batch.objects.size(); i++)
+        {
+            const PendingObject& object = batch.objects[i];
+            switch (object.type)
+            {
+            case GPU_BUFFER: glDeleteBuffers(1, &object.name); break;
+            case GPU_VERTEX_ARRAY: glDeleteVertexArrays(1, &object.name); break;
+            case GPU_TEXTURE: glDeleteTextures(1, &object.name); break;
+            case GPU_PROGRAM: glDeleteProgram(object.name); break;
+            default: break;
+            }
+            GpuResourceStats& s = stats[object.type];
+            s.pendingCount--;
+            s.pendingBytes -= object.bytes;
+            s.deleted++;
+        }
+        batch.objects.clear();
+        if (batch.fence)
+            glDeleteSync(batch.fence);
+        batch.fence = 0;
+        checkBudget();
+    }
+    // ------------------------------------------------------------------------
+    void checkBudget()
+    {
+        bool over = budget > 0 && totalBytes() > budget;
+        if (over && !overBudget)
+            std::cout << "ERROR::GPU_RESOURCES::OVER_BUDGET: " << totalBytes() / (1024.0 * 1024.0) << " MB of "
+                      << budget / (1024.0 * 1024.0) << " MB in use" << std::endl;
+        overBudget = over;
+    }
+};
+
+// ------------------------------------------------------------------------
+template <GpuResourceType TYPE>
+GpuResource<TYPE>::GpuResource(GpuResourceRegistry& registry, unsigned int name) : ID(name), registry(&registry), size(0)
+{
+    registry.added(TYPE);
+}
+// ------------------------------------------------------------------------
+template <GpuResourceType TYPE>
+void GpuResource<TYPE>::reset()
+{
+    if (registry && ID != 0)
+        registry->released(TYPE, ID, size);
+    ID = 0;
+    registry = NULL;
+    size = 0;
+}
+// ------------------------------------------------------------------------
+template <GpuResourceType TYPE>
+void GpuResource<TYPE>::setBytes(size_t bytes)
+{
+    if (registry)
+        registry->resized(TYPE, size, bytes);
+    size = bytes;
+}
+
+// the video memory of a texture, all its mip levels and layers, from what the driver reports for it; binds the
+// texture to target on the active unit. Every level is looked at, not only the ones up to the first empty one:
+// a TextureResidency texture has its fine levels respecified empty (level 0 included) while its tail is resident
+// ------------------------------------------------------------------------
+inline size_t measureTextureBytes(unsigned int texture, GLenum target = GL_TEXTURE_2D)
+{
+    glBindTexture(target, texture);
+    size_t bytes = 0;
+    for (int level = 0; level < 16; level++)
+    {
+        GLint width = 0, height = 0, depth = 0, compressed = 0;
+        glGetTexLevelParameteriv(target, level, GL_TEXTURE_WIDTH, &width);
+        if (width == 0)
+            continue;
+        glGetTexLevelParameteriv(target, level, GL_TEXTURE_HEIGHT, &height);
+        glGetTexLevelParameteriv(target, level, GL_TEXTURE_DEPTH, &depth);
+        glGetTexLevelParameteriv(target, level, GL_TEXTURE_COMPRESSED, &compressed);
+        if (compressed)
+        {
+            GLint imageSize = 0;
+            glGetTexLevelParameteriv(target, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &imageSize);
+            bytes += imageSize;
+            continue;
+        }
+        GLint bits = 0;
+        const GLenum sizes[] = { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE, GL_TEXTURE_ALPHA_SIZE,
+                                 GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE };
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        {
+            GLint componentBits = 0;
+            glGetTexLevelParameteriv(target, level, sizes[i], &componentBits);
+            bits += componentBits;
+        }
+        bytes += (size_t)width * std::max(height, 1) * std::max(depth, 1) * ((bits + 7) / 8);
+    }
+    return bytes;
+}
+#endif
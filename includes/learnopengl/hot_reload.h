@@ -0,0 +1,324 @@
+#ifndef HOT_RELOAD_H
+#define HOT_RELOAD_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/program_cache.h>
+#include <learnopengl/shader_batch.h>
+#include <learnopengl/shader_s.h>
+#include <learnopengl/shader_variants.h>
+#include <learnopengl/texture_streamer.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Watches a set of files on a background thread and reports the ones that changed.
+// - On Linux the thread waits on inotify for writes and renames in the directories of the files (editors often
+//   save by writing a new file and renaming it over the old one). Elsewhere, or if inotify is unavailable, it
+//   compares the modification times of the files every POLL_INTERVAL_MS instead.
+// - Editors write a file in several steps, so a change is only reported once the file has been quiet for
+//   debounceMs; one save becomes one reload.
+class FileWatcher
+{
+public:
+    static constexpr int POLL_INTERVAL_MS = 100;
+
+    FileWatcher(int debounceMs = 150) : debounceMs(debounceMs), stopping(false), inotifyFd(-1)
+    {
+#ifdef __linux__
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+        thread = std::thread(&FileWatcher::watchLoop, this);
+    }
+    ~FileWatcher()
+    {
+        stopping = true;
+        thread.join();
+#ifdef __linux__
+        if (inotifyFd >= 0)
+            close(inotifyFd);
+#endif
+    }
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // starts watching a file; changes() reports it under the same path
+    // ------------------------------------------------------------------------
+    void watch(const std::string& path)
+    {
+        std::error_code error;
+        std::filesystem::path absolute = std::filesystem::absolute(path, error).lexically_normal();
+        std::lock_guard<std::mutex> lock(mutex);
+        WatchedFile& file = files[absolute.string()];
+        file.path = path;
+        file.modified = std::filesystem::last_write_time(absolute, error);
+#ifdef __linux__
+        if (inotifyFd >= 0)
+        {
+            std::string directory = absolute.parent_path().string();
+            int descriptor = inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (descriptor >= 0)
+                directories[descriptor] = directory;
+        }
+#endif
+    }
+    // returns the files that changed and have been quiet for the debounce time since, each once per change
+    // ------------------------------------------------------------------------
+    std::vector<std::string> changes()
+    {
+        std::vector<std::string> settled;
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::map<std::string, WatchedFile>::iterator it = files.begin(); it != files.end(); ++it)
+        {
+            WatchedFile& file = it->second;
+            if (file.changed && now - file.lastEvent >= std::chrono::milliseconds(debounceMs))
+            {
+                file.changed = false;
+                settled.push_back(file.path);
+            }
+        }
+        return settled;
+    }
+
+private:
+    struct WatchedFile
+    {
+        std::string path; // as passed to watch()
+        std::filesystem::file_time_type modified;
+        std::chrono::steady_clock::time_point lastEvent;
+        bool changed = false;
+    };
+
+    int debounceMs;
+    std::atomic<bool> stopping;
+    int inotifyFd;
+    std::thread thread;
+    std::mutex mutex;
+    std::map<std::string, WatchedFile> files; // by absolute path
+    std::map<int, std::string> directories;   // inotify watch descriptor -> directory
+
+    // ------------------------------------------------------------------------
+    void markChanged(const std::string& absolute)
+    {
+        std::map<std::string, WatchedFile>::iterator it = files.find(absolute);
+        if (it == files.end())
+            return;
+        std::error_code error;
+        it->second.modified = std::filesystem::last_write_time(absolute, error);
+        it->second.lastEvent = std::chrono::steady_clock::now();
+        it->second.changed = true;
+    }
+    // background thread: collect change events until the watcher is destroyed
+    // ------------------------------------------------------------------------
+    void watchLoop()
+    {
+        while (!stopping)
+        {
+#ifdef __linux__
+            if (inotifyFd >= 0)
+            {
+                pollfd descriptor = { inotifyFd, POLLIN, 0 };
+                if (::poll(&descriptor, 1, POLL_INTERVAL_MS) <= 0)
+                    continue;
+                alignas(inotify_event) char buffer[4096];
+                ssize_t length;
+                while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    for (char* p = buffer; p < buffer + length;)
+                    {
+                        const inotify_event* event = (const inotify_event*)p;
+                        std::map<int, std::string>::iterator directory = directories.find(event->wd);
+                        if (event->len > 0 && directory != directories.end())
+                            markChanged((std::filesystem::path(directory->second) / event->name).string());
+                        p += sizeof(inotify_event) + event->len;
+                    }
+                }
+                continue;
+            }
+#endif
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::map<std::string, WatchedFile>::iterator it = files.begin(); it != files.end(); ++it)
+            {
+                std::error_code error;
+                std::filesystem::file_time_type modified = std::filesystem::last_write_time(it->first, error);
+                if (!error && modified != it->second.modified)
+                    markChanged(it->first);
+            }
+        }
+    }
+};
+
+// Reloads shaders and textures while the sample runs, when their files are saved.
+// - Only what depends on a changed file is rebuilt: every program that uses it is recompiled through a
+//   ShaderBatch (on the driver's compiler threads with KHR_parallel_shader_compile), every texture loaded from
+//   it is decoded again on the TextureStreamer's workers. Nothing here blocks the render loop.
+// - update(), called once per frame before drawing, swaps finished programs into their Shader objects, so a
+//   frame never mixes the old and the new program. A program that fails to compile or link is dropped with its
+//   log, and the old one keeps running; fix the file and save again.
+// - A texture keeps its GL name, its contents are replaced when the streamer uploads the new image, so every
+//   reference to it stays valid. Only images stb_image can decode are reloaded, and not textures with immutable
+//   storage (from glTexStorage or with a bindless handle).
+// - The GL name of a reloaded program changes; code that keeps Shader::ID elsewhere (a GLState, a DrawItem)
+//   picks the new one up through the Shader.
+class HotReloader
+{
+public:
+    int reloads = 0; // programs and textures swapped in so far
+
+    HotReloader(ProgramCache* cache = NULL, TextureStreamer* streamer = NULL) : batch(cache), streamer(streamer)
+    {
+    }
+
+    // recompiles shader whenever one of its files changes; defines (see ShaderVariants::defineHeader) are inserted
+    // after the #version line of both sources, as for the variant the shader was built as
+    // ------------------------------------------------------------------------
+    void watchShader(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath, const std::string& defines = "")
+    {
+        ShaderWatch watch;
+        watch.shader = &shader;
+        watch.vertexPath = vertexPath;
+        watch.fragmentPath = fragmentPath;
+        watch.defines = defines;
+        shaders.push_back(watch);
+        watcher.watch(vertexPath);
+        watcher.watch(fragmentPath);
+    }
+    // re-uploads texture whenever its image file changes; needs the TextureStreamer passed to the constructor
+    // ------------------------------------------------------------------------
+    void watchTexture(unsigned int texture, const std::string& path)
+    {
+        if (!streamer)
+        {
+            std::cout << "ERROR::HOT_RELOAD::NO_TEXTURE_STREAMER: " << path << std::endl;
+            return;
+        }
+        TextureWatch watch = { texture, path };
+        textures.push_back(watch);
+        watcher.watch(path);
+    }
+    // starts rebuilding whatever changed and swaps in the programs that finished; returns the number of programs
+    // swapped in, so a caller with a GLState knows to invalidate it. Call once per frame, before drawing.
+    // ------------------------------------------------------------------------
+    int update()
+    {
+        std::vector<std::string> changed = watcher.changes();
+        for (size_t c = 0; c < changed.size(); c++)
+        {
+            for (size_t i = 0; i < shaders.size(); i++)
+            {
+                ShaderWatch& watch = shaders[i];
+                if (watch.vertexPath != changed[c] && watch.fragmentPath != changed[c])
+                    continue;
+                std::string vertexSource, fragmentSource;
+                if (!readFile(watch.vertexPath, vertexSource) || !readFile(watch.fragmentPath, fragmentSource))
+                    continue;
+                // a newer save supersedes a compile that is still running; it is deleted once the batch finishes it
+                if (watch.pending >= 0)
+                    superseded.push_back(watch.pending);
+                watch.pending = batch.submit(injectShaderDefines(vertexSource, watch.defines), injectShaderDefines(fragmentSource, watch.defines));
+                std::cout << "hot reload: recompiling " << watch.vertexPath << " + " << watch.fragmentPath << std::endl;
+            }
+            for (size_t i = 0; i < textures.size(); i++)
+            {
+                if (textures[i].path != changed[c])
+                    continue;
+                streamer->reload(textures[i].texture, textures[i].path);
+                reloads++;
+                std::cout << "hot reload: reloading " << textures[i].path << std::endl;
+            }
+        }
+
+        int swapped = 0;
+        batch.poll();
+        for (size_t i = 0; i < superseded.size();)
+        {
+            if (!batch.ready(superseded[i]))
+            {
+                i++;
+                continue;
+            }
+            unsigned int program = batch.take(superseded[i]);
+            if (program != 0)
+                glDeleteProgram(program);
+            superseded.erase(superseded.begin() + i);
+        }
+        for (size_t i = 0; i < shaders.size(); i++)
+        {
+            ShaderWatch& watch = shaders[i];
+            if (watch.pending < 0 || !batch.ready(watch.pending))
+                continue;
+            unsigned int program = batch.take(watch.pending);
+            watch.pending = -1;
+            if (program == 0)
+            {
+                std::cout << "hot reload: " << watch.fragmentPath << " failed, keeping the previous program" << std::endl;
+                continue;
+            }
+            glDeleteProgram(watch.shader->ID);
+            *watch.shader = Shader(program);
+            swapped++;
+            reloads++;
+        }
+        return swapped;
+    }
+    // deletes the programs still being recompiled; call before the context is destroyed
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        batch.release();
+        superseded.clear();
+        for (size_t i = 0; i < shaders.size(); i++)
+            shaders[i].pending = -1;
+    }
+
+private:
+    struct ShaderWatch
+    {
+        Shader* shader;
+        std::string vertexPath, fragmentPath, defines;
+        int pending = -1; // ShaderBatch handle of the compile in flight
+    };
+    struct TextureWatch
+    {
+        unsigned int texture;
+        std::string path;
+    };
+
+    FileWatcher watcher;
+    ShaderBatch batch;
+    TextureStreamer* streamer;
+    std::vector<ShaderWatch> shaders;
+    std::vector<TextureWatch> textures;
+    std::vector<int> superseded; // ShaderBatch handles of compiles a newer save replaced
+
+    // ------------------------------------------------------------------------
+    static bool readFile(const std::string& path, std::string& data)
+    {
+        std::ifstream file(path.c_str());
+        if (!file)
+            return false;
+        std::stringstream stream;
+        stream << file.rdbuf();
+        data = stream.str();
+        return true;
+    }
+};
+#endif
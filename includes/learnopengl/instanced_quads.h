@@ -0,0 +1,140 @@
+#ifndef INSTANCED_QUADS_H
+#define INSTANCED_QUADS_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/job_system.h>
+
+#include <cstddef>
+#include <vector>
+
+// per-instance data of one quad: a 2D transform, a tint and the rectangle of the texture it shows
+struct QuadInstance
+{
+    float offset[2];   // position of the quad center, in normalized device coordinates
+    float scale[2];
+    float rotation;    // radians
+    float tint[4];     // multiplied with the texture color
+    float uvRect[4];   // u, v, width, height of the texture area mapped onto the quad
+    float layer;       // array texture layer, for a TextureAtlas (ignored by a GL_TEXTURE_2D)
+};
+
+// Draws any number of textured quads with one glDrawElementsInstanced call.
+// - It is built on an existing quad VAO/EBO (like the one in perf_playground.cpp): the constructor adds an instance
+//   buffer to that VAO, with glVertexAttribDivisor(location, 1) so its attributes advance once per quad
+//   instead of once per vertex. The vertex shader (perf_playground_instanced.vs) reads them from
+//   firstLocation onwards: offset/scale, rotation, tint, uvRect and layer.
+// - Fill in instances, call upload() whenever they change, then draw().
+class InstancedQuads
+{
+public:
+    std::vector<QuadInstance> instances;
+
+    InstancedQuads(unsigned int VAO, unsigned int firstLocation = 3) : VAO(VAO), capacity(0)
+    {
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        const GLsizei stride = sizeof(QuadInstance);
+        // offset and scale share a vec4, the others get one attribute each
+        glVertexAttribPointer(firstLocation, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadInstance, offset));
+        glVertexAttribPointer(firstLocation + 1, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadInstance, rotation));
+        glVertexAttribPointer(firstLocation + 2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadInstance, tint));
+        glVertexAttribPointer(firstLocation + 3, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadInstance, uvRect));
+        glVertexAttribPointer(firstLocation + 4, 1, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(QuadInstance, layer));
+        for (unsigned int i = 0; i < 5; i++)
+        {
+            glEnableVertexAttribArray(firstLocation + i);
+            glVertexAttribDivisor(firstLocation + i, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // copies instances into the instance buffer; the buffer only grows, and is orphaned when it is refilled
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (instances.size() > capacity)
+        {
+            capacity = instances.size();
+            glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(QuadInstance), instances.data(), GL_DYNAMIC_DRAW);
+        }
+        else
+        {
+            glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(QuadInstance), NULL, GL_DYNAMIC_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(QuadInstance), instances.data());
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        uploaded = instances.size();
+    }
+    // draws every uploaded instance; the program and texture have to be bound already
+    // ------------------------------------------------------------------------
+    void draw(GLsizei indexCount = 6)
+    {
+        if (uploaded == 0)
+            return;
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, (GLsizei)uploaded);
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteBuffers(1, &instanceVBO);
+        instanceVBO = 0;
+    }
+
+private:
+    unsigned int VAO;
+    unsigned int instanceVBO;
+    size_t capacity;
+    size_t uploaded = 0;
+};
+
+// writes quads [begin, end) of a grid of side x side quads covering the screen, with a rainbow tint
+// ------------------------------------------------------------------------
+inline void fillQuadGridRange(std::vector<QuadInstance>& instances, size_t side, size_t begin, size_t end)
+{
+    float size = 2.0f / side;
+    for (size_t i = begin; i < end; i++)
+    {
+        QuadInstance& quad = instances[i];
+        size_t x = i % side, y = i / side;
+        quad.offset[0] = -1.0f + (x + 0.5f) * size;
+        quad.offset[1] = -1.0f + (y + 0.5f) * size;
+        quad.scale[0] = quad.scale[1] = size * 0.9f;
+        quad.rotation = 0.0f;
+        quad.tint[0] = (float)x / side;
+        quad.tint[1] = (float)y / side;
+        quad.tint[2] = 1.0f - (float)x / side;
+        quad.tint[3] = 1.0f;
+        quad.uvRect[0] = quad.uvRect[1] = 0.0f;
+        quad.uvRect[2] = quad.uvRect[3] = 1.0f;
+        quad.layer = 0.0f;
+    }
+}
+// ------------------------------------------------------------------------
+inline size_t quadGridSide(size_t count)
+{
+    size_t side = 1;
+    while (side * side < count)
+        side++;
+    return side;
+}
+// fills instances with count quads laid out in a square grid covering the screen, with a rainbow tint, for stress tests
+// ------------------------------------------------------------------------
+inline void fillQuadGrid(std::vector<QuadInstance>& instances, size_t count)
+{
+    instances.resize(count);
+    fillQuadGridRange(instances, quadGridSide(count), 0, count);
+}
+// the same, with the quads written on every thread of jobs
+// ------------------------------------------------------------------------
+inline void fillQuadGrid(std::vector<QuadInstance>& instances, size_t count, JobSystem& jobs)
+{
+    instances.resize(count);
+    size_t side = quadGridSide(count);
+    jobs.parallelFor(0, count, 16384, [&](size_t begin, size_t end) { fillQuadGridRange(instances, side, begin, end); });
+}
+#endif
@@ -0,0 +1,464 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <learnopengl/frame_allocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+
+// a job to run, and the counter it signals when it is done. The range jobs of parallelFor() call
+// invoke(body, begin, end) instead of task, which would allocate for captures of more than two pointers.
+struct Job
+{
+    std::function<void()> task;
+    void (*invoke)(const void* body, size_t begin, size_t end);
+    const void* body;
+    size_t begin, end;
+    struct JobCounter* counter;
+    int subsystem; // the AllocationScope of the thread that submitted the job
+    int pool;      // the worker whose pool the job came from, -1 for the pool of the other threads
+    Job* nextReturned;
+};
+
+// Counts the jobs of a group that have not finished yet. JobSystem::wait() waits for it to reach zero, and jobs
+// submitted with it as their dependency only start once it did. A counter can be reused, or destroyed, once
+// wait() returned for it.
+struct JobCounter
+{
+    std::atomic<int> value;
+
+    JobCounter() : value(0)
+    {
+    }
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    // ------------------------------------------------------------------------
+    bool done() const
+    {
+        return value.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    friend class JobSystem;
+    std::mutex mutex;
+    std::vector<Job*> continuations; // jobs waiting for the counter to reach zero
+
+    // queues job to run once the counter is zero; returns false if it is zero already
+    // ------------------------------------------------------------------------
+    bool defer(Job* job)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (done())
+            return false;
+        continuations.push_back(job);
+        return true;
+    }
+    // counts a finished job; returns the jobs that were waiting if it was the last one. The decrement happens under
+    // the lock, so a JobSystem::wait() that saw zero and takes the lock once knows the counter is no longer used.
+    // ------------------------------------------------------------------------
+    std::vector<Job*> finish()
+    {
+        std::vector<Job*> ready;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            ready.swap(continuations);
+        return ready;
+    }
+};
+
+// The Chase-Lev work-stealing deque: its owner thread pushes and pops jobs at the bottom without locks, every other
+// thread steals from the top, so the owner works depth first on what it just spawned and thieves take the oldest
+// (usually the largest) jobs. The capacity is fixed; push() returns false when it is full.
+class WorkStealingDeque
+{
+public:
+    WorkStealingDeque(size_t capacity = 4096) : top(0), bottom(0), mask(capacity - 1), buffer(new std::atomic<Job*>[capacity])
+    {
+    }
+
+    // owner only
+    // ------------------------------------------------------------------------
+    bool push(Job* job)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t > (int64_t)mask)
+            return false;
+        buffer[b & mask].store(job, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release); // publishes the job to the thieves
+        return true;
+    }
+    // owner only; the most recently pushed job, or NULL
+    // ------------------------------------------------------------------------
+    Job* pop()
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return NULL;
+        }
+        Job* job = buffer[b & mask].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // the last job: race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = NULL;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+    // any thread; the oldest job, or NULL if there is none or another thread got it first
+    // ------------------------------------------------------------------------
+    Job* steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return NULL;
+        Job* job = buffer[t & mask].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return NULL;
+        return job;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top;
+    alignas(64) std::atomic<int64_t> bottom;
+    size_t mask;
+    std::unique_ptr<std::atomic<Job*>[]> buffer;
+};
+
+// Runs the CPU work of a frame (culling, draw list building, instance updates, image decoding) on every core.
+// - One worker thread per core, less the thread that creates the JobSystem, which counts as worker 0: its wait()
+//   and parallelFor() run jobs too instead of blocking. Each worker has a WorkStealingDeque; a worker without
+//   jobs of its own steals from a random other one, and sleeps once there is nothing left anywhere.
+// - Jobs submitted from any other thread (e.g. a RenderThread) go through a locked queue.
+// - run() takes a JobCounter to signal and optionally one to wait for, so a job can depend on a whole group
+//   (e.g. build the draw list after every instance was culled) without blocking a thread on it.
+// - Jobs must not block on each other except through wait(), which keeps running jobs meanwhile.
+// - The jobs come from an ObjectPool per worker, which only that worker touches, so creating and destroying a job
+//   takes no lock; a job that ran on another thread goes back to its owner through a lock-free stack. What the
+//   jobs allocate is counted under the AllocationScope of the thread that submitted them, so a parallelFor() in
+//   the render loop allocates nothing once the pools are large enough.
+class JobSystem
+{
+public:
+    // threadCount 0 uses every core, the creating thread included
+    // ------------------------------------------------------------------------
+    JobSystem(unsigned int threadCount = 0)
+        : stopping(false), queued(0), sleepers(0), owner(std::this_thread::get_id()), sharedPool(JOB_POOL_BLOCK, "job system")
+    {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < threadCount; i++)
+        {
+            deques.push_back(std::unique_ptr<WorkStealingDeque>(new WorkStealingDeque()));
+            pools.push_back(std::unique_ptr<JobPool>(new JobPool()));
+        }
+        for (unsigned int i = 1; i < threadCount; i++)
+            workers.push_back(std::thread(&JobSystem::workerLoop, this, (int)i));
+    }
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        for (size_t i = 0; i < pools.size(); i++)
+            recycleReturned(*pools[i]);
+    }
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // the number of threads that run jobs, the creating thread included
+    // ------------------------------------------------------------------------
+    unsigned int threadCount() const
+    {
+        return (unsigned int)deques.size();
+    }
+    // schedules task; counter (if any) is incremented now and decremented when the task is done, and with after
+    // the task only starts once that counter reached zero
+    // ------------------------------------------------------------------------
+    void run(std::function<void()> task, JobCounter* counter = NULL, JobCounter* after = NULL)
+    {
+        Job* job = createJob();
+        job->task = std::move(task);
+        job->counter = counter;
+        if (counter)
+            counter->value.fetch_add(1, std::memory_order_relaxed);
+        if (after && after->defer(job))
+            return;
+        submit(job);
+    }
+    // runs jobs until counter reaches zero
+    // ------------------------------------------------------------------------
+    void wait(JobCounter& counter)
+    {
+        int index = workerIndex();
+        while (!counter.done())
+        {
+            Job* job = findJob(index);
+            if (job)
+                execute(job);
+            else
+                std::this_thread::yield();
+        }
+        // the job that brought it to zero may still hold its lock
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+    // calls body(rangeBegin, rangeEnd) for consecutive ranges of at most grain elements covering [begin, end) on
+    // every thread, and returns once all of them are done
+    // ------------------------------------------------------------------------
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, const Body& body)
+    {
+        grain = std::max<size_t>(grain, 1);
+        if (end - begin <= grain || threadCount() == 1)
+        {
+            if (begin < end)
+                body(begin, end);
+            return;
+        }
+        JobCounter counter;
+        for (size_t rangeBegin = begin + grain; rangeBegin < end; rangeBegin += grain)
+        {
+            Job* job = createJob();
+            job->invoke = [](const void* body, size_t rangeBegin, size_t rangeEnd) { (*static_cast<const Body*>(body))(rangeBegin, rangeEnd); };
+            job->body = &body;
+            job->begin = rangeBegin;
+            job->end = std::min(end, rangeBegin + grain);
+            job->counter = &counter;
+            counter.value.fetch_add(1, std::memory_order_relaxed);
+            submit(job);
+        }
+        // the first range runs right here while the others are stolen
+        body(begin, std::min(end, begin + grain));
+        wait(counter);
+    }
+
+private:
+    static const size_t JOB_POOL_BLOCK = 1024;
+
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping;
+    std::atomic<int> queued; // jobs in the deques and the shared queue
+    std::atomic<int> sleepers;
+    std::thread::id owner;
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::mutex sharedMutex;
+    std::deque<Job*> shared; // jobs submitted by threads that are not workers
+    // the jobs created by one worker; a job that finished on another thread is pushed onto returned, which the
+    // owner empties into its pool the next time it creates a job
+    struct JobPool
+    {
+        ObjectPool<Job> jobs;
+        alignas(64) std::atomic<Job*> returned;
+
+        JobPool() : jobs(JOB_POOL_BLOCK, "job system"), returned(NULL)
+        {
+        }
+    };
+    std::vector<std::unique_ptr<JobPool>> pools; // one per worker
+    std::mutex sharedPoolMutex;
+    ObjectPool<Job> sharedPool; // the jobs created by threads that are not workers
+
+    // the worker index of the calling thread, -1 for threads that are not workers of this JobSystem
+    // ------------------------------------------------------------------------
+    int workerIndex()
+    {
+        if (currentSystem() == this)
+            return currentIndex();
+        return std::this_thread::get_id() == owner ? 0 : -1;
+    }
+    static JobSystem*& currentSystem()
+    {
+        static thread_local JobSystem* system = NULL;
+        return system;
+    }
+    static int& currentIndex()
+    {
+        static thread_local int index = -1;
+        return index;
+    }
+    // a job without a task, tagged with the caller's AllocationScope
+    // ------------------------------------------------------------------------
+    Job* createJob()
+    {
+        int index = workerIndex();
+        Job* job;
+        if (index < 0)
+        {
+            std::lock_guard<std::mutex> lock(sharedPoolMutex);
+            job = sharedPool.create();
+        }
+        else
+        {
+            recycleReturned(*pools[index]);
+            job = pools[index]->jobs.create();
+        }
+        job->pool = index;
+        job->invoke = NULL;
+        job->counter = NULL;
+        job->subsystem = AllocationTracker::current();
+        return job;
+    }
+    // destructs job; its slot goes back to the pool it came from, right away if that is the caller's own
+    // ------------------------------------------------------------------------
+    void destroyJob(Job* job)
+    {
+        if (job->pool < 0)
+        {
+            std::lock_guard<std::mutex> lock(sharedPoolMutex);
+            sharedPool.destroy(job);
+        }
+        else if (job->pool == workerIndex())
+            pools[job->pool]->jobs.destroy(job);
+        else
+        {
+            // the task (and what it captured) goes now, the slot once its owner recycles it
+            job->task = nullptr;
+            JobPool& pool = *pools[job->pool];
+            job->nextReturned = pool.returned.load(std::memory_order_relaxed);
+            while (!pool.returned.compare_exchange_weak(job->nextReturned, job, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+    // owner only: puts the jobs other threads handed back into the pool. The owner takes the whole stack at once,
+    // so the pushes never race a pop of a single node (no ABA).
+    // ------------------------------------------------------------------------
+    void recycleReturned(JobPool& pool)
+    {
+        Job* job = pool.returned.exchange(NULL, std::memory_order_acquire);
+        while (job)
+        {
+            Job* next = job->nextReturned;
+            pool.jobs.destroy(job);
+            job = next;
+        }
+    }
+    // ------------------------------------------------------------------------
+    void submit(Job* job)
+    {
+        int index = workerIndex();
+        if (index < 0)
+        {
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            shared.push_back(job);
+        }
+        else if (!deques[index]->push(job))
+        {
+            // the deque is full: nothing is lost by running the job right away
+            execute(job);
+            return;
+        }
+        // sequentially consistent, like the sleeper count and the check in workerLoop(): either this sees the
+        // sleeper or the sleeper sees the job, so a worker never sleeps through a job
+        queued.fetch_add(1);
+        if (sleepers.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wakeUp.notify_one();
+        }
+    }
+    // ------------------------------------------------------------------------
+    Job* findJob(int index)
+    {
+        if (queued.load(std::memory_order_acquire) <= 0)
+            return NULL;
+        Job* job = index >= 0 ? deques[index]->pop() : NULL;
+        if (!job)
+        {
+            std::lock_guard<std::mutex> lock(sharedMutex);
+            if (!shared.empty())
+            {
+                job = shared.front();
+                shared.pop_front();
+            }
+        }
+        // steal, starting at a different victim every time
+        static thread_local unsigned int seed = 0x9E3779B9u ^ (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id());
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        for (size_t i = 0; !job && i < deques.size(); i++)
+        {
+            size_t victim = (seed + i) % deques.size();
+            if ((int)victim != index)
+                job = deques[victim]->steal();
+        }
+        if (job)
+            queued.fetch_sub(1, std::memory_order_relaxed);
+        return job;
+    }
+    // ------------------------------------------------------------------------
+    void execute(Job* job)
+    {
+        {
+            AllocationScope scope(job->subsystem);
+            if (job->invoke)
+                job->invoke(job->body, job->begin, job->end);
+            else
+                job->task();
+        }
+        JobCounter* counter = job->counter;
+        // destructs the task (and what it captured) before the counter lets a waiter go on
+        destroyJob(job);
+        if (counter)
+        {
+            std::vector<Job*> ready = counter->finish();
+            for (size_t i = 0; i < ready.size(); i++)
+                submit(ready[i]);
+        }
+    }
+    // ------------------------------------------------------------------------
+    void workerLoop(int index)
+    {
+        currentSystem() = this;
+        currentIndex() = index;
+        int idle = 0;
+        while (!stopping)
+        {
+            Job* job = findJob(index);
+            if (job)
+            {
+                execute(job);
+                idle = 0;
+            }
+            else if (++idle < 64)
+                std::this_thread::yield();
+            else
+            {
+                // sleeps until submit() or the destructor notifies, an idle worker costs no CPU time
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                sleepers++;
+                wakeUp.wait(lock, [this]() { return stopping || queued.load() > 0; });
+                sleepers--;
+                idle = 0;
+            }
+        }
+        currentSystem() = NULL;
+    }
+};
+#endif
@@ -0,0 +1,266 @@
+#ifndef MULTI_DRAW_H
+#define MULTI_DRAW_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// layout of one command in the GL_DRAW_INDIRECT_BUFFER, as glMultiDrawElementsIndirect reads it
+struct DrawElementsIndirectCommand
+{
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+// where a mesh lives inside the shared buffers of a MeshPool
+struct MeshRange
+{
+    unsigned int indexCount;
+    unsigned int firstIndex;
+    int baseVertex;
+};
+
+// per-draw data, read by the vertex shader from the shader storage buffer (std430, 32 bytes)
+struct DrawData
+{
+    float offsetScale[4]; // xy offset, zw scale, in normalized device coordinates
+    float color[4];
+};
+
+// glMultiDrawElementsIndirect and shader storage buffers are core since OpenGL 4.3, which the shaders below
+// (#version 430 core) need as well
+// ------------------------------------------------------------------------
+inline bool multiDrawIndirectSupported()
+{
+    return GLAD_GL_VERSION_4_3;
+}
+
+// Vertex shader of the multi-draw path. Without gl_DrawID (OpenGL 4.6 or ARB_shader_draw_parameters) the draw
+// index comes in as an instanced attribute instead: every command starts at baseInstance = its index, and the
+// MeshPool VAO has a buffer of ascending integers at location 1 with divisor 1.
+// When the commands were compacted on the GPU (see GpuCuller) the draw index no longer is the object index, so
+// compacted reads gl_BaseInstance instead, which the culling pass leaves at the object index.
+// The uniform viewOffset (zero by default) is subtracted from every position, to pan over the objects.
+// ------------------------------------------------------------------------
+inline std::string multiDrawVertexShader(bool compacted = false)
+{
+    std::string source = "#version 430 core\n";
+    if (GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_shader_draw_parameters)
+        source += std::string("#extension GL_ARB_shader_draw_parameters : require\n")
+                + (compacted ? "#define DRAW_ID gl_BaseInstanceARB\n" : "#define DRAW_ID gl_DrawIDARB\n");
+    source +=
+        "layout (location = 0) in vec3 aPos;\n"
+        "layout (location = 1) in uint aDrawId;\n"
+        "struct DrawData\n"
+        "{\n"
+        "   vec4 offsetScale;\n"
+        "   vec4 color;\n"
+        "};\n"
+        "layout (std430, binding = 0) readonly buffer DrawDataBuffer\n"
+        "{\n"
+        "   DrawData draws[];\n"
+        "};\n"
+        "uniform vec2 viewOffset;\n"
+        "out vec4 drawColor;\n"
+        "void main()\n"
+        "{\n"
+        "#ifdef DRAW_ID\n"
+        "   DrawData draw = draws[DRAW_ID];\n"
+        "#else\n"
+        "   DrawData draw = draws[aDrawId];\n"
+        "#endif\n"
+        "   gl_Position = vec4(aPos.xy * draw.offsetScale.zw + draw.offsetScale.xy - viewOffset, aPos.z, 1.0);\n"
+        "   drawColor = draw.color;\n"
+        "}\n";
+    return source;
+}
+const char* const multiDrawFragmentSource = "#version 430 core\n"
+    "in vec4 drawColor;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = drawColor;\n"
+    "}\n\0";
+
+// One vertex buffer and one index buffer that many meshes are suballocated from, so that they can all be drawn
+// with the same VAO and therefore with a single multi-draw call. Vertices are 3 floats of position (like the
+// hello_rectangle VBO); indices are GL_UNSIGNED_INT and relative to the mesh, baseVertex adds the offset.
+class MeshPool
+{
+public:
+    unsigned int VAO;
+
+    MeshPool(unsigned int maxVertices, unsigned int maxIndices)
+        : maxVertices(maxVertices), maxIndices(maxIndices), vertexCount(0), indexCount(0), drawIdCapacity(0)
+    {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        glGenBuffers(1, &drawIdBuffer);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, maxVertices * 3 * sizeof(float), NULL, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, maxIndices * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, drawIdBuffer);
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(unsigned int), (void*)0);
+        glVertexAttribDivisor(1, 1);
+        glEnableVertexAttribArray(1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // copies a mesh into the shared buffers and returns its id, or -1 if the pool is full
+    // ------------------------------------------------------------------------
+    int add(const float* vertices, unsigned int vertexTotal, const unsigned int* indices, unsigned int indexTotal)
+    {
+        if (vertexCount + vertexTotal > maxVertices || indexCount + indexTotal > maxIndices)
+        {
+            std::cout << "ERROR::MESH_POOL::FULL: no room for " << vertexTotal << " vertices and " << indexTotal << " indices" << std::endl;
+            return -1;
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, vertexCount * 3 * sizeof(float), vertexTotal * 3 * sizeof(float), vertices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexCount * sizeof(unsigned int), indexTotal * sizeof(unsigned int), indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        MeshRange range;
+        range.indexCount = indexTotal;
+        range.firstIndex = indexCount;
+        range.baseVertex = (int)vertexCount;
+        meshes.push_back(range);
+        vertexCount += vertexTotal;
+        indexCount += indexTotal;
+        return (int)meshes.size() - 1;
+    }
+    // ------------------------------------------------------------------------
+    const MeshRange& mesh(int id) const
+    {
+        return meshes[id];
+    }
+    // makes the draw index attribute cover at least count draws (only needed without gl_DrawID)
+    // ------------------------------------------------------------------------
+    void reserveDraws(unsigned int count)
+    {
+        if (count <= drawIdCapacity)
+            return;
+        drawIdCapacity = count;
+        std::vector<unsigned int> ids(count);
+        for (unsigned int i = 0; i < count; i++)
+            ids[i] = i;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, drawIdBuffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, count * sizeof(unsigned int), ids.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteBuffers(1, &drawIdBuffer);
+        VAO = VBO = EBO = drawIdBuffer = 0;
+    }
+
+private:
+    unsigned int VBO, EBO, drawIdBuffer;
+    unsigned int maxVertices, maxIndices;
+    unsigned int vertexCount, indexCount;
+    unsigned int drawIdCapacity;
+    std::vector<MeshRange> meshes;
+};
+
+// The draws of one material (program and fixed state): one indirect command and one DrawData per object.
+// Fill it with add(), upload() when it changed, and draw() issues all of it with one glMultiDrawElementsIndirect;
+// the CPU cost no longer grows with the number of objects, only with the number of materials.
+class MultiDrawBatch
+{
+public:
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawData> drawData;
+
+    MultiDrawBatch(MeshPool& pool) : pool(pool), capacity(0), uploaded(0)
+    {
+        glGenBuffers(1, &indirectBuffer);
+        glGenBuffers(1, &drawDataBuffer);
+    }
+
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        commands.clear();
+        drawData.clear();
+    }
+    // ------------------------------------------------------------------------
+    void add(int mesh, const DrawData& data)
+    {
+        const MeshRange& range = pool.mesh(mesh);
+        DrawElementsIndirectCommand command;
+        command.count = range.indexCount;
+        command.instanceCount = 1;
+        command.firstIndex = range.firstIndex;
+        command.baseVertex = range.baseVertex;
+        command.baseInstance = (unsigned int)commands.size(); // the draw index, for the attribute fallback
+        commands.push_back(command);
+        drawData.push_back(data);
+    }
+    // copies the commands and the draw data to the GPU
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        pool.reserveDraws((unsigned int)commands.size());
+        if (commands.size() > capacity)
+            capacity = commands.size();
+        // orphan and refill; both buffers stay sized for the largest batch so far
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, capacity * sizeof(DrawElementsIndirectCommand), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawDataBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(DrawData), NULL, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, drawData.size() * sizeof(DrawData), drawData.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        uploaded = commands.size();
+    }
+    // draws every uploaded command; the program of the material has to be in use
+    // ------------------------------------------------------------------------
+    void draw()
+    {
+        if (uploaded == 0)
+            return;
+        glBindVertexArray(pool.VAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        bindDrawData();
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)uploaded, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    // binds the uploaded DrawData to shader storage binding 0, where the vertex shader reads it
+    // ------------------------------------------------------------------------
+    void bindDrawData() const
+    {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawDataBuffer);
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteBuffers(1, &indirectBuffer);
+        glDeleteBuffers(1, &drawDataBuffer);
+        indirectBuffer = drawDataBuffer = 0;
+    }
+
+private:
+    MeshPool& pool;
+    unsigned int indirectBuffer, drawDataBuffer;
+    size_t capacity;
+    size_t uploaded;
+};
+#endif
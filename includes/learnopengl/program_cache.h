@@ -0,0 +1,159 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked shader programs, stored with glGetProgramBinary and restored with glProgramBinary.
+// - The key is a hash of the shader sources together with the GL vendor, renderer and version strings, so a
+//   driver update or a different GPU never picks up a stale binary.
+// - Drivers may still reject a binary (for example after an update that kept the version string); load()
+//   then deletes the file and returns 0 so the caller compiles from source and stores a fresh one.
+// - Program binaries are core since OpenGL 4.1 (ARB_get_program_binary before that). When the driver
+//   offers no binary formats, load() always misses and store() does nothing.
+// Usage:
+//     unsigned int program = cache.load(vertexSource, fragmentSource);
+//     if (program == 0)
+//     {
+//         ... compile the shaders, program = glCreateProgram(), attach them ...
+//         cache.prepare(program);
+//         glLinkProgram(program);
+//         cache.store(program, vertexSource, fragmentSource);
+//     }
+class ProgramCache
+{
+public:
+    int hits = 0;
+    int misses = 0;
+
+    ProgramCache(const std::string& directory = "shader_cache") : directory(directory)
+    {
+        int formats = 0;
+        if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        supported = formats > 0;
+        if (!supported)
+            return;
+        driver = std::string((const char*)glGetString(GL_VENDOR)) + "\n" + (const char*)glGetString(GL_RENDERER) + "\n"
+               + (const char*)glGetString(GL_VERSION);
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    // returns a linked program restored from the cache, or 0 if there is no (valid) binary for these sources
+    // ------------------------------------------------------------------------
+    unsigned int load(const char* vertexSource, const char* fragmentSource)
+    {
+        if (!supported)
+            return 0;
+        unsigned long long key = hashSources(vertexSource, fragmentSource);
+        std::string path = pathFor(key);
+        std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+        if (!file)
+        {
+            misses++;
+            return 0;
+        }
+        size_t size = (size_t)file.tellg();
+        file.seekg(0);
+        Header header;
+        if (size <= sizeof(header) || !file.read((char*)&header, sizeof(header)) || header.magic != MAGIC || header.key != key)
+        {
+            misses++;
+            return 0;
+        }
+        std::vector<char> binary(size - sizeof(header));
+        file.read(binary.data(), binary.size());
+        file.close();
+
+        unsigned int program = glCreateProgram();
+        glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            // the driver rejected the binary: drop it, the caller recompiles and stores a new one
+            glDeleteProgram(program);
+            std::remove(path.c_str());
+            misses++;
+            return 0;
+        }
+        hits++;
+        return program;
+    }
+    // call before glLinkProgram, so the driver keeps the binary around for store()
+    // ------------------------------------------------------------------------
+    void prepare(unsigned int program)
+    {
+        if (supported)
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    // writes the binary of a successfully linked program to the cache
+    // ------------------------------------------------------------------------
+    void store(unsigned int program, const char* vertexSource, const char* fragmentSource)
+    {
+        int success = 0, length = 0;
+        if (!supported)
+            return;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (!success || length <= 0)
+            return;
+        std::vector<char> binary(length);
+        Header header;
+        header.magic = MAGIC;
+        header.key = hashSources(vertexSource, fragmentSource);
+        glGetProgramBinary(program, length, NULL, &header.format, binary.data());
+
+        std::ofstream file(pathFor(header.key).c_str(), std::ios::binary);
+        file.write((const char*)&header, sizeof(header));
+        file.write(binary.data(), binary.size());
+        if (!file)
+            std::cout << "ERROR::PROGRAM_CACHE::FILE_NOT_WRITTEN: " << pathFor(header.key) << std::endl;
+    }
+
+private:
+    static const unsigned int MAGIC = 0x4C474F42; // "BOGL"
+
+    struct Header
+    {
+        unsigned int magic;
+        GLenum format;
+        unsigned long long key;
+    };
+
+    std::string directory;
+    std::string driver;
+    bool supported;
+
+    // 64 bit FNV-1a over both sources and the driver identification
+    // ------------------------------------------------------------------------
+    unsigned long long hashSources(const char* vertexSource, const char* fragmentSource) const
+    {
+        unsigned long long hash = 14695981039346656037ull;
+        const char* parts[3] = { vertexSource, fragmentSource, driver.c_str() };
+        for (int i = 0; i < 3; i++)
+        {
+            for (const char* c = parts[i]; *c; c++)
+                hash = (hash ^ (unsigned char)*c) * 1099511628211ull;
+            hash = (hash ^ 0xFF) * 1099511628211ull; // separator, so moving text between the parts changes the key
+        }
+        return hash;
+    }
+    // ------------------------------------------------------------------------
+    std::string pathFor(unsigned long long key) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", key);
+        return directory + "/" + name;
+    }
+};
+#endif
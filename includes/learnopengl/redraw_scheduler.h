@@ -0,0 +1,193 @@
+#ifndef REDRAW_SCHEDULER_H
+#define REDRAW_SCHEDULER_H
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+
+// Renders a static scene only when it changed, and sleeps in glfwWaitEventsTimeout in between.
+// - The scheduler chains its own callbacks in front of the window's key, character, mouse button, scroll, focus,
+//   refresh and framebuffer size callbacks (set those before creating it): any of them marks the window dirty
+//   and then calls the one the sample installed. Moving the cursor alone does not change a static scene; a
+//   sample whose view follows the cursor calls requestRedraw() from its own cursor callback.
+// - Other reasons to draw come in through requestRedraw() (any thread, e.g. a finished hot reload or upload)
+//   and animate(), which keeps drawing every frame for a while. Work that finishes in the background without
+//   an event (a decoding texture, a compiling shader) can shorten the next wait with wakeWithin().
+// - Continuous mode (onDemand false) polls and draws every frame, the way the samples always did.
+// - A frame that is not drawn does not call the FrameProfiler or the FramePacer at all, so their frame times
+//   only cover frames that were really drawn; the time spent waiting is counted in idleSeconds instead.
+// - The callbacks find the scheduler through a static pointer, so there is one at a time (the samples have one window).
+// Usage in a render loop:
+//     if (redraw.waitEvents()) pacer.inputSampled(); // instead of glfwPollEvents
+//     processInput(window); ...updates, requestRedraw() if they changed something...
+//     if (!redraw.beginFrame()) continue;
+//     ...draw and swap...
+class RedrawScheduler
+{
+public:
+    double idleTimeout;          // longest wait for an event, in seconds; the loop runs its updates at least this often
+    unsigned long framesDrawn;   // frames beginFrame() let through
+    unsigned long framesSkipped; // loop iterations that found nothing to draw
+    double idleSeconds;          // time spent waiting for events
+
+    RedrawScheduler(GLFWwindow* window, bool onDemand = true, double idleTimeout = 0.25)
+        : idleTimeout(idleTimeout), framesDrawn(0), framesSkipped(0), idleSeconds(0.0), window(window), onDemand(onDemand),
+          dirty(true), animateUntil(0.0), nextTimeout(idleTimeout)
+    {
+        instance() = this;
+        previous().key = glfwSetKeyCallback(window, keyCallback);
+        previous().character = glfwSetCharCallback(window, charCallback);
+        previous().mouseButton = glfwSetMouseButtonCallback(window, mouseButtonCallback);
+        previous().scroll = glfwSetScrollCallback(window, scrollCallback);
+        previous().focus = glfwSetWindowFocusCallback(window, focusCallback);
+        previous().refresh = glfwSetWindowRefreshCallback(window, refreshCallback);
+        previous().framebufferSize = glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    }
+    ~RedrawScheduler()
+    {
+        if (instance() == this)
+            instance() = NULL;
+    }
+    RedrawScheduler(const RedrawScheduler&) = delete;
+    RedrawScheduler& operator=(const RedrawScheduler&) = delete;
+
+    // marks the next frame as needed and wakes the loop up; any thread
+    // ------------------------------------------------------------------------
+    void requestRedraw()
+    {
+        dirty.store(true, std::memory_order_release);
+        glfwPostEmptyEvent();
+    }
+    // draws every frame for the next seconds, e.g. while something moves
+    // ------------------------------------------------------------------------
+    void animate(double seconds)
+    {
+        animateUntil = std::max(animateUntil, glfwGetTime() + seconds);
+    }
+    // the next waitEvents() waits seconds at most
+    // ------------------------------------------------------------------------
+    void wakeWithin(double seconds)
+    {
+        nextTimeout = std::min(nextTimeout, seconds);
+    }
+    // processes the pending events; on demand, with nothing to draw, waits for one first. Returns whether it
+    // waited, in which case the frame's input was only now sampled (see FramePacer::inputSampled)
+    // ------------------------------------------------------------------------
+    bool waitEvents()
+    {
+        if (!onDemand || needsRedraw())
+        {
+            glfwPollEvents();
+            return false;
+        }
+        double start = glfwGetTime();
+        glfwWaitEventsTimeout(nextTimeout);
+        idleSeconds += glfwGetTime() - start;
+        nextTimeout = idleTimeout;
+        return true;
+    }
+    // whether this loop iteration draws; call after the updates that may request a redraw
+    // ------------------------------------------------------------------------
+    bool beginFrame()
+    {
+        if (onDemand && !needsRedraw())
+        {
+            framesSkipped++;
+            return false;
+        }
+        dirty.store(false, std::memory_order_relaxed);
+        framesDrawn++;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout) const
+    {
+        out << "RedrawScheduler: " << framesDrawn << " frames drawn, " << framesSkipped << " wake ups without a change, "
+            << idleSeconds << " s idle" << std::endl;
+    }
+
+private:
+    struct Callbacks
+    {
+        GLFWkeyfun key = NULL;
+        GLFWcharfun character = NULL;
+        GLFWmousebuttonfun mouseButton = NULL;
+        GLFWscrollfun scroll = NULL;
+        GLFWwindowfocusfun focus = NULL;
+        GLFWwindowrefreshfun refresh = NULL;
+        GLFWframebuffersizefun framebufferSize = NULL;
+    };
+
+    GLFWwindow* window;
+    bool onDemand;
+    std::atomic<bool> dirty;
+    double animateUntil;
+    double nextTimeout;
+
+    // ------------------------------------------------------------------------
+    bool needsRedraw() const
+    {
+        return dirty.load(std::memory_order_acquire) || glfwGetTime() < animateUntil || glfwWindowShouldClose(window);
+    }
+    static RedrawScheduler*& instance()
+    {
+        static RedrawScheduler* scheduler = NULL;
+        return scheduler;
+    }
+    static Callbacks& previous()
+    {
+        static Callbacks callbacks;
+        return callbacks;
+    }
+    // ------------------------------------------------------------------------
+    static void markDirty()
+    {
+        if (instance())
+            instance()->dirty.store(true, std::memory_order_release);
+    }
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+    {
+        markDirty();
+        if (previous().key)
+            previous().key(window, key, scancode, action, mods);
+    }
+    static void charCallback(GLFWwindow* window, unsigned int codepoint)
+    {
+        markDirty();
+        if (previous().character)
+            previous().character(window, codepoint);
+    }
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
+    {
+        markDirty();
+        if (previous().mouseButton)
+            previous().mouseButton(window, button, action, mods);
+    }
+    static void scrollCallback(GLFWwindow* window, double x, double y)
+    {
+        markDirty();
+        if (previous().scroll)
+            previous().scroll(window, x, y);
+    }
+    static void focusCallback(GLFWwindow* window, int focused)
+    {
+        markDirty();
+        if (previous().focus)
+            previous().focus(window, focused);
+    }
+    static void refreshCallback(GLFWwindow* window)
+    {
+        markDirty();
+        if (previous().refresh)
+            previous().refresh(window);
+    }
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height)
+    {
+        markDirty();
+        if (previous().framebufferSize)
+            previous().framebufferSize(window, width, height);
+    }
+};
+#endif
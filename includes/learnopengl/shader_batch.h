@@ -0,0 +1,208 @@
+#ifndef SHADER_BATCH_H
+#define SHADER_BATCH_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+#include <learnopengl/program_cache.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Compiles many shader programs without stalling the render loop.
+// - submit() hands the sources to the driver and links right away; it never asks for GL_COMPILE_STATUS or
+//   GL_LINK_STATUS, because those queries wait for the compiler and serialize the whole batch.
+// - With GL_KHR_parallel_shader_compile (or the ARB version) the driver compiles on its own threads and
+//   poll() only checks GL_COMPLETION_STATUS_KHR, which never blocks. Call poll() once per frame; a program
+//   becomes usable the frame after it finished.
+// - Without the extension the queries do block, so poll() finishes at most maxBlockingPerPoll programs per
+//   frame to spread the cost over several frames instead of freezing the first one.
+// - With a ProgramCache, submit() first tries the cached binary and such programs are ready immediately.
+// - The caller owns the programs it got from program(); release() deletes the ones that never finished.
+// - A long-running user (hot reload) takes the result with take() instead, which frees the handle's entry so
+//   later submits reuse it and the batch does not grow with every recompile.
+class ShaderBatch
+{
+public:
+    int maxBlockingPerPoll = 1;
+
+    ShaderBatch(ProgramCache* cache = NULL) : cache(cache)
+    {
+        parallel = GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+        // let the driver use as many compiler threads as it likes
+        if (GLAD_GL_KHR_parallel_shader_compile)
+            glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+        else if (GLAD_GL_ARB_parallel_shader_compile)
+            glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+    }
+
+    // starts compiling a vertex/fragment pair and returns its handle for ready()/program()/take()
+    // ------------------------------------------------------------------------
+    int submit(const std::string& vertexSource, const std::string& fragmentSource)
+    {
+        int handle = (int)entries.size();
+        if (!freeEntries.empty())
+        {
+            handle = freeEntries.back();
+            freeEntries.pop_back();
+        }
+        else
+            entries.push_back(Entry());
+        Entry& entry = entries[handle];
+        entry = Entry();
+        entry.vertexSource = vertexSource;
+        entry.fragmentSource = fragmentSource;
+        entry.program = cache ? cache->load(vertexSource.c_str(), fragmentSource.c_str()) : 0;
+        if (entry.program != 0)
+        {
+            entry.state = READY;
+            return handle;
+        }
+        const char* vShaderCode = entry.vertexSource.c_str();
+        const char* fShaderCode = entry.fragmentSource.c_str();
+        entry.vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(entry.vertex, 1, &vShaderCode, NULL);
+        glCompileShader(entry.vertex);
+        entry.fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(entry.fragment, 1, &fShaderCode, NULL);
+        glCompileShader(entry.fragment);
+        entry.program = glCreateProgram();
+        glAttachShader(entry.program, entry.vertex);
+        glAttachShader(entry.program, entry.fragment);
+        if (cache)
+            cache->prepare(entry.program);
+        glLinkProgram(entry.program);
+        entry.state = COMPILING;
+        pendingCount++;
+        return handle;
+    }
+    // collects finished programs; call once per frame
+    // ------------------------------------------------------------------------
+    void poll()
+    {
+        int blocking = 0;
+        for (size_t i = 0; i < entries.size() && pendingCount > 0; i++)
+        {
+            Entry& entry = entries[i];
+            if (entry.state != COMPILING)
+                continue;
+            if (parallel)
+            {
+                int done = 0;
+                glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &done);
+                if (!done)
+                    continue;
+            }
+            else if (blocking++ >= maxBlockingPerPoll)
+                return;
+            finish(entry);
+        }
+    }
+    // whether the program of the handle finished (successfully or not)
+    // ------------------------------------------------------------------------
+    bool ready(int handle) const
+    {
+        return entries[handle].state != COMPILING;
+    }
+    // the linked program, or 0 while it is still compiling or if it failed
+    // ------------------------------------------------------------------------
+    unsigned int program(int handle) const
+    {
+        return entries[handle].state == READY ? entries[handle].program : 0;
+    }
+    // the linked program (0 if it failed) of a finished handle, which is invalid afterwards: its entry is reused
+    // by a later submit(). Only call once ready(handle) is true
+    // ------------------------------------------------------------------------
+    unsigned int take(int handle)
+    {
+        unsigned int result = program(handle);
+        entries[handle] = Entry();
+        entries[handle].state = FREE;
+        freeEntries.push_back(handle);
+        return result;
+    }
+    // number of programs still compiling
+    // ------------------------------------------------------------------------
+    int pending() const
+    {
+        return pendingCount;
+    }
+    // deletes the programs that are still compiling and their shaders; finished programs belong to the caller
+    // and stay. Call before the context is destroyed
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            Entry& entry = entries[i];
+            if (entry.state != COMPILING)
+                continue;
+            glDeleteShader(entry.vertex);
+            glDeleteShader(entry.fragment);
+            glDeleteProgram(entry.program);
+            entry.vertex = entry.fragment = entry.program = 0;
+            entry.state = FAILED;
+        }
+        pendingCount = 0;
+    }
+
+private:
+    enum State { COMPILING, READY, FAILED, FREE };
+
+    struct Entry
+    {
+        std::string vertexSource, fragmentSource;
+        unsigned int vertex = 0, fragment = 0, program = 0;
+        State state = COMPILING;
+    };
+
+    ProgramCache* cache;
+    bool parallel;
+    int pendingCount = 0;
+    std::vector<Entry> entries;
+    std::vector<int> freeEntries; // taken handles, reused by submit()
+
+    // reads the compile and link results (cheap now, the work is done) and releases the shader objects
+    // ------------------------------------------------------------------------
+    void finish(Entry& entry)
+    {
+        int success;
+        char infoLog[1024];
+        glGetProgramiv(entry.program, GL_LINK_STATUS, &success);
+        if (!success)
+        {
+            glGetShaderiv(entry.vertex, GL_COMPILE_STATUS, &success);
+            if (!success)
+            {
+                glGetShaderInfoLog(entry.vertex, 1024, NULL, infoLog);
+                std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: VERTEX\n" << infoLog << std::endl;
+            }
+            glGetShaderiv(entry.fragment, GL_COMPILE_STATUS, &success);
+            if (!success)
+            {
+                glGetShaderInfoLog(entry.fragment, 1024, NULL, infoLog);
+                std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: FRAGMENT\n" << infoLog << std::endl;
+            }
+            glGetProgramInfoLog(entry.program, 1024, NULL, infoLog);
+            std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: PROGRAM\n" << infoLog << std::endl;
+            glDeleteProgram(entry.program);
+            entry.program = 0;
+            entry.state = FAILED;
+        }
+        else
+        {
+            entry.state = READY;
+            if (cache)
+                cache->store(entry.program, entry.vertexSource.c_str(), entry.fragmentSource.c_str());
+        }
+        glDeleteShader(entry.vertex);
+        glDeleteShader(entry.fragment);
+        entry.vertex = entry.fragment = 0;
+        // the sources are only needed as the cache key
+        entry.vertexSource.clear();
+        entry.fragmentSource.clear();
+        pendingCount--;
+    }
+};
+#endif
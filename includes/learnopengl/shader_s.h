@@ -0,0 +1,240 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/program_cache.h>
+
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <unordered_map>
+
+// FNV-1a hash of a uniform name. It is constexpr, so a string literal like uniformHash("ourColor")
+// is hashed by the compiler and the render loop never has to touch the string at all.
+// ------------------------------------------------------------------------
+constexpr unsigned int uniformHash(const char* str, unsigned int hash = 2166136261u)
+{
+    return *str ? uniformHash(str + 1, (hash ^ static_cast<unsigned char>(*str)) * 16777619u) : hash;
+}
+
+class Shader
+{
+public:
+    unsigned int ID;
+    // constructor generates the shader on the fly; with a cache, a program linked on an earlier run is
+    // restored from its binary instead of being compiled again
+    // ------------------------------------------------------------------------
+    Shader(const char* vertexPath, const char* fragmentPath, ProgramCache* cache = NULL)
+    {
+        // 1. retrieve the vertex/fragment source code from filePath
+        std::string vertexCode;
+        std::string fragmentCode;
+        std::ifstream vShaderFile;
+        std::ifstream fShaderFile;
+        // ensure ifstream objects can throw exceptions:
+        vShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        fShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            // open files
+            vShaderFile.open(vertexPath);
+            fShaderFile.open(fragmentPath);
+            std::stringstream vShaderStream, fShaderStream;
+            // read file's buffer contents into streams
+            vShaderStream << vShaderFile.rdbuf();
+            fShaderStream << fShaderFile.rdbuf();
+            // close file handlers
+            vShaderFile.close();
+            fShaderFile.close();
+            // convert stream into string
+            vertexCode   = vShaderStream.str();
+            fragmentCode = fShaderStream.str();
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
+        }
+        build(vertexCode.c_str(), fragmentCode.c_str(), cache);
+    }
+    // adopts a program that is already linked, e.g. one finished by a ShaderBatch
+    // ------------------------------------------------------------------------
+    explicit Shader(unsigned int program) : ID(program)
+    {
+        cacheUniformLocations();
+    }
+    // builds the shader from sources in memory instead of files, e.g. a variant with injected #defines
+    // ------------------------------------------------------------------------
+    static Shader fromSource(const std::string& vertexCode, const std::string& fragmentCode, ProgramCache* cache = NULL)
+    {
+        return fromSource(vertexCode.c_str(), fragmentCode.c_str(), cache);
+    }
+    // the same for null-terminated sources, which are not copied (e.g. straight out of an AssetPack mapping)
+    // ------------------------------------------------------------------------
+    static Shader fromSource(const char* vertexCode, const char* fragmentCode, ProgramCache* cache = NULL)
+    {
+        Shader shader;
+        shader.build(vertexCode, fragmentCode, cache);
+        return shader;
+    }
+    // activate the shader
+    // ------------------------------------------------------------------------
+    void use()
+    {
+        glUseProgram(ID);
+    }
+    // returns the cached location of a uniform (-1 if the program has no such uniform).
+    // Names that were not active at link time (e.g. "lights[3]") are queried once and then cached too; that needs the
+    // name, a lookup by hash alone of such a uniform returns -1 until it was set by name once.
+    // ------------------------------------------------------------------------
+    int getUniformLocation(unsigned int nameHash, const char* name = NULL) const
+    {
+        std::unordered_map<unsigned int, int>::const_iterator it = uniformLocations.find(nameHash);
+        if (it != uniformLocations.end())
+            return it->second;
+        // without the name there is nothing to look up; a miss is not cached, so a later lookup by name still works
+        if (!name)
+            return -1;
+        int location = glGetUniformLocation(ID, name);
+        uniformLocations[nameHash] = location;
+        return location;
+    }
+    // utility uniform functions
+    // ------------------------------------------------------------------------
+    void setBool(const std::string &name, bool value) const
+    {
+        glUniform1i(getUniformLocation(uniformHash(name.c_str()), name.c_str()), (int)value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(const std::string &name, int value) const
+    {
+        glUniform1i(getUniformLocation(uniformHash(name.c_str()), name.c_str()), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(const std::string &name, float value) const
+    {
+        glUniform1f(getUniformLocation(uniformHash(name.c_str()), name.c_str()), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(const std::string &name, float x, float y, float z, float w) const
+    {
+        glUniform4f(getUniformLocation(uniformHash(name.c_str()), name.c_str()), x, y, z, w);
+    }
+    // the same setters, but keyed by a precomputed hash: ourShader.setFloat(uniformHash("time"), t);
+    // ------------------------------------------------------------------------
+    void setBool(unsigned int nameHash, bool value) const
+    {
+        glUniform1i(getUniformLocation(nameHash), (int)value);
+    }
+    // ------------------------------------------------------------------------
+    void setInt(unsigned int nameHash, int value) const
+    {
+        glUniform1i(getUniformLocation(nameHash), value);
+    }
+    // ------------------------------------------------------------------------
+    void setFloat(unsigned int nameHash, float value) const
+    {
+        glUniform1f(getUniformLocation(nameHash), value);
+    }
+    // ------------------------------------------------------------------------
+    void setVec4(unsigned int nameHash, float x, float y, float z, float w) const
+    {
+        glUniform4f(getUniformLocation(nameHash), x, y, z, w);
+    }
+
+private:
+    // uniform name hash -> location, filled in at link time
+    mutable std::unordered_map<unsigned int, int> uniformLocations;
+
+    Shader() : ID(0) {}
+
+    // links the program from its sources, or restores it from the binary cache
+    // ------------------------------------------------------------------------
+    void build(const char* vShaderCode, const char* fShaderCode, ProgramCache* cache)
+    {
+        // 2. restore the program from the binary cache, if we have one for these sources
+        ID = cache ? cache->load(vShaderCode, fShaderCode) : 0;
+        if (ID == 0)
+        {
+            // 3. compile shaders
+            unsigned int vertex, fragment;
+            // vertex shader
+            vertex = glCreateShader(GL_VERTEX_SHADER);
+            glShaderSource(vertex, 1, &vShaderCode, NULL);
+            glCompileShader(vertex);
+            checkCompileErrors(vertex, "VERTEX");
+            // fragment Shader
+            fragment = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(fragment, 1, &fShaderCode, NULL);
+            glCompileShader(fragment);
+            checkCompileErrors(fragment, "FRAGMENT");
+            // shader Program
+            ID = glCreateProgram();
+            glAttachShader(ID, vertex);
+            glAttachShader(ID, fragment);
+            if (cache)
+                cache->prepare(ID);
+            glLinkProgram(ID);
+            checkCompileErrors(ID, "PROGRAM");
+            // delete the shaders as they're linked into our program now and no longer necessary
+            glDeleteShader(vertex);
+            glDeleteShader(fragment);
+            if (cache)
+                cache->store(ID, vShaderCode, fShaderCode);
+        }
+        // 4. resolve every active uniform location once, right after linking
+        cacheUniformLocations();
+    }
+    // walks the active uniforms of the linked program and stores their locations by name hash
+    // ------------------------------------------------------------------------
+    void cacheUniformLocations()
+    {
+        uniformLocations.clear();
+        int count = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        char name[256];
+        for (int i = 0; i < count; i++)
+        {
+            int length = 0, size = 0;
+            unsigned int type = 0;
+            glGetActiveUniform(ID, (unsigned int)i, sizeof(name), &length, &size, &type, name);
+            int location = glGetUniformLocation(ID, name);
+            if (location < 0)
+                continue; // uniforms inside a uniform block have no location
+            uniformLocations[uniformHash(name)] = location;
+            // arrays are reported as "name[0]"; make the plain "name" resolve to element 0 as well
+            if (length > 3 && name[length - 3] == '[' && name[length - 2] == '0' && name[length - 1] == ']')
+            {
+                name[length - 3] = '\0';
+                uniformLocations[uniformHash(name)] = location;
+            }
+        }
+    }
+    // utility function for checking shader compilation/linking errors.
+    // ------------------------------------------------------------------------
+    void checkCompileErrors(unsigned int shader, std::string type)
+    {
+        int success;
+        char infoLog[1024];
+        if (type != "PROGRAM")
+        {
+            glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+            if (!success)
+            {
+                glGetShaderInfoLog(shader, 1024, NULL, infoLog);
+                std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            }
+        }
+        else
+        {
+            glGetProgramiv(shader, GL_LINK_STATUS, &success);
+            if (!success)
+            {
+                glGetProgramInfoLog(shader, 1024, NULL, infoLog);
+                std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            }
+        }
+    }
+};
+#endif
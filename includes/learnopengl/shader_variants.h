@@ -0,0 +1,184 @@
+#ifndef SHADER_VARIANTS_H
+#define SHADER_VARIANTS_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/program_cache.h>
+#include <learnopengl/shader_s.h>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// inserts header (e.g. "#define NAME 1\n" lines) right after the #version line, which must stay the first one;
+// a header that starts with a #version line of its own replaces the one of the source
+// ------------------------------------------------------------------------
+inline std::string injectShaderDefines(const std::string& source, const std::string& header)
+{
+    if (header.empty())
+        return source;
+    size_t version = source.find("#version");
+    if (version == std::string::npos)
+        return header + source;
+    size_t lineEnd = source.find('\n', version);
+    if (header.compare(0, 8, "#version") == 0)
+    {
+        if (lineEnd == std::string::npos)
+            return source.substr(0, version) + header;
+        return source.substr(0, version) + header + source.substr(lineEnd + 1);
+    }
+    if (lineEnd == std::string::npos)
+        return source + "\n" + header;
+    return source.substr(0, lineEnd + 1) + header + source.substr(lineEnd + 1);
+}
+
+// Opt-in bitmask operators for an enum class of shader features:
+//     enum class TextureFeature : unsigned int { None = 0, VertexColor = 1 << 0, Grayscale = 1 << 1 };
+//     template <> struct IsFeatureMask<TextureFeature> : std::true_type {};
+// after which TextureFeature::VertexColor | TextureFeature::Grayscale is a TextureFeature again.
+template <typename T>
+struct IsFeatureMask : std::false_type {};
+
+template <typename T>
+constexpr typename std::enable_if<IsFeatureMask<T>::value, T>::type operator|(T a, T b)
+{
+    return static_cast<T>(static_cast<unsigned int>(a) | static_cast<unsigned int>(b));
+}
+template <typename T>
+constexpr typename std::enable_if<IsFeatureMask<T>::value, T>::type operator&(T a, T b)
+{
+    return static_cast<T>(static_cast<unsigned int>(a) & static_cast<unsigned int>(b));
+}
+// the permutation key of a feature set: its bits, usable as an index and computed at compile time for constants
+// ------------------------------------------------------------------------
+template <typename T>
+constexpr typename std::enable_if<IsFeatureMask<T>::value, unsigned int>::type variantKey(T features)
+{
+    return static_cast<unsigned int>(features);
+}
+// ------------------------------------------------------------------------
+template <typename T>
+constexpr typename std::enable_if<IsFeatureMask<T>::value, bool>::type hasFeatures(T set, T features)
+{
+    return (set & features) == features;
+}
+
+// All permutations of one .vs/.fs pair, each compiled with the #defines of its feature bits.
+// - The sources are read once. A variant is only compiled the first time get() asks for it, with
+//   "#define NAME 1" for every feature bit it has inserted right after the #version line, so the GLSL can use
+//   #ifdef instead of branching at runtime on features a material doesn't use.
+// - Variants live in a flat table indexed by the permutation key (2^FeatureCount entries), so get() is a
+//   single index operation once the variant exists.
+// - With a ProgramCache every variant is stored as its own binary; the injected defines are part of the
+//   source, and so of the cache key.
+// - Features that need a newer GLSL than the sources declare (e.g. shader storage buffers) can raise the
+//   #version of the variants that have them with requireVersion(); the other variants keep the sources' one.
+template <typename Features, unsigned int FeatureCount>
+class ShaderVariants
+{
+    static_assert(IsFeatureMask<Features>::value, "specialize IsFeatureMask for the feature enum");
+    static_assert(FeatureCount < 16, "the variant table has 2^FeatureCount entries");
+
+public:
+    // defines[i] is the name of the macro for feature bit i
+    ShaderVariants(const char* vertexPath, const char* fragmentPath, const char* const (&defines)[FeatureCount], ProgramCache* cache = NULL)
+        : defines(defines), cache(cache), table(1u << FeatureCount)
+    {
+        vertexSource = readSource(vertexPath);
+        fragmentSource = readSource(fragmentPath);
+    }
+    // the same from sources in memory, e.g. the ones of an AssetPack
+    // ------------------------------------------------------------------------
+    static ShaderVariants fromSource(const std::string& vertexSource, const std::string& fragmentSource,
+                                     const char* const (&defines)[FeatureCount], ProgramCache* cache = NULL)
+    {
+        ShaderVariants variants(defines, cache);
+        variants.vertexSource = vertexSource;
+        variants.fragmentSource = fragmentSource;
+        return variants;
+    }
+
+    // returns the variant for the feature set, compiling it on first use
+    // ------------------------------------------------------------------------
+    Shader& get(Features features)
+    {
+        unsigned int key = variantKey(features) & ((1u << FeatureCount) - 1);
+        if (!table[key])
+        {
+            std::string header = defineHeader(features);
+            table[key].reset(new Shader(Shader::fromSource(injectShaderDefines(vertexSource, header), injectShaderDefines(fragmentSource, header), cache)));
+        }
+        return *table[key];
+    }
+    // variants with any of features get "#version <version>" (e.g. "430 core") instead of the sources' #version;
+    // call before the first get()
+    // ------------------------------------------------------------------------
+    void requireVersion(Features features, const char* version)
+    {
+        versionFeatures = variantKey(features);
+        versionLine = std::string("#version ") + version + "\n";
+    }
+    // the #define lines of a feature set, as get() inserts them (e.g. for a HotReloader watching a variant),
+    // after the #version line that replaces the sources' one if requireVersion() asked for it
+    // ------------------------------------------------------------------------
+    std::string defineHeader(Features features) const
+    {
+        unsigned int key = variantKey(features) & ((1u << FeatureCount) - 1);
+        std::string header;
+        if (key & versionFeatures)
+            header = versionLine;
+        for (unsigned int i = 0; i < FeatureCount; i++)
+            if (key & (1u << i))
+                header += std::string("#define ") + defines[i] + " 1\n";
+        return header;
+    }
+    // whether the variant was compiled already
+    // ------------------------------------------------------------------------
+    bool compiled(Features features) const
+    {
+        return table[variantKey(features) & ((1u << FeatureCount) - 1)] != nullptr;
+    }
+    // deletes the programs of every compiled variant; call before the context is destroyed
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (size_t i = 0; i < table.size(); i++)
+        {
+            if (table[i])
+                glDeleteProgram(table[i]->ID);
+            table[i].reset();
+        }
+    }
+
+private:
+    const char* const (&defines)[FeatureCount];
+    ProgramCache* cache;
+    std::string vertexSource, fragmentSource;
+    unsigned int versionFeatures = 0;
+    std::string versionLine;
+    std::vector<std::unique_ptr<Shader> > table;
+
+    ShaderVariants(const char* const (&defines)[FeatureCount], ProgramCache* cache)
+        : defines(defines), cache(cache), table(1u << FeatureCount)
+    {
+    }
+
+    // ------------------------------------------------------------------------
+    static std::string readSource(const char* path)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << path << std::endl;
+            return std::string();
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+};
+#endif
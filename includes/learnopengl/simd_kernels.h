@@ -0,0 +1,537 @@
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include <learnopengl/vertex_format.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_TARGET(isa)
+#else
+#include <cpuid.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// the instruction sets the kernels are written for; every build has SIMD_SCALAR, the others depend on the CPU
+enum SimdIsa
+{
+    SIMD_SCALAR,
+    SIMD_SSE41,
+    SIMD_AVX2, // with FMA and F16C, which every AVX2 CPU has
+    SIMD_NEON, // AArch64, where it is always there
+    SIMD_ISA_COUNT
+};
+const char* const simdIsaNames[SIMD_ISA_COUNT] = { "scalar", "sse4.1", "avx2", "neon" };
+
+// 4x4 matrices as structure of arrays: m[e][i] is element e of matrix i, column major (e = column * 4 + row),
+// so a SIMD register holds the same element of 4 or 8 consecutive matrices
+struct Mat4SoA
+{
+    float* m[16];
+
+    // the same arrays, starting at matrix first
+    // ------------------------------------------------------------------------
+    Mat4SoA offset(size_t first) const
+    {
+        Mat4SoA shifted;
+        for (int e = 0; e < 16; e++)
+            shifted.m[e] = m[e] + first;
+        return shifted;
+    }
+};
+
+// bounding spheres as structure of arrays
+struct SphereSoA
+{
+    float* x;
+    float* y;
+    float* z;
+    float* radius;
+
+    // ------------------------------------------------------------------------
+    SphereSoA offset(size_t first) const
+    {
+        SphereSoA shifted = { x + first, y + first, z + first, radius + first };
+        return shifted;
+    }
+};
+
+// The scalar reference of every kernel: the results the SIMD versions are validated against (tools/simd_benchmark),
+// and what they run for the elements left over at the end of an array.
+struct ScalarKernels
+{
+    // out[i] = a * b[i], e.g. a view-projection times the model matrix of every instance; out may be b
+    // ------------------------------------------------------------------------
+    static void multiplyMat4(const float a[16], const Mat4SoA& b, const Mat4SoA& out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            float r[16];
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                    r[column * 4 + row] = a[row] * b.m[column * 4][i] + a[4 + row] * b.m[column * 4 + 1][i]
+                                        + a[8 + row] * b.m[column * 4 + 2][i] + a[12 + row] * b.m[column * 4 + 3][i];
+            for (int e = 0; e < 16; e++)
+                out.m[e][i] = r[e];
+        }
+    }
+    // moves every sphere by its own matrix (an affine one, e.g. the model matrix of the instance) and scales its
+    // radius by the largest axis scale of the matrix, so the result still encloses the transformed object
+    // ------------------------------------------------------------------------
+    static void transformSpheres(const Mat4SoA& models, const SphereSoA& spheres, const SphereSoA& out, size_t count)
+    {
+        const float* const* m = models.m;
+        for (size_t i = 0; i < count; i++)
+        {
+            float x = spheres.x[i], y = spheres.y[i], z = spheres.z[i];
+            float scaleX = m[0][i] * m[0][i] + m[1][i] * m[1][i] + m[2][i] * m[2][i];
+            float scaleY = m[4][i] * m[4][i] + m[5][i] * m[5][i] + m[6][i] * m[6][i];
+            float scaleZ = m[8][i] * m[8][i] + m[9][i] * m[9][i] + m[10][i] * m[10][i];
+            out.x[i] = m[0][i] * x + m[4][i] * y + m[8][i] * z + m[12][i];
+            out.y[i] = m[1][i] * x + m[5][i] * y + m[9][i] * z + m[13][i];
+            out.z[i] = m[2][i] * x + m[6][i] * y + m[10][i] * z + m[14][i];
+            out.radius[i] = spheres.radius[i] * std::sqrt(std::max(scaleX, std::max(scaleY, scaleZ)));
+        }
+    }
+    // packHalf() (learnopengl/vertex_format.h) of every value
+    // ------------------------------------------------------------------------
+    static void packHalf(const float* values, unsigned short* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = ::packHalf(values[i]);
+    }
+    // ------------------------------------------------------------------------
+    static void packUnorm8(const float* values, unsigned char* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = ::packUnorm8(values[i]);
+    }
+    // ------------------------------------------------------------------------
+    static void packUnorm16(const float* values, unsigned short* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = ::packUnorm16(values[i]);
+    }
+};
+
+#ifdef SIMD_KERNELS_X86
+// SSE4.1, 4 elements at a time. The unorm packing gives exactly the scalar results; the half packing rounds ties
+// to even like the hardware conversions, where packHalf() rounds them away from zero (1 ulp on exact ties only).
+struct Sse41Kernels
+{
+    SIMD_TARGET("sse4.1")
+    static void multiplyMat4(const float a[16], const Mat4SoA& b, const Mat4SoA& out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 source[16];
+            for (int e = 0; e < 16; e++)
+                source[e] = _mm_loadu_ps(b.m[e] + i);
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                {
+                    __m128 sum = _mm_mul_ps(_mm_set1_ps(a[row]), source[column * 4]);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[4 + row]), source[column * 4 + 1]));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[8 + row]), source[column * 4 + 2]));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(a[12 + row]), source[column * 4 + 3]));
+                    _mm_storeu_ps(out.m[column * 4 + row] + i, sum);
+                }
+        }
+        ScalarKernels::multiplyMat4(a, b.offset(i), out.offset(i), count - i);
+    }
+    SIMD_TARGET("sse4.1")
+    static void transformSpheres(const Mat4SoA& models, const SphereSoA& spheres, const SphereSoA& out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 m[16];
+            for (int e = 0; e < 16; e++)
+                m[e] = _mm_loadu_ps(models.m[e] + i);
+            __m128 x = _mm_loadu_ps(spheres.x + i), y = _mm_loadu_ps(spheres.y + i), z = _mm_loadu_ps(spheres.z + i);
+            __m128 scale = _mm_max_ps(axisScale(m[0], m[1], m[2]), _mm_max_ps(axisScale(m[4], m[5], m[6]), axisScale(m[8], m[9], m[10])));
+            _mm_storeu_ps(out.x + i, transform(m[0], m[4], m[8], m[12], x, y, z));
+            _mm_storeu_ps(out.y + i, transform(m[1], m[5], m[9], m[13], x, y, z));
+            _mm_storeu_ps(out.z + i, transform(m[2], m[6], m[10], m[14], x, y, z));
+            _mm_storeu_ps(out.radius + i, _mm_mul_ps(_mm_loadu_ps(spheres.radius + i), _mm_sqrt_ps(scale)));
+        }
+        ScalarKernels::transformSpheres(models.offset(i), spheres.offset(i), out.offset(i), count - i);
+    }
+    // the float to half conversion in integer arithmetic (F. Giesen's float_to_half_fast3 SSE2 version)
+    SIMD_TARGET("sse4.1")
+    static void packHalf(const float* values, unsigned short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i low = halves(_mm_loadu_ps(values + i)), high = halves(_mm_loadu_ps(values + i + 4));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(low, high));
+        }
+        ScalarKernels::packHalf(values + i, out + i, count - i);
+    }
+    SIMD_TARGET("sse4.1")
+    static void packUnorm8(const float* values, unsigned char* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i a = unorm(_mm_loadu_ps(values + i), 255.0f), b = unorm(_mm_loadu_ps(values + i + 4), 255.0f);
+            __m128i c = unorm(_mm_loadu_ps(values + i + 8), 255.0f), d = unorm(_mm_loadu_ps(values + i + 12), 255.0f);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi16(_mm_packus_epi32(a, b), _mm_packus_epi32(c, d)));
+        }
+        ScalarKernels::packUnorm8(values + i, out + i, count - i);
+    }
+    SIMD_TARGET("sse4.1")
+    static void packUnorm16(const float* values, unsigned short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i low = unorm(_mm_loadu_ps(values + i), 65535.0f), high = unorm(_mm_loadu_ps(values + i + 4), 65535.0f);
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packus_epi32(low, high));
+        }
+        ScalarKernels::packUnorm16(values + i, out + i, count - i);
+    }
+
+private:
+    SIMD_TARGET("sse4.1")
+    static __m128 axisScale(__m128 x, __m128 y, __m128 z)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+    }
+    SIMD_TARGET("sse4.1")
+    static __m128 transform(__m128 mx, __m128 my, __m128 mz, __m128 mw, __m128 x, __m128 y, __m128 z)
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, x), _mm_mul_ps(my, y)), _mm_mul_ps(mz, z)), mw);
+    }
+    // clamp to [0, 1], scale and round like packUnorm8/16: the same float operations, so the same results
+    SIMD_TARGET("sse4.1")
+    static __m128i unorm(__m128 value, float scale)
+    {
+        value = _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(scale)), _mm_set1_ps(0.5f)));
+    }
+    // 4 halves, sign extended to 32 bits so _mm_packs_epi32 keeps them intact
+    SIMD_TARGET("sse4.1")
+    static __m128i halves(__m128 value)
+    {
+        const __m128i maximum = _mm_set1_epi32((127 + 16) << 23);        // this and above becomes infinity
+        const __m128i minimumNormal = _mm_set1_epi32((127 - 14) << 23);  // below this the half is a denormal
+        const __m128i denormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i normalBias = _mm_set1_epi32(0xFFF - ((127 - 15) << 23)); // rebias the exponent, round
+        __m128 sign = _mm_and_ps(value, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u)));
+        __m128 absolute = _mm_xor_ps(value, sign);
+        __m128i bits = _mm_castps_si128(absolute);
+        __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absolute, absolute));
+        __m128i isFinite = _mm_cmpgt_epi32(maximum, bits);
+        __m128i special = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7C00));
+        __m128i isDenormal = _mm_cmpgt_epi32(minimumNormal, bits);
+        // denormal results: the float addition shifts the mantissa into place and rounds it
+        __m128i denormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absolute, _mm_castsi128_ps(denormalMagic))), denormalMagic);
+        // normal results: rebias, round to nearest even and shift
+        __m128i odd = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+        __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(bits, normalBias), odd), 13);
+        __m128i finite = _mm_blendv_epi8(normal, denormal, isDenormal);
+        __m128i half = _mm_blendv_epi8(special, finite, isFinite);
+        return _mm_or_si128(half, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+    }
+};
+
+// AVX2, 8 elements at a time; the matrix kernels use FMA, so their results differ from the scalar ones in the
+// last bits, and the half packing uses the F16C conversion instructions.
+struct Avx2Kernels
+{
+    SIMD_TARGET("avx2,fma")
+    static void multiplyMat4(const float a[16], const Mat4SoA& b, const Mat4SoA& out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 source[16];
+            for (int e = 0; e < 16; e++)
+                source[e] = _mm256_loadu_ps(b.m[e] + i);
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                {
+                    __m256 sum = _mm256_mul_ps(_mm256_set1_ps(a[row]), source[column * 4]);
+                    sum = _mm256_fmadd_ps(_mm256_set1_ps(a[4 + row]), source[column * 4 + 1], sum);
+                    sum = _mm256_fmadd_ps(_mm256_set1_ps(a[8 + row]), source[column * 4 + 2], sum);
+                    sum = _mm256_fmadd_ps(_mm256_set1_ps(a[12 + row]), source[column * 4 + 3], sum);
+                    _mm256_storeu_ps(out.m[column * 4 + row] + i, sum);
+                }
+        }
+        ScalarKernels::multiplyMat4(a, b.offset(i), out.offset(i), count - i);
+    }
+    SIMD_TARGET("avx2,fma")
+    static void transformSpheres(const Mat4SoA& models, const SphereSoA& spheres, const SphereSoA& out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 m[16];
+            for (int e = 0; e < 16; e++)
+                m[e] = _mm256_loadu_ps(models.m[e] + i);
+            __m256 x = _mm256_loadu_ps(spheres.x + i), y = _mm256_loadu_ps(spheres.y + i), z = _mm256_loadu_ps(spheres.z + i);
+            __m256 scale = _mm256_max_ps(axisScale(m[0], m[1], m[2]), _mm256_max_ps(axisScale(m[4], m[5], m[6]), axisScale(m[8], m[9], m[10])));
+            _mm256_storeu_ps(out.x + i, transform(m[0], m[4], m[8], m[12], x, y, z));
+            _mm256_storeu_ps(out.y + i, transform(m[1], m[5], m[9], m[13], x, y, z));
+            _mm256_storeu_ps(out.z + i, transform(m[2], m[6], m[10], m[14], x, y, z));
+            _mm256_storeu_ps(out.radius + i, _mm256_mul_ps(_mm256_loadu_ps(spheres.radius + i), _mm256_sqrt_ps(scale)));
+        }
+        ScalarKernels::transformSpheres(models.offset(i), spheres.offset(i), out.offset(i), count - i);
+    }
+    SIMD_TARGET("avx2,f16c")
+    static void packHalf(const float* values, unsigned short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm_storeu_si128((__m128i*)(out + i), _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT));
+        ScalarKernels::packHalf(values + i, out + i, count - i);
+    }
+    SIMD_TARGET("avx2")
+    static void packUnorm8(const float* values, unsigned char* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 32 <= count; i += 32)
+        {
+            // the packs work within 128 bit lanes; the permute puts the 32 bytes back in order
+            __m256i ab = _mm256_packus_epi32(unorm(_mm256_loadu_ps(values + i), 255.0f), unorm(_mm256_loadu_ps(values + i + 8), 255.0f));
+            __m256i cd = _mm256_packus_epi32(unorm(_mm256_loadu_ps(values + i + 16), 255.0f), unorm(_mm256_loadu_ps(values + i + 24), 255.0f));
+            __m256i bytes = _mm256_packus_epi16(ab, cd);
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7)));
+        }
+        ScalarKernels::packUnorm8(values + i, out + i, count - i);
+    }
+    SIMD_TARGET("avx2")
+    static void packUnorm16(const float* values, unsigned short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            __m256i words = _mm256_packus_epi32(unorm(_mm256_loadu_ps(values + i), 65535.0f), unorm(_mm256_loadu_ps(values + i + 8), 65535.0f));
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_permute4x64_epi64(words, 0xD8));
+        }
+        ScalarKernels::packUnorm16(values + i, out + i, count - i);
+    }
+
+private:
+    SIMD_TARGET("avx2,fma")
+    static __m256 axisScale(__m256 x, __m256 y, __m256 z)
+    {
+        return _mm256_fmadd_ps(z, z, _mm256_fmadd_ps(y, y, _mm256_mul_ps(x, x)));
+    }
+    SIMD_TARGET("avx2,fma")
+    static __m256 transform(__m256 mx, __m256 my, __m256 mz, __m256 mw, __m256 x, __m256 y, __m256 z)
+    {
+        return _mm256_fmadd_ps(mz, z, _mm256_fmadd_ps(my, y, _mm256_fmadd_ps(mx, x, mw)));
+    }
+    // a separate multiply and add (no FMA), so the rounding matches packUnorm8/16 exactly
+    SIMD_TARGET("avx2")
+    static __m256i unorm(__m256 value, float scale)
+    {
+        value = _mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(scale)), _mm256_set1_ps(0.5f)));
+    }
+};
+
+// ------------------------------------------------------------------------
+inline void simdCpuid(unsigned int leaf, unsigned int subleaf, unsigned int registers[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    __cpuidex((int*)registers, (int)leaf, (int)subleaf);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+#endif
+
+#ifdef SIMD_KERNELS_NEON
+// NEON on AArch64, 4 elements at a time; the matrix kernels fuse their multiply-adds like the AVX2 ones, and the
+// half packing is the hardware conversion (round to nearest even).
+struct NeonKernels
+{
+    static void multiplyMat4(const float a[16], const Mat4SoA& b, const Mat4SoA& out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t source[16];
+            for (int e = 0; e < 16; e++)
+                source[e] = vld1q_f32(b.m[e] + i);
+            for (int column = 0; column < 4; column++)
+                for (int row = 0; row < 4; row++)
+                {
+                    float32x4_t sum = vmulq_n_f32(source[column * 4], a[row]);
+                    sum = vfmaq_n_f32(sum, source[column * 4 + 1], a[4 + row]);
+                    sum = vfmaq_n_f32(sum, source[column * 4 + 2], a[8 + row]);
+                    sum = vfmaq_n_f32(sum, source[column * 4 + 3], a[12 + row]);
+                    vst1q_f32(out.m[column * 4 + row] + i, sum);
+                }
+        }
+        ScalarKernels::multiplyMat4(a, b.offset(i), out.offset(i), count - i);
+    }
+    static void transformSpheres(const Mat4SoA& models, const SphereSoA& spheres, const SphereSoA& out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t m[16];
+            for (int e = 0; e < 16; e++)
+                m[e] = vld1q_f32(models.m[e] + i);
+            float32x4_t x = vld1q_f32(spheres.x + i), y = vld1q_f32(spheres.y + i), z = vld1q_f32(spheres.z + i);
+            float32x4_t scale = vmaxq_f32(axisScale(m[0], m[1], m[2]), vmaxq_f32(axisScale(m[4], m[5], m[6]), axisScale(m[8], m[9], m[10])));
+            vst1q_f32(out.x + i, vfmaq_f32(vfmaq_f32(vfmaq_f32(m[12], m[0], x), m[4], y), m[8], z));
+            vst1q_f32(out.y + i, vfmaq_f32(vfmaq_f32(vfmaq_f32(m[13], m[1], x), m[5], y), m[9], z));
+            vst1q_f32(out.z + i, vfmaq_f32(vfmaq_f32(vfmaq_f32(m[14], m[2], x), m[6], y), m[10], z));
+            vst1q_f32(out.radius + i, vmulq_f32(vld1q_f32(spheres.radius + i), vsqrtq_f32(scale)));
+        }
+        ScalarKernels::transformSpheres(models.offset(i), spheres.offset(i), out.offset(i), count - i);
+    }
+    static void packHalf(const float* values, unsigned short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            vst1_u16(out + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(values + i))));
+        ScalarKernels::packHalf(values + i, out + i, count - i);
+    }
+    static void packUnorm8(const float* values, unsigned char* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            uint16x8_t words = vcombine_u16(vqmovn_u32(unorm(vld1q_f32(values + i), 255.0f)), vqmovn_u32(unorm(vld1q_f32(values + i + 4), 255.0f)));
+            vst1_u8(out + i, vqmovn_u16(words));
+        }
+        ScalarKernels::packUnorm8(values + i, out + i, count - i);
+    }
+    static void packUnorm16(const float* values, unsigned short* out, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            vst1_u16(out + i, vqmovn_u32(unorm(vld1q_f32(values + i), 65535.0f)));
+        ScalarKernels::packUnorm16(values + i, out + i, count - i);
+    }
+
+private:
+    static float32x4_t axisScale(float32x4_t x, float32x4_t y, float32x4_t z)
+    {
+        return vfmaq_f32(vfmaq_f32(vmulq_f32(x, x), y, y), z, z);
+    }
+    static uint32x4_t unorm(float32x4_t value, float scale)
+    {
+        value = vminq_f32(vmaxq_f32(value, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+        return vcvtq_u32_f32(vaddq_f32(vmulq_n_f32(value, scale), vdupq_n_f32(0.5f)));
+    }
+};
+#endif
+
+// whether this CPU (and the OS, for the AVX registers) can run the kernels of isa
+// ------------------------------------------------------------------------
+inline bool simdIsaSupported(SimdIsa isa)
+{
+    switch (isa)
+    {
+    case SIMD_SCALAR:
+        return true;
+#ifdef SIMD_KERNELS_X86
+    case SIMD_SSE41:
+    case SIMD_AVX2:
+    {
+        unsigned int registers[4];
+        simdCpuid(0, 0, registers);
+        unsigned int maxLeaf = registers[0];
+        simdCpuid(1, 0, registers);
+        unsigned int features = registers[2];
+        if (isa == SIMD_SSE41)
+            return (features >> 19) & 1u;
+        bool fma = (features >> 12) & 1u, osxsave = (features >> 27) & 1u, avx = (features >> 28) & 1u, f16c = (features >> 29) & 1u;
+        if (!fma || !osxsave || !avx || !f16c || maxLeaf < 7)
+            return false;
+        // the OS has to save the ymm registers on a context switch
+#if defined(_MSC_VER) && !defined(__clang__)
+        unsigned long long xcr0 = _xgetbv(0);
+#else
+        unsigned int xcr0Low, xcr0High;
+        __asm__("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+        unsigned long long xcr0 = xcr0Low;
+#endif
+        if ((xcr0 & 6) != 6)
+            return false;
+        simdCpuid(7, 0, registers);
+        return (registers[1] >> 5) & 1u;
+    }
+#endif
+#ifdef SIMD_KERNELS_NEON
+    case SIMD_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+// The kernels of one instruction set, called through function pointers so the choice is made once at runtime
+// instead of at compile time: simdKernels() picks the widest set the CPU supports, simdKernels(isa) a given one
+// (for benchmarks and validation). All of them take unaligned arrays, and the output of a kernel may be its input.
+struct SimdKernels
+{
+    SimdIsa isa;
+    void (*multiplyMat4)(const float a[16], const Mat4SoA& b, const Mat4SoA& out, size_t count);
+    void (*transformSpheres)(const Mat4SoA& models, const SphereSoA& spheres, const SphereSoA& out, size_t count);
+    void (*packHalf)(const float* values, unsigned short* out, size_t count);
+    void (*packUnorm8)(const float* values, unsigned char* out, size_t count);
+    void (*packUnorm16)(const float* values, unsigned short* out, size_t count);
+
+    // ------------------------------------------------------------------------
+    const char* name() const
+    {
+        return simdIsaNames[isa];
+    }
+};
+
+// the kernels of isa, which has to be supported (simdIsaSupported()); unsupported ones give the scalar kernels
+// ------------------------------------------------------------------------
+inline const SimdKernels& simdKernels(SimdIsa isa)
+{
+    static const SimdKernels scalar = { SIMD_SCALAR, ScalarKernels::multiplyMat4, ScalarKernels::transformSpheres,
+                                        ScalarKernels::packHalf, ScalarKernels::packUnorm8, ScalarKernels::packUnorm16 };
+#ifdef SIMD_KERNELS_X86
+    static const SimdKernels sse41 = { SIMD_SSE41, Sse41Kernels::multiplyMat4, Sse41Kernels::transformSpheres,
+                                       Sse41Kernels::packHalf, Sse41Kernels::packUnorm8, Sse41Kernels::packUnorm16 };
+    static const SimdKernels avx2 = { SIMD_AVX2, Avx2Kernels::multiplyMat4, Avx2Kernels::transformSpheres,
+                                      Avx2Kernels::packHalf, Avx2Kernels::packUnorm8, Avx2Kernels::packUnorm16 };
+    if (isa == SIMD_AVX2 && simdIsaSupported(SIMD_AVX2))
+        return avx2;
+    if (isa == SIMD_SSE41 && simdIsaSupported(SIMD_SSE41))
+        return sse41;
+#endif
+#ifdef SIMD_KERNELS_NEON
+    static const SimdKernels neon = { SIMD_NEON, NeonKernels::multiplyMat4, NeonKernels::transformSpheres,
+                                      NeonKernels::packHalf, NeonKernels::packUnorm8, NeonKernels::packUnorm16 };
+    if (isa == SIMD_NEON)
+        return neon;
+#endif
+    return scalar;
+}
+// the widest kernels this CPU runs, detected on the first call
+// ------------------------------------------------------------------------
+inline const SimdKernels& simdKernels()
+{
+    static const SimdKernels& best = simdKernels(simdIsaSupported(SIMD_AVX2) ? SIMD_AVX2
+                                               : simdIsaSupported(SIMD_SSE41) ? SIMD_SSE41
+                                               : simdIsaSupported(SIMD_NEON) ? SIMD_NEON : SIMD_SCALAR);
+    return best;
+}
+#endif
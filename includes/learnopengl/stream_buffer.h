@@ -0,0 +1,163 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+// Ring buffer for vertex and index data that is rewritten every frame.
+// - Re-uploading with glBufferSubData makes the driver wait until the GPU stopped reading the old data (or
+//   copy it aside); orphaning with glBufferData(NULL) avoids the wait but allocates new storage every time.
+//   This buffer instead is split into regionCount regions, by default three: the CPU writes one while the
+//   GPU still reads the previous ones. A fence placed by endFrame() marks when the GPU is done with a
+//   region, and map() only waits on it when the CPU comes around to that region again.
+// - With OpenGL 4.4 (or ARB_buffer_storage) the storage is immutable and mapped once, persistently and
+//   coherently, so map() is a pointer bump. Otherwise every map() maps its range with
+//   glMapBufferRange(GL_MAP_UNSYNCHRONIZED_BIT), which is safe because the fences already did the syncing.
+//   Pass persistentMapping false to take the second path regardless, e.g. while a GLCapture records, since the
+//   capture only sees what was written through a mapping when it is unmapped.
+// - Bind ID as the GL_ARRAY_BUFFER and/or GL_ELEMENT_ARRAY_BUFFER of a VAO, with the attribute pointers at
+//   offset 0, and draw with the offset() of the data: as the first vertex of glDrawArrays, as the indices
+//   pointer of glDrawElements and as the base vertex of glDrawElementsBaseVertex.
+// Usage, every frame:
+//     float* data = (float*)stream.map(size, stride);
+//     ... write size bytes to data ...
+//     stream.unmap();
+//     glDrawArrays(GL_TRIANGLES, stream.offset() / stride, count);
+//     stream.endFrame();
+class StreamBuffer
+{
+public:
+    unsigned int ID;
+    int stalls = 0; // how often map() had to wait for the GPU, i.e. the ring was too short
+
+    StreamBuffer(size_t regionSize, int regionCount = 3, bool persistentMapping = true)
+        : regionSize(regionSize), regionCount(regionCount), region(0), cursor(0), lastOffset(0), waited(false), mapped(NULL),
+          fences(regionCount, (GLsync)0)
+    {
+        persistent = persistentMapping && (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage);
+        // GL_COPY_WRITE_BUFFER, because binding GL_ELEMENT_ARRAY_BUFFER would change the bound VAO
+        glGenBuffers(1, &ID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        if (persistent)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_COPY_WRITE_BUFFER, regionCount * regionSize, NULL, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, regionCount * regionSize, flags);
+        }
+        else
+        {
+            glBufferData(GL_COPY_WRITE_BUFFER, regionCount * regionSize, NULL, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    // a copy would share the buffer and its fences, and release() both
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // returns room for size bytes in the region of this frame, starting at a multiple of alignment
+    // (e.g. the vertex stride), or NULL if the region is full
+    // ------------------------------------------------------------------------
+    void* map(size_t size, size_t alignment = 4)
+    {
+        if (!waited)
+            waitForRegion();
+        size_t start = region * regionSize;
+        size_t offset = (start + cursor + alignment - 1) / alignment * alignment;
+        if (offset + size > start + regionSize)
+        {
+            std::cout << "ERROR::STREAM_BUFFER::REGION_FULL: " << size << " bytes requested, region size is " << regionSize << std::endl;
+            return NULL;
+        }
+        cursor = offset + size - start;
+        lastOffset = offset;
+        if (persistent)
+            return mapped + offset;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        return glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+    // call once the data returned by map() is written; nothing to do for a persistent mapping
+    // ------------------------------------------------------------------------
+    void unmap()
+    {
+        if (persistent)
+            return;
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    // byte offset of the data returned by the last map(), for the draw call
+    // ------------------------------------------------------------------------
+    size_t offset() const
+    {
+        return lastOffset;
+    }
+    // call after the last draw call that reads this frame's data: fences the region and moves on to the next one
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        if (cursor == 0)
+            return; // nothing written, the region stays free
+        if (fences[region])
+            glDeleteSync(fences[region]);
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        region = (region + 1) % regionCount;
+        cursor = 0;
+        waited = false;
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (int i = 0; i < regionCount; i++)
+        {
+            if (fences[i])
+                glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+        if (persistent && mapped)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, ID);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+        mapped = NULL;
+        glDeleteBuffers(1, &ID);
+        ID = 0;
+    }
+
+private:
+    size_t regionSize;
+    int regionCount;
+    int region;        // the region written this frame
+    size_t cursor;     // bytes of it already handed out
+    size_t lastOffset;
+    bool waited;       // whether the fence of the region was already checked this frame
+    bool persistent;
+    unsigned char* mapped;
+    std::vector<GLsync> fences;
+
+    // blocks until the GPU finished reading the current region the last time around
+    // ------------------------------------------------------------------------
+    void waitForRegion()
+    {
+        waited = true;
+        GLsync fence = fences[region];
+        if (!fence)
+            return;
+        if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            stalls++;
+            // flush on the first wait, otherwise the fence itself may never reach the GPU
+            GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED)
+                flags = 0;
+        }
+        glDeleteSync(fence);
+        fences[region] = 0;
+    }
+};
+#endif
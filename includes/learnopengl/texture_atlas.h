@@ -0,0 +1,377 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// where one image ended up: the array layer and the u, v, width, height of its rectangle in that layer
+struct AtlasRegion
+{
+    std::string name;
+    int layer;
+    float uvRect[4];
+};
+
+// the packed pixels of every layer (RGBA8, layer after layer, rows in the order the images were given) and the
+// regions of the images, in the order they were added
+struct AtlasData
+{
+    int size = 0;      // width and height of a layer
+    int layers = 0;
+    int padding = 0;
+    int mipLevels = 1; // levels that are free of bleeding between the images, see AtlasBuilder
+    std::vector<unsigned char> pixels;
+    std::vector<AtlasRegion> regions;
+};
+
+// Skyline bottom-left rectangle packer: the free space of a page is described by its top contour (the skyline),
+// and every rectangle goes where its bottom edge ends up lowest. Quick, and dense for the mix of sizes textures have.
+class SkylinePacker
+{
+public:
+    SkylinePacker(int width, int height) : width(width), height(height)
+    {
+        Segment floor = { 0, 0, width };
+        skyline.push_back(floor);
+    }
+
+    // finds room for a w x h rectangle; returns false if the page is full
+    // ------------------------------------------------------------------------
+    bool insert(int w, int h, int& x, int& y)
+    {
+        int bestY = INT_MAX, bestX = 0;
+        size_t best = skyline.size();
+        for (size_t i = 0; i < skyline.size() && skyline[i].x + w <= width; i++)
+        {
+            // the rectangle rests on the highest segment below it
+            int top = 0;
+            for (size_t j = i; j < skyline.size() && skyline[j].x < skyline[i].x + w; j++)
+                top = std::max(top, skyline[j].y);
+            if (top + h <= height && top < bestY)
+            {
+                bestY = top;
+                bestX = skyline[i].x;
+                best = i;
+            }
+        }
+        if (best == skyline.size())
+            return false;
+
+        Segment placed = { bestX, bestY + h, w };
+        skyline.insert(skyline.begin() + best, placed);
+        // the segments below the new one disappear, a partly covered one is shortened
+        for (size_t i = best + 1; i < skyline.size();)
+        {
+            Segment& segment = skyline[i];
+            int end = segment.x + segment.width;
+            if (segment.x >= placed.x + placed.width)
+                break;
+            if (end <= placed.x + placed.width)
+            {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+            segment.width = end - (placed.x + placed.width);
+            segment.x = placed.x + placed.width;
+            break;
+        }
+        for (size_t i = 0; i + 1 < skyline.size();)
+        {
+            if (skyline[i].y == skyline[i + 1].y)
+            {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+            }
+            else
+                i++;
+        }
+        x = bestX;
+        y = bestY;
+        return true;
+    }
+
+private:
+    struct Segment
+    {
+        int x, y, width;
+    };
+
+    int width, height;
+    std::vector<Segment> skyline;
+};
+
+// Packs RGBA8 images into the layers of an array texture, so draws with different textures no longer need
+// different binds: they sample one GL_TEXTURE_2D_ARRAY and pick their image with a layer and a uv rectangle.
+// - Every layer is a skyline-packed atlas page; an image as large as a layer simply fills one on its own, so the
+//   same builder makes a plain texture array out of equally sized images.
+// - Each image gets a border of padding texels that repeats its edge texels, and starts at a multiple of padding.
+//   padding is rounded up to a power of two and the layer size down to a multiple of it. At mip level
+//   log2(padding) one texel still covers a single image and its border, so the mip chain is cut off there
+//   (mipLevels) and the images never bleed into each other. loadAtlas() refuses files that break either rule.
+// - pack() runs on the CPU only, so tools/atlas_packer can do it at build time and write the result with
+//   saveAtlas(); TextureAtlas::create() then uploads it, whether it was packed now or loaded from a file.
+class AtlasBuilder
+{
+public:
+    AtlasBuilder(int layerSize = 2048, int padding = 4) : padding(1)
+    {
+        while (this->padding < padding)
+            this->padding <<= 1;
+        this->layerSize = std::max(layerSize / this->padding, 1) * this->padding;
+    }
+
+    // copies the image; rgba holds width * height * 4 bytes
+    // ------------------------------------------------------------------------
+    void add(const std::string& name, int width, int height, const unsigned char* rgba)
+    {
+        Image image;
+        image.name = name;
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(rgba, rgba + (size_t)width * height * 4);
+        images.push_back(image);
+    }
+    // ------------------------------------------------------------------------
+    size_t imageCount() const
+    {
+        return images.size();
+    }
+    // packs every image added so far, the tallest first; returns false if an image does not fit in a layer
+    // ------------------------------------------------------------------------
+    bool pack(AtlasData& atlas) const
+    {
+        atlas = AtlasData();
+        atlas.size = layerSize;
+        atlas.padding = padding;
+        for (int p = padding; p > 1; p >>= 1)
+            atlas.mipLevels++;
+        atlas.regions.resize(images.size());
+
+        std::vector<size_t> order(images.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return images[a].height > images[b].height;
+        });
+
+        std::vector<SkylinePacker> pages;
+        for (size_t n = 0; n < order.size(); n++)
+        {
+            const Image& image = images[order[n]];
+            int w = alignUp(image.width + 2 * padding), h = alignUp(image.height + 2 * padding);
+            if (w > layerSize || h > layerSize)
+            {
+                std::cout << "ERROR::TEXTURE_ATLAS::IMAGE_TOO_LARGE: " << image.name << " (" << image.width << "x" << image.height
+                          << ") does not fit in a " << layerSize << " layer" << std::endl;
+                return false;
+            }
+            // the free cells are multiples of padding, so the packer works in those
+            int x = 0, y = 0;
+            size_t layer = 0;
+            while (layer < pages.size() && !pages[layer].insert(w / padding, h / padding, x, y))
+                layer++;
+            if (layer == pages.size())
+            {
+                pages.push_back(SkylinePacker(layerSize / padding, layerSize / padding));
+                pages.back().insert(w / padding, h / padding, x, y);
+                atlas.pixels.resize(pages.size() * (size_t)layerSize * layerSize * 4, 0);
+            }
+            x *= padding;
+            y *= padding;
+            copyPadded(image, &atlas.pixels[layer * (size_t)layerSize * layerSize * 4], x, y);
+
+            AtlasRegion& region = atlas.regions[order[n]];
+            region.name = image.name;
+            region.layer = (int)layer;
+            region.uvRect[0] = (float)(x + padding) / layerSize;
+            region.uvRect[1] = (float)(y + padding) / layerSize;
+            region.uvRect[2] = (float)image.width / layerSize;
+            region.uvRect[3] = (float)image.height / layerSize;
+        }
+        atlas.layers = (int)pages.size();
+        return true;
+    }
+
+private:
+    struct Image
+    {
+        std::string name;
+        int width, height;
+        std::vector<unsigned char> pixels;
+    };
+
+    int layerSize;
+    int padding;
+    std::vector<Image> images;
+
+    // ------------------------------------------------------------------------
+    int alignUp(int value) const
+    {
+        return (value + padding - 1) / padding * padding;
+    }
+    // writes the image with its edge-extended border into the layer, the border's top left corner at (x, y)
+    // ------------------------------------------------------------------------
+    void copyPadded(const Image& image, unsigned char* layer, int x, int y) const
+    {
+        for (int row = -padding; row < image.height + padding; row++)
+        {
+            int sourceRow = std::min(std::max(row, 0), image.height - 1);
+            unsigned char* destination = layer + ((size_t)(y + padding + row) * layerSize + x) * 4;
+            const unsigned char* source = &image.pixels[(size_t)sourceRow * image.width * 4];
+            for (int column = 0; column < padding; column++)
+                std::memcpy(destination + column * 4, source, 4);
+            std::memcpy(destination + padding * 4, source, (size_t)image.width * 4);
+            for (int column = 0; column < padding; column++)
+                std::memcpy(destination + (padding + image.width + column) * 4, source + (image.width - 1) * 4, 4);
+        }
+    }
+};
+
+// writes a packed atlas to a file: "LOGLATL1", the header values, the regions and the pixels, little endian
+// ------------------------------------------------------------------------
+inline bool saveAtlas(const std::string& path, const AtlasData& atlas)
+{
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::TEXTURE_ATLAS::FILE_NOT_WRITTEN: " << path << std::endl;
+        return false;
+    }
+    unsigned int header[5] = { (unsigned int)atlas.size, (unsigned int)atlas.layers, (unsigned int)atlas.padding,
+                               (unsigned int)atlas.mipLevels, (unsigned int)atlas.regions.size() };
+    file.write("LOGLATL1", 8);
+    file.write((const char*)header, sizeof(header));
+    for (size_t i = 0; i < atlas.regions.size(); i++)
+    {
+        const AtlasRegion& region = atlas.regions[i];
+        unsigned int length = (unsigned int)region.name.size();
+        file.write((const char*)&length, sizeof(length));
+        file.write(region.name.data(), length);
+        file.write((const char*)&region.layer, sizeof(region.layer));
+        file.write((const char*)region.uvRect, sizeof(region.uvRect));
+    }
+    file.write((const char*)atlas.pixels.data(), atlas.pixels.size());
+    return (bool)file;
+}
+// reads a file written by saveAtlas(); returns false if it is missing or damaged. The header is checked against
+// the file length and the context's texture limits before anything is allocated, so call with a context current.
+// ------------------------------------------------------------------------
+inline bool loadAtlas(const std::string& path, AtlasData& atlas)
+{
+    std::ifstream file(path.c_str(), std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+    unsigned long long remaining = (unsigned long long)file.tellg();
+    file.seekg(0);
+    char magic[8];
+    unsigned int header[5];
+    if (!file.read(magic, 8) || std::memcmp(magic, "LOGLATL1", 8) != 0 || !file.read((char*)header, sizeof(header)))
+    {
+        std::cout << "ERROR::TEXTURE_ATLAS::NOT_AN_ATLAS: " << path << std::endl;
+        return false;
+    }
+    remaining -= 8 + sizeof(header);
+    GLint maxSize = 0, maxLayers = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    unsigned int size = header[0], layers = header[1], padding = header[2], mipLevels = header[3];
+    // padding is a power of two that divides the layer size, and the mip chain stops at log2(padding), see AtlasBuilder
+    unsigned int expectedLevels = 1;
+    for (unsigned int p = padding; p > 1; p >>= 1)
+        expectedLevels++;
+    const unsigned long long REGION_BYTES = sizeof(unsigned int) + sizeof(int) + 4 * sizeof(float); // with an empty name
+    bool valid = size > 0 && size <= (unsigned int)maxSize && layers > 0 && layers <= (unsigned int)maxLayers &&
+                 padding > 0 && (padding & (padding - 1)) == 0 && size % padding == 0 && mipLevels == expectedLevels &&
+                 header[4] <= remaining / REGION_BYTES;
+    unsigned long long pixelBytes = (unsigned long long)size * size * layers * 4;
+    if (!valid || pixelBytes > remaining)
+    {
+        std::cout << "ERROR::TEXTURE_ATLAS::BAD_HEADER: " << path << std::endl;
+        return false;
+    }
+    atlas = AtlasData();
+    atlas.size = (int)size;
+    atlas.layers = (int)layers;
+    atlas.padding = (int)padding;
+    atlas.mipLevels = (int)mipLevels;
+    atlas.regions.resize(header[4]);
+    for (size_t i = 0; i < atlas.regions.size(); i++)
+    {
+        AtlasRegion& region = atlas.regions[i];
+        unsigned int length = 0;
+        if (!file.read((char*)&length, sizeof(length)) || length > 4096)
+        {
+            std::cout << "ERROR::TEXTURE_ATLAS::BAD_REGION: " << path << std::endl;
+            return false;
+        }
+        region.name.resize(length);
+        file.read(&region.name[0], length);
+        file.read((char*)&region.layer, sizeof(region.layer));
+        file.read((char*)region.uvRect, sizeof(region.uvRect));
+        if (!file || region.layer < 0 || region.layer >= atlas.layers)
+        {
+            std::cout << "ERROR::TEXTURE_ATLAS::BAD_REGION: " << path << std::endl;
+            return false;
+        }
+    }
+    atlas.pixels.resize((size_t)pixelBytes);
+    if (!file.read((char*)atlas.pixels.data(), atlas.pixels.size()))
+    {
+        std::cout << "ERROR::TEXTURE_ATLAS::TRUNCATED: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// A packed atlas on the GPU: one GL_TEXTURE_2D_ARRAY and the regions of its images. Bind ID to
+// GL_TEXTURE_2D_ARRAY and sample it with vec3(region.uvRect.xy + uv * region.uvRect.zw, region.layer).
+class TextureAtlas
+{
+public:
+    unsigned int ID = 0;
+    std::vector<AtlasRegion> regions;
+
+    // uploads the layers and builds the mip levels that don't bleed (see AtlasBuilder)
+    // ------------------------------------------------------------------------
+    bool create(const AtlasData& atlas)
+    {
+        if (atlas.layers == 0)
+            return false;
+        glGenTextures(1, &ID);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, atlas.size, atlas.size, atlas.layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.pixels.data());
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, atlas.mipLevels - 1);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, atlas.mipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (atlas.mipLevels > 1)
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        regions = atlas.regions;
+        return true;
+    }
+    // index of the region of the named image, or -1
+    // ------------------------------------------------------------------------
+    int find(const std::string& name) const
+    {
+        for (size_t i = 0; i < regions.size(); i++)
+            if (regions[i].name == name)
+                return (int)i;
+        return -1;
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        glDeleteTextures(1, &ID);
+        ID = 0;
+    }
+};
+#endif
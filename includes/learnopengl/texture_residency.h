@@ -0,0 +1,450 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Keeps only the mip levels of its textures on the GPU that the renderer asks for, within a video memory budget.
+// - load() returns a texture object right away that holds a grey texel, like TextureStreamer::load. A worker
+//   thread decodes the image and builds its mip chain in system memory; update() then uploads only the tail (the
+//   levels of TAIL_SIZE pixels and less) and points GL_TEXTURE_BASE_LEVEL / GL_TEXTURE_MAX_LEVEL at it, so the
+//   texture is complete and cheap from the first frame it has an image.
+// - Every frame the renderer calls request() with the size in pixels a texture covers on screen; the level that
+//   size needs is log2(texture size / screen size) + bias. update() refines the textures that have less detail
+//   than asked for by one level per frame, most recently requested first, and uploads at most uploadBytesPerFrame.
+// - A level that does not fit the budget evicts the finest level of another texture, least recently requested
+//   first, and textures with more detail than they were last asked for before those. A texture requested as
+//   recently as the one refined is never evicted for it, and the tail is never evicted at all; when nothing can
+//   go the refinement waits (budgetStalls). Evicting raises the base level and then respecifies the level with a
+//   size of 0, which gives its memory back without changing the texture object the renderer binds.
+// - The mip chains stay in system memory, so levels come back without decoding the file again.
+// - The textures belong to the caller, who deletes them (forget() them first if the manager lives on).
+class TextureResidency
+{
+public:
+    size_t budget;              // video memory all managed textures may take together, in bytes
+    size_t uploadBytesPerFrame; // mip data one update() uploads at most, so a refinement never stalls a frame
+    float bias;                 // added to the level a screen size asks for; positive trades detail for memory
+    // statistics
+    size_t peakBytes = 0;
+    unsigned long levelsUploaded = 0;
+    unsigned long levelsEvicted = 0;
+    unsigned long budgetStalls = 0; // frames in which a refinement found no room even after evicting
+
+    TextureResidency(size_t budget = 64 * 1024 * 1024, size_t uploadBytesPerFrame = 4 * 1024 * 1024)
+        : budget(budget), uploadBytesPerFrame(uploadBytesPerFrame), bias(0.0f), frame(0), totalBytes(0), stopping(false)
+    {
+        worker = std::thread(&TextureResidency::workerLoop, this);
+    }
+    ~TextureResidency()
+    {
+        stopWorker();
+    }
+    TextureResidency(const TextureResidency&) = delete;
+    TextureResidency& operator=(const TextureResidency&) = delete;
+
+    // queues an image file and returns its texture object, which holds a grey texel until update() uploads its tail
+    // ------------------------------------------------------------------------
+    unsigned int load(const std::string& path)
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const unsigned char grey[4] = { 128, 128, 128, 255 };
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        Entry& entry = entries[texture];
+        entry.texture = texture;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(Request{ texture, path });
+        }
+        requestAdded.notify_one();
+        return texture;
+    }
+    // the texture covers screenPixels pixels (along its longer side) in this frame; the largest request of a
+    // frame counts. Call while drawing, update() in the next frame acts on it
+    // ------------------------------------------------------------------------
+    void request(unsigned int texture, float screenPixels)
+    {
+        std::unordered_map<unsigned int, Entry>::iterator it = entries.find(texture);
+        if (it == entries.end())
+            return;
+        Entry& entry = it->second;
+        if (entry.lastRequest != frame)
+            entry.wantedPixels = 0.0f;
+        entry.wantedPixels = std::max(entry.wantedPixels, screenPixels);
+        entry.lastRequest = frame;
+    }
+    // uploads the tails of decoded images, refines and evicts; returns the number of levels it uploaded or evicted
+    // (all of which bind textures behind a GLState's back). Call once per frame on the GL thread
+    // ------------------------------------------------------------------------
+    int update()
+    {
+        int changes = 0;
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (int i = 0; i < MAX_DECODED_PER_FRAME; i++)
+        {
+            Decoded image;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (decoded.empty())
+                    break;
+                image = std::move(decoded.front());
+                decoded.pop_front();
+            }
+            changes += uploadTail(image);
+        }
+
+        // a budget lowered since the last frame
+        if (totalBytes > budget)
+            changes += makeRoom(0, NULL);
+
+        refining.clear();
+        for (std::unordered_map<unsigned int, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.levelCount > 0 && it->second.residentTop > wantedTop(it->second))
+                refining.push_back(&it->second);
+        std::sort(refining.begin(), refining.end(), [this](const Entry* a, const Entry* b)
+        {
+            if (a->lastRequest != b->lastRequest)
+                return a->lastRequest > b->lastRequest;
+            return a->residentTop - wantedTop(*a) > b->residentTop - wantedTop(*b);
+        });
+        size_t uploaded = 0;
+        for (size_t i = 0; i < refining.size(); i++)
+        {
+            Entry& entry = *refining[i];
+            int level = entry.residentTop - 1;
+            size_t bytes = levelBytes(entry.width, entry.height, entry.nrChannels, level);
+            if (uploaded > 0 && uploaded + bytes > uploadBytesPerFrame)
+                break;
+            if (totalBytes + bytes > budget)
+            {
+                changes += makeRoom(bytes, &entry);
+                if (totalBytes + bytes > budget)
+                {
+                    budgetStalls++;
+                    break;
+                }
+            }
+            glBindTexture(GL_TEXTURE_2D, entry.texture);
+            uploadLevel(entry, level);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+            entry.residentTop = level;
+            uploaded += bytes;
+            changes++;
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        frame++;
+        return changes;
+    }
+    // stops managing a texture, e.g. before deleting it; it keeps the levels it has
+    // ------------------------------------------------------------------------
+    void forget(unsigned int texture)
+    {
+        std::unordered_map<unsigned int, Entry>::iterator it = entries.find(texture);
+        if (it == entries.end())
+            return;
+        totalBytes -= it->second.residentBytes;
+        entries.erase(it);
+    }
+    // number of textures that are still being decoded; the ones that failed to decode are not waited for
+    // ------------------------------------------------------------------------
+    int pending() const
+    {
+        int count = 0;
+        for (std::unordered_map<unsigned int, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.levelCount == 0 && !it->second.failed)
+                count++;
+        return count;
+    }
+    // number of textures whose file could not be decoded; they keep the placeholder
+    // ------------------------------------------------------------------------
+    int failed() const
+    {
+        int count = 0;
+        for (std::unordered_map<unsigned int, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+            if (it->second.failed)
+                count++;
+        return count;
+    }
+    // video memory of the levels on the GPU, of all textures or of one
+    // ------------------------------------------------------------------------
+    size_t residentBytes() const
+    {
+        return totalBytes;
+    }
+    // ------------------------------------------------------------------------
+    size_t residentBytes(unsigned int texture) const
+    {
+        std::unordered_map<unsigned int, Entry>::const_iterator it = entries.find(texture);
+        return it != entries.end() ? it->second.residentBytes : 0;
+    }
+    // the finest level of a texture on the GPU, -1 while it holds the placeholder or is not managed
+    // ------------------------------------------------------------------------
+    int residentLevel(unsigned int texture) const
+    {
+        std::unordered_map<unsigned int, Entry>::const_iterator it = entries.find(texture);
+        return it != entries.end() && it->second.levelCount > 0 ? it->second.residentTop : -1;
+    }
+    // ------------------------------------------------------------------------
+    void report(std::ostream& out = std::cout) const
+    {
+        int complete = 0, limited = 0;
+        for (std::unordered_map<unsigned int, Entry>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+        {
+            const Entry& entry = it->second;
+            if (entry.levelCount > 0 && entry.residentTop == 0)
+                complete++;
+            else if (entry.levelCount > 0 && entry.residentTop > wantedTop(entry))
+                limited++;
+        }
+        const double MB = 1024.0 * 1024.0;
+        out << "TextureResidency: " << entries.size() << " textures (" << complete << " with all levels, " << limited
+            << " below the detail asked for, " << pending() << " decoding, " << failed() << " failed), " << totalBytes / MB
+            << " MB resident of a " << budget / MB << " MB budget, " << peakBytes / MB << " MB peak, " << levelsUploaded
+            << " levels uploaded, " << levelsEvicted << " evicted, " << budgetStalls << " budget stalls" << std::endl;
+    }
+    // stops the worker and forgets every texture; the textures themselves stay the caller's to delete
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        stopWorker();
+        entries.clear();
+        totalBytes = 0;
+    }
+
+private:
+    static const int TAIL_SIZE = 64;            // levels this size and smaller are uploaded at once and never evicted
+    static const int MAX_DECODED_PER_FRAME = 2; // tails update() uploads per frame
+
+    struct Request
+    {
+        unsigned int texture;
+        std::string path;
+    };
+    struct Decoded
+    {
+        unsigned int texture;
+        int width, height, nrChannels;
+        std::vector<std::vector<unsigned char> > levels; // empty if the file could not be decoded
+    };
+    struct Entry
+    {
+        unsigned int texture = 0;
+        int width = 0, height = 0, nrChannels = 0;
+        int levelCount = 0;  // 0 until the image is decoded
+        bool failed = false; // the file could not be decoded, the placeholder stays
+        int residentTop = 0; // finest level on the GPU
+        int tailTop = 0;     // coarsest level eviction leaves alone
+        size_t residentBytes = 0;
+        float wantedPixels = 0.0f;
+        unsigned long lastRequest = 0;
+        std::vector<std::vector<unsigned char> > levels;
+    };
+
+    std::unordered_map<unsigned int, Entry> entries;
+    std::vector<Entry*> refining; // reused by update(), so a steady frame does not allocate
+    unsigned long frame;
+    size_t totalBytes;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable requestAdded;
+    std::deque<Request> requests;
+    std::deque<Decoded> decoded;
+    bool stopping;
+
+    // the finest level the latest requests ask for; a texture nobody asked for yet keeps its tail
+    // ------------------------------------------------------------------------
+    int wantedTop(const Entry& entry) const
+    {
+        if (entry.wantedPixels <= 0.0f)
+            return entry.tailTop;
+        float size = (float)std::max(entry.width, entry.height);
+        int level = (int)std::floor(std::log2(size / entry.wantedPixels) + bias);
+        return std::max(0, std::min(entry.tailTop, level));
+    }
+    // ------------------------------------------------------------------------
+    static size_t levelBytes(int width, int height, int nrChannels, int level)
+    {
+        // drivers store three channel textures with four bytes a texel
+        int texelBytes = nrChannels == 3 ? 4 : nrChannels;
+        return (size_t)std::max(1, width >> level) * std::max(1, height >> level) * texelBytes;
+    }
+    // ------------------------------------------------------------------------
+    void uploadLevel(Entry& entry, int level)
+    {
+        GLenum format = entry.nrChannels == 1 ? GL_RED : entry.nrChannels == 2 ? GL_RG : entry.nrChannels == 3 ? GL_RGB : GL_RGBA;
+        glTexImage2D(GL_TEXTURE_2D, level, format, std::max(1, entry.width >> level), std::max(1, entry.height >> level), 0,
+                     format, GL_UNSIGNED_BYTE, entry.levels[level].data());
+        size_t bytes = levelBytes(entry.width, entry.height, entry.nrChannels, level);
+        entry.residentBytes += bytes;
+        totalBytes += bytes;
+        peakBytes = std::max(peakBytes, totalBytes);
+        levelsUploaded++;
+    }
+    // replaces the placeholder with the tail of the mip chain; returns the number of levels uploaded
+    // ------------------------------------------------------------------------
+    int uploadTail(Decoded& image)
+    {
+        std::unordered_map<unsigned int, Entry>::iterator it = entries.find(image.texture);
+        if (it == entries.end())
+            return 0; // forgotten meanwhile
+        Entry& entry = it->second;
+        if (image.levels.empty())
+        {
+            entry.failed = true; // keeps the placeholder, and is no longer pending
+            return 0;
+        }
+        entry.width = image.width;
+        entry.height = image.height;
+        entry.nrChannels = image.nrChannels;
+        entry.levels.swap(image.levels);
+        entry.levelCount = (int)entry.levels.size();
+        entry.tailTop = 0;
+        while (entry.tailTop < entry.levelCount - 1 && std::max(entry.width >> entry.tailTop, entry.height >> entry.tailTop) > TAIL_SIZE)
+            entry.tailTop++;
+
+        glBindTexture(GL_TEXTURE_2D, entry.texture);
+        for (int level = entry.levelCount - 1; level >= entry.tailTop; level--)
+            uploadLevel(entry, level);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, entry.tailTop);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.levelCount - 1);
+        if (entry.tailTop > 0)
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL); // the placeholder
+        entry.residentTop = entry.tailTop;
+        return entry.levelCount - entry.tailTop;
+    }
+    // evicts finest levels until bytes more fit the budget, without touching keep or anything requested as recently
+    // as it; returns the number of levels evicted
+    // ------------------------------------------------------------------------
+    int makeRoom(size_t bytes, const Entry* keep)
+    {
+        int evicted = 0;
+        while (totalBytes + bytes > budget)
+        {
+            Entry* victim = NULL;
+            for (std::unordered_map<unsigned int, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+            {
+                Entry* candidate = &it->second;
+                if (candidate == keep || candidate->levelCount == 0 || candidate->residentTop >= candidate->tailTop)
+                    continue;
+                bool surplus = candidate->residentTop < wantedTop(*candidate);
+                if (keep && !surplus && candidate->lastRequest >= keep->lastRequest)
+                    continue;
+                if (!victim || evictsBefore(*candidate, *victim))
+                    victim = candidate;
+            }
+            if (!victim)
+                break;
+            int level = victim->residentTop;
+            glBindTexture(GL_TEXTURE_2D, victim->texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level + 1);
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            size_t freed = levelBytes(victim->width, victim->height, victim->nrChannels, level);
+            victim->residentBytes -= freed;
+            totalBytes -= freed;
+            victim->residentTop = level + 1;
+            levelsEvicted++;
+            evicted++;
+        }
+        return evicted;
+    }
+    // eviction order: more detail than asked for first, then least recently requested, then the larger level
+    // ------------------------------------------------------------------------
+    bool evictsBefore(const Entry& a, const Entry& b) const
+    {
+        bool surplusA = a.residentTop < wantedTop(a), surplusB = b.residentTop < wantedTop(b);
+        if (surplusA != surplusB)
+            return surplusA;
+        if (a.lastRequest != b.lastRequest)
+            return a.lastRequest < b.lastRequest;
+        return a.residentBytes > b.residentBytes;
+    }
+    // worker thread: decode the requests and halve them down to 1x1 until stopped
+    // ------------------------------------------------------------------------
+    void workerLoop()
+    {
+        for (;;)
+        {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                requestAdded.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (stopping)
+                    return;
+                request = requests.front();
+                requests.pop_front();
+            }
+            Decoded image;
+            image.texture = request.texture;
+            unsigned char* data = stbi_load(request.path.c_str(), &image.width, &image.height, &image.nrChannels, 0);
+            if (data)
+            {
+                image.levels.push_back(std::vector<unsigned char>(data, data + (size_t)image.width * image.height * image.nrChannels));
+                stbi_image_free(data);
+                buildMipChain(image);
+            }
+            else
+            {
+                std::cout << "Failed to load texture: " << request.path << std::endl;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            decoded.push_back(std::move(image));
+        }
+    }
+    // appends the box filtered levels below level 0, each half the size of the one above (the last row or column
+    // of an odd edge is left out of the filter)
+    // ------------------------------------------------------------------------
+    static void buildMipChain(Decoded& image)
+    {
+        int channels = image.nrChannels;
+        for (int level = 1; std::max(image.width >> (level - 1), image.height >> (level - 1)) > 1; level++)
+        {
+            int srcWidth = std::max(1, image.width >> (level - 1)), srcHeight = std::max(1, image.height >> (level - 1));
+            int width = std::max(1, image.width >> level), height = std::max(1, image.height >> level);
+            const std::vector<unsigned char>& src = image.levels[level - 1];
+            std::vector<unsigned char> dst((size_t)width * height * channels);
+            for (int y = 0; y < height; y++)
+            {
+                int y0 = std::min(2 * y, srcHeight - 1), y1 = std::min(2 * y + 1, srcHeight - 1);
+                for (int x = 0; x < width; x++)
+                {
+                    int x0 = std::min(2 * x, srcWidth - 1), x1 = std::min(2 * x + 1, srcWidth - 1);
+                    for (int c = 0; c < channels; c++)
+                    {
+                        int sum = src[((size_t)y0 * srcWidth + x0) * channels + c] + src[((size_t)y0 * srcWidth + x1) * channels + c] +
+                                  src[((size_t)y1 * srcWidth + x0) * channels + c] + src[((size_t)y1 * srcWidth + x1) * channels + c];
+                        dst[((size_t)y * width + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+                    }
+                }
+            }
+            image.levels.push_back(std::move(dst));
+        }
+    }
+    // ------------------------------------------------------------------------
+    void stopWorker()
+    {
+        if (!worker.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        requestAdded.notify_all();
+        worker.join();
+        decoded.clear();
+    }
+};
+#endif
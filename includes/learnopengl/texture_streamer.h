@@ -0,0 +1,278 @@
+#ifndef TEXTURE_STREAMER_H
+#define TEXTURE_STREAMER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <learnopengl/gl_extensions.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loads textures without blocking the render thread.
+// - load() returns a texture object right away. Until the image is ready it holds a single grey texel,
+//   so it can be bound (and is mipmap complete) from the very first frame.
+// - A pool of worker threads decodes the images with stb_image and hands the pixels to the GL thread
+//   through a bounded queue, so a long list of requests can't decode everything into memory at once.
+// - update() runs on the GL thread once per frame. It copies a few decoded images into a pixel buffer
+//   object and uploads them from there, so the driver copies the pixels asynchronously. The pixel
+//   buffer is split into slots guarded by fences so a slot is only rewritten once the GPU read it.
+//   With OpenGL 4.4 (or ARB_buffer_storage) the buffer is mapped once, persistently; otherwise every
+//   copy maps its slot with glMapBufferRange.
+class TextureStreamer
+{
+public:
+    // workerCount 0 picks one thread less than the number of cores
+    // ------------------------------------------------------------------------
+    TextureStreamer(unsigned int workerCount = 0, size_t slotSize = 8 * 1024 * 1024, size_t queueCapacity = 8)
+        : slotSize(slotSize), queueCapacity(queueCapacity), stopping(false), pixelBuffer(0), mapped(NULL)
+    {
+        persistent = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+        glGenBuffers(1, &pixelBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+        if (persistent)
+        {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, SLOTS * slotSize, NULL, flags);
+            mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, SLOTS * slotSize, flags);
+        }
+        else
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, SLOTS * slotSize, NULL, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        for (int i = 0; i < SLOTS; i++)
+            fences[i] = 0;
+        nextSlot = 0;
+
+        if (workerCount == 0)
+        {
+            // hardware_concurrency() may report 0 when the count is unknown
+            unsigned int cores = std::thread::hardware_concurrency();
+            workerCount = cores > 1 ? cores - 1 : 1;
+        }
+        for (unsigned int i = 0; i < workerCount; i++)
+            workers.push_back(std::thread(&TextureStreamer::workerLoop, this));
+    }
+    ~TextureStreamer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        requestAdded.notify_all();
+        decodedTaken.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
+            workers[i].join();
+        for (size_t i = 0; i < decoded.size(); i++)
+            stbi_image_free(decoded[i].data);
+    }
+
+    // queues an image file and returns its texture object, which holds the placeholder until update() uploads it
+    // ------------------------------------------------------------------------
+    unsigned int load(const std::string& path)
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        const unsigned char grey[4] = { 128, 128, 128, 255 };
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, grey);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(Request{ texture, path });
+            pendingCount++;
+        }
+        requestAdded.notify_one();
+        return texture;
+    }
+    // decodes the image file again and replaces the contents of an existing texture with it in update(); the
+    // texture keeps showing the old image until then, and keeps it for good if the file can't be decoded
+    // ------------------------------------------------------------------------
+    void reload(unsigned int texture, const std::string& path)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(Request{ texture, path });
+            pendingCount++;
+        }
+        requestAdded.notify_one();
+    }
+    // uploads at most maxUploads decoded images and returns how many it uploaded; call once per frame on the GL thread
+    // ------------------------------------------------------------------------
+    int update(int maxUploads = 2)
+    {
+        for (int i = 0; i < maxUploads; i++)
+        {
+            Decoded image;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (decoded.empty())
+                    return i;
+                image = decoded.front();
+                decoded.pop_front();
+            }
+            decodedTaken.notify_one();
+            upload(image);
+            stbi_image_free(image.data);
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingCount--;
+        }
+        return maxUploads;
+    }
+    // number of textures that still show the placeholder
+    // ------------------------------------------------------------------------
+    int pending()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pendingCount;
+    }
+    // deletes the pixel buffer; call before the context is destroyed
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        for (int i = 0; i < SLOTS; i++)
+            if (fences[i])
+                glDeleteSync(fences[i]);
+        if (mapped)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            mapped = NULL;
+        }
+        glDeleteBuffers(1, &pixelBuffer);
+        pixelBuffer = 0;
+    }
+
+private:
+    static const int SLOTS = 4;
+
+    struct Request
+    {
+        unsigned int texture;
+        std::string path;
+    };
+    struct Decoded
+    {
+        unsigned int texture;
+        int width, height, nrChannels;
+        unsigned char* data;
+    };
+
+    size_t slotSize;
+    size_t queueCapacity;
+    bool persistent;
+    bool stopping;
+    int pendingCount = 0;
+    std::deque<Request> requests;
+    std::deque<Decoded> decoded;
+    std::mutex mutex;
+    std::condition_variable requestAdded;
+    std::condition_variable decodedTaken;
+    std::vector<std::thread> workers;
+
+    unsigned int pixelBuffer;
+    unsigned char* mapped;
+    GLsync fences[SLOTS];
+    int nextSlot;
+
+    // worker thread: decode requests until the streamer is destroyed
+    // ------------------------------------------------------------------------
+    void workerLoop()
+    {
+        for (;;)
+        {
+            Request request;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                requestAdded.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (stopping)
+                    return;
+                request = requests.front();
+                requests.pop_front();
+            }
+            Decoded image;
+            image.texture = request.texture;
+            image.data = stbi_load(request.path.c_str(), &image.width, &image.height, &image.nrChannels, 0);
+            if (!image.data)
+                std::cout << "Failed to load texture: " << request.path << std::endl;
+            {
+                // the queue is bounded: wait for the GL thread to take an image before adding another one
+                std::unique_lock<std::mutex> lock(mutex);
+                decodedTaken.wait(lock, [this] { return stopping || decoded.size() < queueCapacity; });
+                if (stopping)
+                {
+                    stbi_image_free(image.data);
+                    return;
+                }
+                decoded.push_back(image);
+            }
+        }
+    }
+    // copies the image into a free pixel buffer slot and uploads it from there
+    // ------------------------------------------------------------------------
+    void upload(const Decoded& image)
+    {
+        if (!image.data)
+            return; // keep the placeholder
+        GLenum format = image.nrChannels == 1 ? GL_RED : image.nrChannels == 2 ? GL_RG : image.nrChannels == 3 ? GL_RGB : GL_RGBA;
+        size_t size = (size_t)image.width * image.height * image.nrChannels;
+
+        glBindTexture(GL_TEXTURE_2D, image.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        int slot = size <= slotSize ? acquireSlot() : -1;
+        if (slot >= 0)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+            size_t offset = slot * slotSize;
+            if (persistent)
+            {
+                std::memcpy(mapped + offset, image.data, size);
+            }
+            else
+            {
+                void* region = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, size,
+                                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+                std::memcpy(region, image.data, size);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            }
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, (void*)offset);
+            fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        else
+        {
+            // too large for a slot, or every slot is still in use: upload straight from client memory
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    // returns a slot the GPU is done reading from, or -1 if there is none right now (never waits)
+    // ------------------------------------------------------------------------
+    int acquireSlot()
+    {
+        for (int i = 0; i < SLOTS; i++)
+        {
+            int slot = (nextSlot + i) % SLOTS;
+            if (fences[slot])
+            {
+                if (glClientWaitSync(fences[slot], 0, 0) == GL_TIMEOUT_EXPIRED)
+                    continue;
+                glDeleteSync(fences[slot]);
+                fences[slot] = 0;
+            }
+            nextSlot = (slot + 1) % SLOTS;
+            return slot;
+        }
+        return -1;
+    }
+};
+#endif
@@ -0,0 +1,141 @@
+#ifndef UNIFORM_ARENA_H
+#define UNIFORM_ARENA_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/stream_buffer.h>
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Uniform blocks share one C++ struct with the GLSL side. The members follow the std140 rules so the struct
+// can be copied into the buffer as it is: scalars are 4 bytes, vec4 and every matrix column start at a multiple
+// of 16, and the size of the block rounds up to 16. A vec3 would be padded to 16 bytes, so use vec4 instead.
+// The offsets are checked with static_assert below each struct, and bindUniformBlock() compares the size with
+// what the driver reports for the linked program.
+
+// binding points of the shared blocks
+const unsigned int FRAME_UNIFORMS_BINDING = 0;
+const unsigned int OBJECT_UNIFORMS_BINDING = 1;
+
+// the per-frame data every program can read, uploaded once per frame
+struct FrameUniforms
+{
+    float viewProjection[16]; // column-major, offset 0
+    float viewport[4];        // x, y, width, height in pixels, offset 64
+    float time;               // seconds since the start, offset 80
+    float deltaTime;          // seconds since the last frame, offset 84
+    float padding[2];
+};
+const char* const frameUniformsBlock =
+    "layout (std140) uniform FrameUniforms\n"
+    "{\n"
+    "   mat4 viewProjection;\n"
+    "   vec4 viewport;\n"
+    "   float time;\n"
+    "   float deltaTime;\n"
+    "};\n";
+static_assert(offsetof(FrameUniforms, viewport) == 64, "std140: vec4 viewport follows the mat4 at offset 64");
+static_assert(offsetof(FrameUniforms, time) == 80, "std140: float time follows the vec4 at offset 80");
+static_assert(offsetof(FrameUniforms, deltaTime) == 84, "std140: float deltaTime is packed right after time");
+static_assert(sizeof(FrameUniforms) == 96, "std140: the block size rounds up to a multiple of 16");
+
+// the per-draw data of the samples, one per draw call
+struct ObjectUniforms
+{
+    float color[4]; // offset 0
+};
+const char* const objectUniformsBlock =
+    "layout (std140) uniform ObjectUniforms\n"
+    "{\n"
+    "   vec4 color;\n"
+    "};\n";
+static_assert(sizeof(ObjectUniforms) == 16, "std140: a single vec4");
+
+// connects the uniform block blockName of program to a binding point (GLSL 330 has no binding qualifier) and
+// checks that the block is as large as the C++ struct; returns false if the program has no such block. The sizes
+// are compared rounded up to 16 bytes, since drivers may report GL_UNIFORM_BLOCK_DATA_SIZE without the std140
+// padding after the last member
+// ------------------------------------------------------------------------
+inline bool bindUniformBlock(unsigned int program, const char* blockName, unsigned int binding, size_t expectedSize)
+{
+    unsigned int index = glGetUniformBlockIndex(program, blockName);
+    if (index == GL_INVALID_INDEX)
+        return false;
+    int size = 0;
+    glGetActiveUniformBlockiv(program, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+    if ((((size_t)size + 15) & ~(size_t)15) != ((expectedSize + 15) & ~(size_t)15))
+        std::cout << "ERROR::UNIFORM_BLOCK::SIZE_MISMATCH: " << blockName << " is " << size << " bytes in GLSL but " << expectedSize << " in C++" << std::endl;
+    glUniformBlockBinding(program, index, binding);
+    return true;
+}
+
+// Per-frame bump allocator for uniform block data, in one large buffer.
+// - push() copies a block into the part of the buffer that belongs to this frame and binds that range with
+//   glBindBufferRange; every following draw call reads it, from every program that has the block, until the
+//   next push() to the same binding point. Shared data is pushed once per frame, per-draw data once per draw,
+//   and no glUniform call has to be repeated for every program.
+// - The buffer is a StreamBuffer: the frames rotate through regionCount regions fenced against the GPU, so
+//   nothing is overwritten while it may still be read. Every block starts at a multiple of
+//   GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, so frameSize has to cover the aligned size of all pushes of a frame.
+//   persistentMapping is passed on to the StreamBuffer.
+// Usage, every frame:
+//     arena.push(FRAME_UNIFORMS_BINDING, frame);
+//     for every object: arena.push(OBJECT_UNIFORMS_BINDING, object); glDraw...
+//     arena.endFrame();
+class UniformArena
+{
+public:
+    int pushes = 0; // blocks pushed in the current frame
+
+    UniformArena(size_t frameSize, int regionCount = 3, bool persistentMapping = true)
+        : stream(frameSize, regionCount, persistentMapping), alignment(256)
+    {
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    }
+
+    // copies size bytes of block data into this frame's part of the arena and binds it to the binding point
+    // ------------------------------------------------------------------------
+    bool push(unsigned int binding, const void* data, size_t size)
+    {
+        void* destination = stream.map(size, (size_t)alignment);
+        if (!destination)
+            return false;
+        std::memcpy(destination, data, size);
+        stream.unmap();
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, stream.ID, (GLintptr)stream.offset(), (GLsizeiptr)size);
+        pushes++;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    template <typename T>
+    bool push(unsigned int binding, const T& block)
+    {
+        return push(binding, &block, sizeof(T));
+    }
+    // call after the last draw call of the frame
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        stream.endFrame();
+        pushes = 0;
+    }
+    // how often the arena had to wait for the GPU to finish with a region
+    // ------------------------------------------------------------------------
+    int stalls() const
+    {
+        return stream.stalls;
+    }
+    // ------------------------------------------------------------------------
+    void release()
+    {
+        stream.release();
+    }
+
+private:
+    StreamBuffer stream;
+    int alignment;
+};
+#endif
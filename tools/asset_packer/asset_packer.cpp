@@ -0,0 +1,139 @@
+/* Builds the asset pack (learnopengl/asset_pack.h) that the samples map at startup instead of opening and
+reading every texture and shader file on its own.
+- Images (.jpg, .png, .tga, .bmp) are decoded here and stored as RGBA8 pixels, so nothing is decoded at startup.
+Pre-compressed textures (.ktx2, .dds from tools/texture_compressor) are stored as they are, GLSL sources
+(.vs, .fs, .gs, .comp, .glsl) zero terminated, and .vertices/.indices files as raw vertex data.
+- The entries are named by their path relative to the repository, e.g. "resources/textures/container.jpg".
+- Usage: asset_packer [--output resources/assets.pak] [input dirs or files...]
+(default inputs: resources and 1.getting_started) */
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <learnopengl/asset_pack.h>
+#include <learnopengl/filesystem.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+std::string extensionOf(const fs::path& path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension;
+}
+
+bool readFile(const fs::path& path, std::string& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::stringstream stream;
+    stream << file.rdbuf();
+    data = stream.str();
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputPath = FileSystem::getPath("resources/assets.pak");
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (argv[i][0] != '-')
+            inputs.push_back(argv[i]);
+        else
+        {
+            std::cout << "usage: " << argv[0] << " [--output resources/assets.pak] [inputs...]" << std::endl;
+            return -1;
+        }
+    }
+    if (inputs.empty())
+    {
+        inputs.push_back(FileSystem::getPath("resources"));
+        inputs.push_back(FileSystem::getPath("1.getting_started"));
+    }
+
+    std::vector<fs::path> files;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (fs::is_directory(inputs[i]))
+        {
+            for (fs::recursive_directory_iterator it(inputs[i]), end; it != end; ++it)
+                if (it->is_regular_file())
+                    files.push_back(it->path());
+        }
+        else
+            files.push_back(inputs[i]);
+    }
+    std::sort(files.begin(), files.end());
+
+    std::string root = FileSystem::getPath("");
+    AssetPackWriter writer;
+    size_t textureBytes = 0, shaderBytes = 0, vertexBytes = 0;
+    int skipped = 0;
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        std::string name = files[i].generic_string();
+        if (!root.empty() && name.compare(0, root.size(), root) == 0)
+            name = name.substr(root.size());
+        while (!name.empty() && name[0] == '/')
+            name.erase(0, 1);
+
+        std::string extension = extensionOf(files[i]);
+        std::string data;
+        if (extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" || extension == ".bmp")
+        {
+            int width, height, nrChannels;
+            unsigned char* pixels = stbi_load(files[i].string().c_str(), &width, &height, &nrChannels, 4);
+            if (!pixels)
+            {
+                std::cout << "Failed to load " << files[i].string() << std::endl;
+                continue;
+            }
+            writer.add(name, ASSET_TEXTURE_RGBA8, pixels, (size_t)width * height * 4, width, height);
+            textureBytes += (size_t)width * height * 4;
+            stbi_image_free(pixels);
+        }
+        else if ((extension == ".ktx2" || extension == ".dds") && readFile(files[i], data))
+        {
+            writer.add(name, ASSET_TEXTURE_COMPRESSED, data.data(), data.size());
+            textureBytes += data.size();
+        }
+        else if ((extension == ".vs" || extension == ".fs" || extension == ".gs" || extension == ".comp" || extension == ".glsl")
+                 && readFile(files[i], data))
+        {
+            writer.add(name, ASSET_SHADER_SOURCE, data.data(), data.size());
+            shaderBytes += data.size();
+        }
+        else if ((extension == ".vertices" || extension == ".indices") && readFile(files[i], data))
+        {
+            writer.add(name, ASSET_VERTEX_DATA, data.data(), data.size());
+            vertexBytes += data.size();
+        }
+        else
+            skipped++;
+    }
+
+    if (writer.count() == 0)
+    {
+        std::cout << "no assets found" << std::endl;
+        return -1;
+    }
+    size_t entries = writer.count();
+    if (!writer.write(outputPath))
+        return 1;
+    std::cout << "{\n  \"output\": \"" << outputPath << "\",\n  \"entries\": " << entries << ", \"skipped_files\": " << skipped << ",\n"
+              << "  \"texture_bytes\": " << textureBytes << ", \"shader_bytes\": " << shaderBytes
+              << ", \"vertex_bytes\": " << vertexBytes << "\n}" << std::endl;
+    return 0;
+}
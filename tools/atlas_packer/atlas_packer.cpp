@@ -0,0 +1,118 @@
+/* Packs the images of a directory (by default resources/textures) into the layers of one array texture atlas,
+which learnopengl/texture_atlas.h loads with loadAtlas() and uploads with TextureAtlas::create().
+- The packing is done here, at build time, with the same AtlasBuilder the samples fall back to at startup: skyline
+pages of --size texels, every image surrounded by --padding texels of its own edge so the mipmaps don't bleed.
+- No OpenGL context is needed. The atlas is written to --output and a summary of the layout as JSON to stdout.
+- Usage: atlas_packer [--size 2048] [--padding 4] [--output atlas.bin] [input dir or files...] */
+#include <stb_image.h>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/texture_atlas.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+bool isImage(const fs::path& path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" || extension == ".bmp";
+}
+
+int main(int argc, char** argv)
+{
+    int size = 2048;
+    int padding = 4;
+    std::string outputPath = FileSystem::getPath("resources/textures/atlas.bin");
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--size") && i + 1 < argc)
+            size = std::max(64, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--padding") && i + 1 < argc)
+            padding = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (argv[i][0] != '-')
+            inputs.push_back(argv[i]);
+        else
+        {
+            std::cout << "usage: " << argv[0] << " [--size 2048] [--padding 4] [--output atlas.bin] [inputs...]" << std::endl;
+            return -1;
+        }
+    }
+    if ((padding & (padding - 1)) != 0)
+    {
+        std::cout << "--padding has to be a power of two" << std::endl;
+        return -1;
+    }
+    if (inputs.empty())
+        inputs.push_back(FileSystem::getPath("resources/textures"));
+
+    std::vector<fs::path> images;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (fs::is_directory(inputs[i]))
+        {
+            for (fs::recursive_directory_iterator it(inputs[i]), end; it != end; ++it)
+                if (it->is_regular_file() && isImage(it->path()))
+                    images.push_back(it->path());
+        }
+        else
+            images.push_back(inputs[i]);
+    }
+    std::sort(images.begin(), images.end());
+
+    // the regions are named by the path relative to the repository, the way the samples ask for them
+    // (e.g. "resources/textures/container.jpg")
+    AtlasBuilder builder(size, padding);
+    std::string root = FileSystem::getPath("");
+    size_t texels = 0;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        int width, height, nrChannels;
+        unsigned char* pixels = stbi_load(images[i].string().c_str(), &width, &height, &nrChannels, 4);
+        if (!pixels)
+        {
+            std::cout << "Failed to load " << images[i].string() << std::endl;
+            continue;
+        }
+        std::string name = images[i].generic_string();
+        if (!root.empty() && name.compare(0, root.size(), root) == 0)
+            name = name.substr(root.size());
+        while (!name.empty() && name[0] == '/')
+            name.erase(0, 1);
+        builder.add(name, width, height, pixels);
+        texels += (size_t)width * height;
+        stbi_image_free(pixels);
+    }
+    if (builder.imageCount() == 0)
+    {
+        std::cout << "no images found" << std::endl;
+        return -1;
+    }
+
+    AtlasData atlas;
+    if (!builder.pack(atlas) || !saveAtlas(outputPath, atlas))
+        return 1;
+
+    std::cout << "{\n  \"output\": \"" << outputPath << "\",\n"
+              << "  \"size\": " << atlas.size << ", \"layers\": " << atlas.layers << ", \"padding\": " << atlas.padding
+              << ", \"mip_levels\": " << atlas.mipLevels << ",\n"
+              << "  \"fill\": " << (double)texels / ((double)atlas.size * atlas.size * atlas.layers) << ",\n  \"regions\": [";
+    for (size_t i = 0; i < atlas.regions.size(); i++)
+    {
+        const AtlasRegion& region = atlas.regions[i];
+        std::cout << (i ? ",\n" : "\n") << "    { \"name\": \"" << region.name << "\", \"layer\": " << region.layer
+                  << ", \"uv_rect\": [" << region.uvRect[0] << ", " << region.uvRect[1] << ", " << region.uvRect[2] << ", " << region.uvRect[3] << "] }";
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,541 @@
+/* Renders the scene of every 1.getting_started sample into an offscreen framebuffer and reports the
+throughput as JSON, so it can run in CI or on render nodes without a display.
+- The window is a hidden GLFW window; it only provides the context. Every scene draws into an FBO of the
+requested resolution with swap interval 0, so nothing is capped by vsync.
+- uniform_lookups compares the cost of setting a uniform through glGetUniformLocation on every call with the
+Shader class's cached locations, looked up by name (hashed at runtime) or by a precomputed uniformHash.
+- Usage: benchmark [--frames N] [--warmup N] [--resolution WxH]... [--output results.json]
+(default: 1000 frames at 800x600 and 1920x1080, written to stdout). */
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/frame_profiler.h>
+#include <learnopengl/shader_s.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// GL objects of the scene that is currently benchmarked
+struct SceneState
+{
+    unsigned int program = 0;
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int texture = 0;
+    int colorLocation = -1;
+    Shader* shader = NULL;
+};
+
+// one sample: setup creates its objects, draw renders one frame and returns the number of draw calls
+struct Scene
+{
+    const char* name;
+    void (*setup)(SceneState& state);
+    int (*draw)(SceneState& state, double time);
+};
+
+struct Resolution
+{
+    int width, height;
+};
+
+// shader sources, copied from the samples
+// ---------------------------------------
+const char *positionVertexSource = "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(aPos, 1.0);\n"
+    "}\0";
+const char *orangeFragmentSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+    "}\n\0";
+const char *uniformFragmentSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "uniform vec4 ourColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = ourColor;\n"
+    "}\n\0";
+const char *colorVertexSource = "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec3 aColor;\n"
+    "out vec3 ourColor;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(aPos, 1.0);\n"
+    "   ourColor = aColor;\n"
+    "}\0";
+const char *colorFragmentSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "in vec3 ourColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(ourColor, 1.0f);\n"
+    "}\n\0";
+
+unsigned int compileProgram(const char* vertexSource, const char* fragmentSource)
+{
+    int success;
+    char infoLog[512];
+    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vertexSource, NULL);
+    glCompileShader(vertex);
+    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fragmentSource, NULL);
+    glCompileShader(fragment);
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return program;
+}
+
+// uploads vertices (and indices, if any) and configures attributes of the given float counts
+void createMesh(SceneState& state, const float* vertices, size_t verticesSize, const unsigned int* indices, size_t indicesSize,
+                const int* attributeSizes, int attributeCount)
+{
+    glGenVertexArrays(1, &state.VAO);
+    glGenBuffers(1, &state.VBO);
+    glBindVertexArray(state.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, state.VBO);
+    glBufferData(GL_ARRAY_BUFFER, verticesSize, vertices, GL_STATIC_DRAW);
+    if (indices)
+    {
+        glGenBuffers(1, &state.EBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, state.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indicesSize, indices, GL_STATIC_DRAW);
+    }
+    int stride = 0;
+    for (int i = 0; i < attributeCount; i++)
+        stride += attributeSizes[i];
+    int offset = 0;
+    for (int i = 0; i < attributeCount; i++)
+    {
+        glVertexAttribPointer(i, attributeSizes[i], GL_FLOAT, GL_FALSE, stride * sizeof(float), (void*)(offset * sizeof(float)));
+        glEnableVertexAttribArray(i);
+        offset += attributeSizes[i];
+    }
+    glBindVertexArray(0);
+}
+
+// 1.1 hello_window: nothing is drawn, the frame is only presented
+// ---------------------------------------------------------------
+void setupNothing(SceneState&) {}
+int drawNothing(SceneState&, double) { return 0; }
+
+// 1.2 hello_window_clear
+// ----------------------
+int drawClear(SceneState&, double)
+{
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return 0;
+}
+
+// 2.1 hello_triangle
+// ------------------
+void setupTriangle(SceneState& state)
+{
+    float vertices[] = {
+        -0.5f, -0.5f, 0.0f,
+         0.5f, -0.5f, 0.0f,
+         0.0f,  0.5f, 0.0f
+    };
+    int attributes[] = { 3 };
+    state.program = compileProgram(positionVertexSource, orangeFragmentSource);
+    createMesh(state, vertices, sizeof(vertices), NULL, 0, attributes, 1);
+}
+int drawTriangle(SceneState& state, double)
+{
+    drawClear(state, 0.0);
+    glUseProgram(state.program);
+    glBindVertexArray(state.VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    return 1;
+}
+
+// 2.2 hello_rectangle
+// -------------------
+void setupRectangle(SceneState& state)
+{
+    float vertices[] = {
+         0.5f,  0.5f, 0.0f,
+         0.5f, -0.5f, 0.0f,
+        -0.5f, -0.5f, 0.0f,
+        -0.5f,  0.5f, 0.0f
+    };
+    unsigned int indices[] = { 0, 1, 3, 1, 2, 3 };
+    int attributes[] = { 3 };
+    state.program = compileProgram(positionVertexSource, orangeFragmentSource);
+    createMesh(state, vertices, sizeof(vertices), indices, sizeof(indices), attributes, 1);
+}
+int drawRectangle(SceneState& state, double)
+{
+    drawClear(state, 0.0);
+    glUseProgram(state.program);
+    glBindVertexArray(state.VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    return 1;
+}
+
+// 3.1 shaders_uniform
+// -------------------
+void setupUniform(SceneState& state)
+{
+    float vertices[] = {
+         0.5f, -0.5f, 0.0f,
+        -0.5f, -0.5f, 0.0f,
+         0.0f,  0.5f, 0.0f
+    };
+    int attributes[] = { 3 };
+    state.program = compileProgram(positionVertexSource, uniformFragmentSource);
+    state.colorLocation = glGetUniformLocation(state.program, "ourColor");
+    createMesh(state, vertices, sizeof(vertices), NULL, 0, attributes, 1);
+}
+int drawUniform(SceneState& state, double time)
+{
+    drawClear(state, 0.0);
+    glUseProgram(state.program);
+    glUniform4f(state.colorLocation, 0.0f, static_cast<float>(sin(time) / 2.0 + 0.5), 0.0f, 1.0f);
+    glBindVertexArray(state.VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    return 1;
+}
+
+// 3.2 shaders_interpolation
+// -------------------------
+const float colorTriangle[] = {
+     0.5f, -0.5f, 0.0f,  1.0f, 0.0f, 0.0f,
+    -0.5f, -0.5f, 0.0f,  0.0f, 1.0f, 0.0f,
+     0.0f,  0.5f, 0.0f,  0.0f, 0.0f, 1.0f
+};
+void setupInterpolation(SceneState& state)
+{
+    int attributes[] = { 3, 3 };
+    state.program = compileProgram(colorVertexSource, colorFragmentSource);
+    createMesh(state, colorTriangle, sizeof(colorTriangle), NULL, 0, attributes, 2);
+}
+int drawInterpolation(SceneState& state, double)
+{
+    drawClear(state, 0.0);
+    glUseProgram(state.program);
+    glBindVertexArray(state.VAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    return 1;
+}
+
+// 3.3 shaders_class
+// -----------------
+void setupShaderClass(SceneState& state)
+{
+    int attributes[] = { 3, 3 };
+    state.shader = new Shader(FileSystem::getPath("1.getting_started/3.3.shaders_class/3.3.shader.vs").c_str(),
+                              FileSystem::getPath("1.getting_started/3.3.shaders_class/3.3.shader.fs").c_str());
+    state.program = state.shader->ID;
+    createMesh(state, colorTriangle, sizeof(colorTriangle), NULL, 0, attributes, 2);
+}
+
+// 4.1 textures
+// ------------
+void setupTextures(SceneState& state)
+{
+    float vertices[] = {
+         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,
+         0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,
+        -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,
+        -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f
+    };
+    unsigned int indices[] = { 0, 1, 3, 1, 2, 3 };
+    int attributes[] = { 3, 3, 2 };
+    state.shader = new Shader(FileSystem::getPath("1.getting_started/4.1.textures/4.1.texture.vs").c_str(),
+                              FileSystem::getPath("1.getting_started/4.1.textures/4.1.texture.fs").c_str());
+    state.program = state.shader->ID;
+    createMesh(state, vertices, sizeof(vertices), indices, sizeof(indices), attributes, 3);
+
+    glGenTextures(1, &state.texture);
+    glBindTexture(GL_TEXTURE_2D, state.texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(FileSystem::getPath("resources/textures/container.jpg").c_str(), &width, &height, &nrChannels, 0);
+    if (data)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    else
+    {
+        std::cerr << "Failed to load texture" << std::endl;
+    }
+    stbi_image_free(data);
+}
+int drawTextures(SceneState& state, double)
+{
+    drawClear(state, 0.0);
+    glBindTexture(GL_TEXTURE_2D, state.texture);
+    glUseProgram(state.program);
+    glBindVertexArray(state.VAO);
+    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    return 1;
+}
+
+void destroyScene(SceneState& state)
+{
+    glDeleteVertexArrays(1, &state.VAO);
+    glDeleteBuffers(1, &state.VBO);
+    glDeleteBuffers(1, &state.EBO);
+    glDeleteTextures(1, &state.texture);
+    if (state.shader)
+        glDeleteProgram(state.shader->ID);
+    else if (state.program)
+        glDeleteProgram(state.program);
+    delete state.shader;
+    state = SceneState();
+}
+
+const Scene scenes[] = {
+    { "1.1.hello_window",          setupNothing,       drawNothing },
+    { "1.2.hello_window_clear",    setupNothing,       drawClear },
+    { "2.1.hello_triangle",        setupTriangle,      drawTriangle },
+    { "2.2.hello_rectangle",       setupRectangle,     drawRectangle },
+    { "3.1.shaders_uniform",       setupUniform,       drawUniform },
+    { "3.2.shaders_interpolation", setupInterpolation, drawInterpolation },
+    { "3.3.shaders_class",         setupShaderClass,   drawInterpolation },
+    { "4.1.textures",              setupTextures,      drawTextures },
+};
+
+// uniform lookups: glGetUniformLocation per call against the Shader class's location cache
+// ----------------------------------------------------------------------------------------
+const char *manyUniformsFragmentSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "uniform float u0, u1, u2, u3, u4, u5, u6, u7;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(u0 + u1, u2 + u3, u4 + u5, u6 + u7);\n"
+    "}\n\0";
+const char* const uniformNames[] = { "u0", "u1", "u2", "u3", "u4", "u5", "u6", "u7" };
+const int UNIFORM_COUNT = sizeof(uniformNames) / sizeof(uniformNames[0]);
+
+// sets every uniform iterations times through each path; returns the CPU nanoseconds per set of each
+void measureUniformLookups(int iterations, double& uncachedNs, double& byNameNs, double& byHashNs)
+{
+    typedef std::chrono::steady_clock Clock;
+    Shader shader = Shader::fromSource(positionVertexSource, manyUniformsFragmentSource);
+    shader.use();
+    std::vector<std::string> names(uniformNames, uniformNames + UNIFORM_COUNT);
+    unsigned int hashes[UNIFORM_COUNT];
+    for (int u = 0; u < UNIFORM_COUNT; u++)
+        hashes[u] = uniformHash(uniformNames[u]);
+    double sets = (double)iterations * UNIFORM_COUNT;
+
+    glFinish();
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+        for (int u = 0; u < UNIFORM_COUNT; u++)
+            glUniform1f(glGetUniformLocation(shader.ID, uniformNames[u]), (float)i);
+    uncachedNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / sets;
+
+    glFinish();
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+        for (int u = 0; u < UNIFORM_COUNT; u++)
+            shader.setFloat(names[u], (float)i);
+    byNameNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / sets;
+
+    glFinish();
+    start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+        for (int u = 0; u < UNIFORM_COUNT; u++)
+            shader.setFloat(hashes[u], (float)i);
+    byHashNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / sets;
+
+    glFinish();
+    glUseProgram(0);
+    glDeleteProgram(shader.ID);
+}
+
+// parses "1920x1080"
+bool parseResolution(const char* text, Resolution& resolution)
+{
+    std::string value(text);
+    size_t x = value.find('x');
+    if (x == std::string::npos)
+        return false;
+    resolution.width = atoi(value.substr(0, x).c_str());
+    resolution.height = atoi(value.substr(x + 1).c_str());
+    return resolution.width > 0 && resolution.height > 0;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 1000;
+    int warmup = 100;
+    std::vector<Resolution> resolutions;
+    const char* outputPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        Resolution resolution;
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+            warmup = std::max(0, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (!strcmp(argv[i], "--resolution") && i + 1 < argc && parseResolution(argv[i + 1], resolution))
+        {
+            resolutions.push_back(resolution);
+            i++;
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--frames N] [--warmup N] [--resolution WxH]... [--output results.json]" << std::endl;
+            return -1;
+        }
+    }
+    if (resolutions.empty())
+    {
+        resolutions.push_back({ 800, 600 });
+        resolutions.push_back({ 1920, 1080 });
+    }
+
+    // glfw: initialize and create a hidden window, we only need its context
+    // ----------------------------------------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "LearnOpenGL benchmark", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    std::ofstream file;
+    if (outputPath)
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& json = outputPath ? file : std::cout;
+    json << "{\n  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+         << "  \"version\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+         << "  \"frames\": " << frames << ",\n  \"results\": [";
+
+    bool first = true;
+    for (size_t r = 0; r < resolutions.size(); r++)
+    {
+        const Resolution& resolution = resolutions[r];
+
+        // offscreen target: a single color renderbuffer at the benchmark resolution
+        unsigned int framebuffer, colorbuffer;
+        glGenFramebuffers(1, &framebuffer);
+        glGenRenderbuffers(1, &colorbuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, resolution.width, resolution.height);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorbuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        {
+            std::cerr << "ERROR::FRAMEBUFFER:: Framebuffer is not complete!" << std::endl;
+            return -1;
+        }
+        glViewport(0, 0, resolution.width, resolution.height);
+
+        for (size_t s = 0; s < sizeof(scenes) / sizeof(scenes[0]); s++)
+        {
+            const Scene& scene = scenes[s];
+            SceneState state;
+            scene.setup(state);
+            for (int i = 0; i < warmup; i++)
+                scene.draw(state, i / 60.0);
+            glFinish();
+
+            FrameProfiler profiler;
+            long long drawCalls = 0;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int i = 0; i < frames; i++)
+            {
+                profiler.beginFrame();
+                profiler.beginGpu("scene");
+                drawCalls += scene.draw(state, i / 60.0);
+                profiler.endGpu();
+                glfwSwapBuffers(window);
+                profiler.endFrame();
+            }
+            glFinish();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            // the queries of the last frames are only read back by the next beginFrame
+            profiler.beginFrame();
+            ScopeStats cpu = profiler.stats("frame");
+            ScopeStats gpu = profiler.stats("scene", true);
+            profiler.release();
+            destroyScene(state);
+
+            json << (first ? "\n" : ",\n") << "    { \"scene\": \"" << scene.name << "\", \"width\": " << resolution.width
+                 << ", \"height\": " << resolution.height
+                 << ", \"fps\": " << frames / seconds
+                 << ", \"draw_calls_per_second\": " << drawCalls / seconds
+                 << ", \"cpu_frame_ms_p50\": " << cpu.p50 << ", \"cpu_frame_ms_p99\": " << cpu.p99
+                 << ", \"gpu_ms_avg\": " << gpu.avg << ", \"gpu_ms_p50\": " << gpu.p50 << ", \"gpu_ms_p99\": " << gpu.p99 << " }";
+            first = false;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorbuffer);
+    }
+    json << "\n  ],\n";
+
+    double uncachedNs, byNameNs, byHashNs;
+    measureUniformLookups(frames * 10, uncachedNs, byNameNs, byHashNs);
+    json << "  \"uniform_lookups\": { \"uniforms\": " << UNIFORM_COUNT << ", \"iterations\": " << frames * 10
+         << ", \"glGetUniformLocation_ns_per_set\": " << uncachedNs
+         << ", \"shader_set_by_name_ns_per_set\": " << byNameNs
+         << ", \"shader_set_by_hash_ns_per_set\": " << byHashNs << " }\n}" << std::endl;
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,761 @@
+/* Plays back a capture written by GLCapture (learnopengl/gl_capture.h) as fast as it goes, in a hidden window with
+a context of the captured version, and reports the frame times and the time spent in every command as JSON.
+- Every frame of the capture ends with glFinish, so a frame time covers the GPU work of the frame, not just the
+calls that queued it. The report has the frame times of the capture next to them, and per command the number of
+calls and their CPU time then (capture_ms) and now (replay_ms).
+- Object names, uniform locations, uniform block indices and syncs are translated to the ones the replay gets;
+an untranslated one (an object the capture did not see created) is counted in the report.
+- --baseline compares this run with the report of an earlier one (written by this tool, e.g. with another
+driver or build): the differences go to stderr, the JSON stays where it was, and the exit code is 2 when the mean,
+median or 95th percentile frame time got slower by more than --threshold percent (default 5).
+- Usage: gl_replay capture.glcap [--output replay.json] [--baseline baseline.json] [--threshold percent] */
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <learnopengl/gl_capture.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// reads records out of the capture; a read past the end sets failed and returns zeros
+struct CaptureReader
+{
+    const char* data;
+    const char* end;
+    bool failed = false;
+
+    template <typename T> T get()
+    {
+        T value;
+        std::memset(&value, 0, sizeof(value));
+        if ((size_t)(end - data) < sizeof(T))
+        {
+            failed = true;
+            return value;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        data += sizeof(T);
+        return value;
+    }
+    // NULL for a NULL blob
+    const char* blob(unsigned int& size)
+    {
+        size = get<unsigned int>();
+        if (size == GL_CAPTURE_NULL_BLOB || failed)
+        {
+            size = 0;
+            return NULL;
+        }
+        if ((size_t)(end - data) < size)
+        {
+            failed = true;
+            size = 0;
+            return NULL;
+        }
+        const char* bytes = data;
+        data += size;
+        return bytes;
+    }
+};
+
+struct CommandStats
+{
+    unsigned long calls = 0;
+    double captureMs = 0.0;
+    double replayMs = 0.0;
+};
+
+struct FrameStats
+{
+    double mean = 0.0, median = 0.0, p95 = 0.0, max = 0.0;
+};
+
+// the report of a run, as this tool writes it and reads it back for --baseline
+struct ReplayReport
+{
+    std::vector<double> frameMs;
+    std::vector<std::string> commandNames;
+    std::vector<CommandStats> commands;
+};
+
+// replays the records, translating what the driver handed out during the capture to what it hands out now
+class Replayer
+{
+public:
+    CommandStats stats[GL_CAPTURE_COMMAND_COUNT];
+    std::vector<double> frameMs;
+    std::vector<double> capturedFrameMs;
+    unsigned long untranslated = 0;
+    unsigned long missingEntryPoints = 0;
+    unsigned long failedMappings = 0;
+    unsigned long rejectedBinaries = 0;
+
+    // plays one record; command and the arguments come from the reader
+    // ------------------------------------------------------------------------
+    void replay(int command, CaptureReader& in)
+    {
+        switch (command)
+        {
+        case GL_CAPTURE_FRAME_END:
+        {
+            capturedFrameMs.push_back(in.get<unsigned long long>() / 1e6);
+            glFinish();
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            frameMs.push_back(std::chrono::duration<double, std::milli>(now - frameStart).count());
+            frameStart = now;
+            break;
+        }
+#define GL_REPLAY_SCALAR(name, kinds) \
+        case GL_CAPTURE_##name: \
+            replayScalar(gl##name, kinds, in); \
+            break;
+#define GL_REPLAY_GEN(name, kind) \
+        case GL_CAPTURE_##name: \
+            replayGen(gl##name, kind, in); \
+            break;
+#define GL_REPLAY_DELETE(name, kind) \
+        case GL_CAPTURE_##name: \
+            replayDelete(gl##name, kind, in); \
+            break;
+        GL_CAPTURE_SCALAR_COMMANDS(GL_REPLAY_SCALAR)
+        GL_CAPTURE_GEN_COMMANDS(GL_REPLAY_GEN)
+        GL_CAPTURE_DELETE_COMMANDS(GL_REPLAY_DELETE)
+#undef GL_REPLAY_SCALAR
+#undef GL_REPLAY_GEN
+#undef GL_REPLAY_DELETE
+        case GL_CAPTURE_CreateShader:
+        {
+            GLenum type = in.get<GLenum>();
+            GLuint recorded = in.get<GLuint>();
+            names['s'][recorded] = glCreateShader(type);
+            break;
+        }
+        case GL_CAPTURE_CreateProgram:
+            names['p'][in.get<GLuint>()] = glCreateProgram();
+            break;
+        case GL_CAPTURE_ShaderSource:
+        {
+            GLuint shader = translate('s', in.get<GLuint>());
+            GLsizei count = in.get<GLsizei>();
+            std::vector<const GLchar*> strings;
+            std::vector<GLint> lengths;
+            for (GLsizei i = 0; i < count && !in.failed; i++)
+            {
+                unsigned int size;
+                strings.push_back(in.blob(size));
+                lengths.push_back((GLint)size);
+            }
+            if (!in.failed)
+                glShaderSource(shader, count, strings.data(), lengths.data());
+            break;
+        }
+        case GL_CAPTURE_GetUniformLocation:
+        case GL_CAPTURE_GetUniformBlockIndex:
+        {
+            GLuint program = in.get<GLuint>();
+            unsigned int size;
+            const char* bytes = in.blob(size);
+            std::string name(bytes ? bytes : "", size);
+            if (command == GL_CAPTURE_GetUniformLocation)
+            {
+                GLint recorded = in.get<GLint>();
+                locations[key(program, recorded)] = glGetUniformLocation(translate('p', program), name.c_str());
+            }
+            else
+            {
+                GLuint recorded = in.get<GLuint>();
+                blockIndices[key(program, recorded)] = glGetUniformBlockIndex(translate('p', program), name.c_str());
+            }
+            break;
+        }
+        case GL_CAPTURE_BufferData:
+        case GL_CAPTURE_BufferStorage:
+        {
+            GLenum target = in.get<GLenum>();
+            GLsizeiptr size = (GLsizeiptr)in.get<unsigned long long>();
+            unsigned int blobSize;
+            const char* data = in.blob(blobSize);
+            GLenum usageOrFlags = in.get<GLenum>();
+            if (in.failed)
+                break;
+            if (command == GL_CAPTURE_BufferData)
+                glBufferData(target, size, data, usageOrFlags);
+            else if (loaded(glBufferStorage))
+                glBufferStorage(target, size, data, usageOrFlags);
+            else
+                missingEntryPoints++;
+            break;
+        }
+        case GL_CAPTURE_BufferSubData:
+        {
+            GLenum target = in.get<GLenum>();
+            GLintptr offset = (GLintptr)in.get<unsigned long long>();
+            unsigned int size;
+            const char* data = in.blob(size);
+            if (!in.failed)
+                glBufferSubData(target, offset, size, data);
+            break;
+        }
+        case GL_CAPTURE_UnmapBuffer:
+        {
+            // the writes of the captured mapping, through a mapping of our own
+            GLenum target = in.get<GLenum>();
+            GLintptr offset = (GLintptr)in.get<unsigned long long>();
+            GLbitfield access = in.get<GLbitfield>();
+            unsigned int size;
+            const char* data = in.blob(size);
+            if (in.failed || size == 0)
+                break;
+            access &= GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+            void* mapped = glMapBufferRange(target, offset, size, GL_MAP_WRITE_BIT | access);
+            if (!mapped)
+            {
+                failedMappings++;
+                break;
+            }
+            std::memcpy(mapped, data, size);
+            glUnmapBuffer(target);
+            break;
+        }
+        case GL_CAPTURE_TexImage2D:
+        case GL_CAPTURE_TexImage3D:
+        {
+            GLenum target = in.get<GLenum>();
+            GLint level = in.get<GLint>();
+            GLint internalformat = in.get<GLint>();
+            GLsizei width = in.get<GLsizei>();
+            GLsizei height = in.get<GLsizei>();
+            GLsizei depth = command == GL_CAPTURE_TexImage3D ? in.get<GLsizei>() : 1;
+            GLint border = in.get<GLint>();
+            GLenum format = in.get<GLenum>();
+            GLenum type = in.get<GLenum>();
+            PixelSource pixels(in);
+            if (in.failed)
+                break;
+            if (command == GL_CAPTURE_TexImage2D)
+                glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels.data);
+            else
+                glTexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels.data);
+            break;
+        }
+        case GL_CAPTURE_CompressedTexImage2D:
+        {
+            GLenum target = in.get<GLenum>();
+            GLint level = in.get<GLint>();
+            GLenum internalformat = in.get<GLenum>();
+            GLsizei width = in.get<GLsizei>();
+            GLsizei height = in.get<GLsizei>();
+            GLint border = in.get<GLint>();
+            GLsizei imageSize = in.get<GLsizei>();
+            PixelSource data(in);
+            if (!in.failed)
+                glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data.data);
+            break;
+        }
+        case GL_CAPTURE_Uniform4fv:
+        {
+            GLint location = translateLocation(in.get<GLint>());
+            GLsizei count = in.get<GLsizei>();
+            unsigned int size;
+            const char* values = in.blob(size);
+            if (!in.failed && size >= 4 * sizeof(GLfloat) * count)
+            {
+                // the blob is not aligned in the file
+                std::vector<GLfloat> aligned(4 * count);
+                std::memcpy(aligned.data(), values, aligned.size() * sizeof(GLfloat));
+                glUniform4fv(location, count, aligned.data());
+            }
+            break;
+        }
+        case GL_CAPTURE_FenceSync:
+        {
+            GLenum condition = in.get<GLenum>();
+            GLbitfield flags = in.get<GLbitfield>();
+            unsigned long long recorded = in.get<unsigned long long>();
+            syncs[recorded] = glFenceSync(condition, flags);
+            break;
+        }
+        case GL_CAPTURE_ClientWaitSync:
+        {
+            unsigned long long recorded = in.get<unsigned long long>();
+            GLbitfield flags = in.get<GLbitfield>();
+            GLuint64 timeout = in.get<GLuint64>();
+            std::unordered_map<unsigned long long, GLsync>::iterator it = syncs.find(recorded);
+            if (it != syncs.end())
+                glClientWaitSync(it->second, flags, timeout);
+            else
+                untranslated++;
+            break;
+        }
+        case GL_CAPTURE_DeleteSync:
+        {
+            std::unordered_map<unsigned long long, GLsync>::iterator it = syncs.find(in.get<unsigned long long>());
+            if (it != syncs.end())
+            {
+                glDeleteSync(it->second);
+                syncs.erase(it);
+            }
+            break;
+        }
+        case GL_CAPTURE_ProgramBinary:
+        {
+            GLuint program = translate('p', in.get<GLuint>());
+            GLenum format = in.get<GLenum>();
+            unsigned int size;
+            const char* binary = in.blob(size);
+            if (in.failed)
+                break;
+            glProgramBinary(program, format, binary, size);
+            GLint linked = 0;
+            glGetProgramiv(program, GL_LINK_STATUS, &linked);
+            if (!linked)
+                rejectedBinaries++;
+            break;
+        }
+        default:
+            in.failed = true;
+            break;
+        }
+        if (command == GL_CAPTURE_UseProgram)
+            currentProgram = lastProgram;
+    }
+    // starts the time of the first frame
+    // ------------------------------------------------------------------------
+    void start()
+    {
+        frameStart = std::chrono::steady_clock::now();
+    }
+
+private:
+    std::unordered_map<GLuint, GLuint> names[128]; // by the kind letter of GL_CAPTURE_SCALAR_COMMANDS
+    std::unordered_map<unsigned long long, GLint> locations;
+    std::unordered_map<unsigned long long, GLuint> blockIndices;
+    std::unordered_map<unsigned long long, GLsync> syncs;
+    std::chrono::steady_clock::time_point frameStart;
+    GLuint currentProgram = 0; // the captured name, uniform locations belong to it
+    GLuint lastProgram = 0;    // the captured program argument of the record being replayed
+    const char* kinds = "";
+    int argument = 0;
+
+    // the pixels of a glTexImage*: client memory (with the unpack buffer unbound meanwhile) or an unpack buffer offset
+    struct PixelSource
+    {
+        const void* data = NULL;
+        GLint unpackBuffer = 0;
+        std::vector<char> aligned;
+
+        PixelSource(CaptureReader& in)
+        {
+            unsigned char source = in.get<unsigned char>();
+            if (source == 2)
+            {
+                data = (const void*)(uintptr_t)in.get<unsigned long long>();
+                return;
+            }
+            if (source != 1)
+                return;
+            unsigned int size;
+            const char* bytes = in.blob(size);
+            aligned.assign(bytes, bytes + size);
+            data = aligned.data();
+            glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+            if (unpackBuffer)
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+        ~PixelSource()
+        {
+            if (unpackBuffer)
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+        }
+    };
+
+    // ------------------------------------------------------------------------
+    static unsigned long long key(GLuint program, GLuint value)
+    {
+        return ((unsigned long long)program << 32) | value;
+    }
+    // ------------------------------------------------------------------------
+    template <typename F> static bool loaded(F function)
+    {
+        return function != NULL;
+    }
+    // ------------------------------------------------------------------------
+    GLuint translate(char kind, GLuint recorded)
+    {
+        if (recorded == 0)
+            return 0;
+        std::unordered_map<GLuint, GLuint>::iterator it = names[(int)kind].find(recorded);
+        if (it != names[(int)kind].end())
+            return it->second;
+        untranslated++;
+        return recorded;
+    }
+    // ------------------------------------------------------------------------
+    GLint translateLocation(GLint recorded)
+    {
+        if (recorded < 0)
+            return recorded;
+        std::unordered_map<unsigned long long, GLint>::iterator it = locations.find(key(currentProgram, recorded));
+        if (it != locations.end())
+            return it->second;
+        untranslated++;
+        return recorded;
+    }
+    // the next argument of a scalar command, translated according to its letter
+    // ------------------------------------------------------------------------
+    template <typename T> T arg(CaptureReader& in)
+    {
+        char kind = kinds[argument++];
+        if constexpr (std::is_pointer<T>::value)
+        {
+            return (T)(uintptr_t)in.get<unsigned long long>();
+        }
+        else
+        {
+            T value = in.get<T>();
+            if constexpr (std::is_integral<T>::value)
+            {
+                if (kind == 'u')
+                    return (T)translateLocation((GLint)value);
+                if (kind == 'k')
+                {
+                    std::unordered_map<unsigned long long, GLuint>::iterator it = blockIndices.find(key(lastProgram, (GLuint)value));
+                    return it != blockIndices.end() ? (T)it->second : value;
+                }
+                if (kind == 'p')
+                    lastProgram = (GLuint)value;
+                if (kind != 'v')
+                    return (T)translate(kind, (GLuint)value);
+            }
+            return value;
+        }
+    }
+    // ------------------------------------------------------------------------
+    template <typename... Args> void replayScalar(void (APIENTRYP function)(Args...), const char* commandKinds, CaptureReader& in)
+    {
+        kinds = commandKinds;
+        argument = 0;
+        // a braced list is evaluated in order, so the arguments are read in order
+        std::tuple<Args...> args{ arg<Args>(in)... };
+        if (in.failed)
+            return;
+        if (!function)
+        {
+            missingEntryPoints++;
+            return;
+        }
+        std::apply(function, args);
+    }
+    // ------------------------------------------------------------------------
+    void replayGen(void (APIENTRYP gen)(GLsizei, GLuint*), char kind, CaptureReader& in)
+    {
+        GLsizei n = in.get<GLsizei>();
+        std::vector<GLuint> recorded(std::max(n, 0));
+        for (GLsizei i = 0; i < n; i++)
+            recorded[i] = in.get<GLuint>();
+        if (in.failed || n <= 0)
+            return;
+        std::vector<GLuint> created(n);
+        gen(n, created.data());
+        for (GLsizei i = 0; i < n; i++)
+            names[(int)kind][recorded[i]] = created[i];
+    }
+    // ------------------------------------------------------------------------
+    void replayDelete(void (APIENTRYP remove)(GLsizei, const GLuint*), char kind, CaptureReader& in)
+    {
+        GLsizei n = in.get<GLsizei>();
+        std::vector<GLuint> deleted;
+        for (GLsizei i = 0; i < n && !in.failed; i++)
+        {
+            GLuint recorded = in.get<GLuint>();
+            deleted.push_back(translate(kind, recorded));
+            names[(int)kind].erase(recorded);
+        }
+        if (!in.failed && !deleted.empty())
+            remove((GLsizei)deleted.size(), deleted.data());
+    }
+};
+
+// ------------------------------------------------------------------------
+FrameStats frameStats(std::vector<double> values)
+{
+    FrameStats stats;
+    if (values.empty())
+        return stats;
+    std::sort(values.begin(), values.end());
+    for (size_t i = 0; i < values.size(); i++)
+        stats.mean += values[i];
+    stats.mean /= values.size();
+    stats.median = values[values.size() / 2];
+    stats.p95 = values[std::min(values.size() - 1, (size_t)(0.95 * values.size()))];
+    stats.max = values.back();
+    return stats;
+}
+
+// ------------------------------------------------------------------------
+void writeStats(std::ostream& json, const FrameStats& stats)
+{
+    json << "{ \"mean\": " << stats.mean << ", \"median\": " << stats.median << ", \"p95\": " << stats.p95
+         << ", \"max\": " << stats.max << " }";
+}
+
+// reads back the per_frame_ms and commands of a report this tool wrote (it is not a general JSON parser)
+// ------------------------------------------------------------------------
+bool readReport(const char* path, ReplayReport& report)
+{
+    std::ifstream file(path);
+    if (!file)
+        return false;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        size_t frames = line.find("\"per_frame_ms\": [");
+        if (frames != std::string::npos)
+        {
+            std::istringstream values(line.substr(frames + std::strlen("\"per_frame_ms\": [")));
+            double value;
+            char separator;
+            while (values >> value)
+            {
+                report.frameMs.push_back(value);
+                if (!(values >> separator) || separator != ',')
+                    break;
+            }
+            continue;
+        }
+        char name[128];
+        CommandStats stats;
+        if (std::sscanf(line.c_str(), " { \"command\": \"%127[^\"]\", \"calls\": %lu, \"capture_ms\": %lf, \"replay_ms\": %lf",
+                        name, &stats.calls, &stats.captureMs, &stats.replayMs) == 4)
+        {
+            report.commandNames.push_back(name);
+            report.commands.push_back(stats);
+        }
+    }
+    return !report.frameMs.empty();
+}
+
+// prints how this run differs from the baseline and returns whether a frame statistic regressed past threshold
+// ------------------------------------------------------------------------
+bool compareWithBaseline(const ReplayReport& baseline, const ReplayReport& current, const char* baselinePath, double threshold)
+{
+    std::ostream& out = std::cerr;
+    out << "gl_replay: compared with " << baselinePath << " (" << baseline.frameMs.size() << " frames, this run "
+        << current.frameMs.size() << ")" << std::endl;
+    if (baseline.frameMs.size() != current.frameMs.size())
+        out << "  the frame counts differ, these are probably replays of different captures" << std::endl;
+
+    FrameStats before = frameStats(baseline.frameMs), after = frameStats(current.frameMs);
+    const char* statNames[] = { "mean", "median", "p95", "max" };
+    double beforeValues[] = { before.mean, before.median, before.p95, before.max };
+    double afterValues[] = { after.mean, after.median, after.p95, after.max };
+    bool regressed = false;
+    for (int i = 0; i < 4; i++)
+    {
+        double change = beforeValues[i] > 0.0 ? 100.0 * (afterValues[i] - beforeValues[i]) / beforeValues[i] : 0.0;
+        // the maximum is a single frame, too noisy to fail a run on
+        bool regression = i < 3 && change > threshold;
+        regressed = regressed || regression;
+        char row[160];
+        std::snprintf(row, sizeof(row), "  frame %-7s %9.3f ms -> %9.3f ms  %+7.1f%%%s", statNames[i], beforeValues[i],
+                      afterValues[i], change, regression ? "  REGRESSION" : "");
+        out << row << std::endl;
+    }
+
+    // the commands whose total replay time moved the most
+    struct Change
+    {
+        std::string name;
+        double before, after;
+        unsigned long callsBefore, callsAfter;
+    };
+    std::vector<Change> changes;
+    for (size_t i = 0; i < current.commands.size(); i++)
+    {
+        Change change = { current.commandNames[i], 0.0, current.commands[i].replayMs, 0, current.commands[i].calls };
+        for (size_t j = 0; j < baseline.commands.size(); j++)
+            if (baseline.commandNames[j] == current.commandNames[i])
+            {
+                change.before = baseline.commands[j].replayMs;
+                change.callsBefore = baseline.commands[j].calls;
+            }
+        changes.push_back(change);
+    }
+    std::sort(changes.begin(), changes.end(), [](const Change& a, const Change& b)
+    {
+        return std::fabs(a.after - a.before) > std::fabs(b.after - b.before);
+    });
+    out << "  commands with the largest change in replay time:" << std::endl;
+    for (size_t i = 0; i < std::min<size_t>(changes.size(), 10); i++)
+    {
+        const Change& change = changes[i];
+        double percent = change.before > 0.0 ? 100.0 * (change.after - change.before) / change.before : 0.0;
+        char row[200];
+        std::snprintf(row, sizeof(row), "    %-34s %9.3f ms -> %9.3f ms  %+7.1f%%", change.name.c_str(), change.before,
+                      change.after, percent);
+        out << row;
+        if (change.callsBefore != change.callsAfter)
+            out << "  (" << change.callsBefore << " -> " << change.callsAfter << " calls)";
+        out << std::endl;
+    }
+    return regressed;
+}
+
+int main(int argc, char** argv)
+{
+    const char* capturePath = NULL;
+    const char* outputPath = NULL;
+    const char* baselinePath = NULL;
+    double threshold = 5.0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (!strcmp(argv[i], "--threshold") && i + 1 < argc)
+            threshold = std::max(0.0, atof(argv[++i]));
+        else if (argv[i][0] != '-' && !capturePath)
+            capturePath = argv[i];
+        else
+        {
+            capturePath = NULL;
+            break;
+        }
+    }
+    if (!capturePath)
+    {
+        std::cerr << "usage: " << argv[0] << " capture.glcap [--output replay.json] [--baseline baseline.json] [--threshold percent]" << std::endl;
+        return -1;
+    }
+
+    std::ifstream captureFile(capturePath, std::ios::binary);
+    std::vector<char> capture((std::istreambuf_iterator<char>(captureFile)), std::istreambuf_iterator<char>());
+    GLCaptureHeader header;
+    if (capture.size() < sizeof(header) || std::memcmp(capture.data(), GL_CAPTURE_MAGIC, sizeof(GL_CAPTURE_MAGIC)) != 0)
+    {
+        std::cerr << "Failed to read the capture " << capturePath << std::endl;
+        return -1;
+    }
+    std::memcpy(&header, capture.data(), sizeof(header));
+    ReplayReport baseline;
+    if (baselinePath && !readReport(baselinePath, baseline))
+    {
+        std::cerr << "Failed to read the baseline " << baselinePath << std::endl;
+        return -1;
+    }
+
+    // glfw: initialize and create a hidden window with a context of the captured version
+    // -----------------------------------------------------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, header.majorVersion);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, header.minorVersion);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    GLFWwindow* window = glfwCreateWindow(std::max(header.width, 1), std::max(header.height, 1), "LearnOpenGL replay", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cerr << "Failed to create a GLFW window with OpenGL " << header.majorVersion << "." << header.minorVersion << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    // replay
+    // ------
+    Replayer replayer;
+    CaptureReader in = { capture.data() + sizeof(header), capture.data() + capture.size() };
+    replayer.start();
+    while (in.data < in.end)
+    {
+        unsigned short command = in.get<unsigned short>();
+        unsigned int ns = in.get<unsigned int>();
+        unsigned int size = in.get<unsigned int>();
+        if (in.failed || command >= GL_CAPTURE_COMMAND_COUNT || (size_t)(in.end - in.data) < size)
+        {
+            std::cerr << "The capture is damaged at byte " << in.data - capture.data() << ", replayed up to there" << std::endl;
+            break;
+        }
+        CaptureReader record = { in.data, in.data + size };
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        replayer.replay(command, record);
+        CommandStats& stats = replayer.stats[command];
+        stats.replayMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        stats.captureMs += ns / 1e6;
+        stats.calls++;
+        in.data += size;
+    }
+    glFinish();
+
+    // report
+    // ------
+    std::ofstream file;
+    if (outputPath)
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& json = outputPath ? file : std::cout;
+    json << "{\n  \"capture\": \"" << capturePath << "\",\n"
+         << "  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+         << "  \"version\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+         << "  \"frames\": " << replayer.frameMs.size() << ",\n  \"frame_ms\": ";
+    writeStats(json, frameStats(replayer.frameMs));
+    json << ",\n  \"capture_frame_ms\": ";
+    writeStats(json, frameStats(replayer.capturedFrameMs));
+    json << ",\n  \"untranslated_names\": " << replayer.untranslated << ", \"missing_entry_points\": " << replayer.missingEntryPoints
+         << ", \"failed_mappings\": " << replayer.failedMappings << ", \"rejected_program_binaries\": " << replayer.rejectedBinaries
+         << ",\n  \"per_frame_ms\": [";
+    for (size_t i = 0; i < replayer.frameMs.size(); i++)
+        json << (i > 0 ? ", " : "") << replayer.frameMs[i];
+    json << "],\n  \"commands\": [";
+
+    ReplayReport current;
+    current.frameMs = replayer.frameMs;
+    bool first = true;
+    for (int command = GL_CAPTURE_FRAME_END + 1; command < GL_CAPTURE_COMMAND_COUNT; command++)
+    {
+        const CommandStats& stats = replayer.stats[command];
+        if (stats.calls == 0)
+            continue;
+        json << (first ? "\n" : ",\n") << "    { \"command\": \"" << glCaptureCommandNames[command] << "\", \"calls\": " << stats.calls
+             << ", \"capture_ms\": " << stats.captureMs << ", \"replay_ms\": " << stats.replayMs << " }";
+        current.commandNames.push_back(glCaptureCommandNames[command]);
+        current.commands.push_back(stats);
+        first = false;
+    }
+    json << "\n  ]\n}" << std::endl;
+
+    bool regressed = baselinePath && compareWithBaseline(baseline, current, baselinePath, threshold);
+    glfwTerminate();
+    return regressed ? 2 : 0;
+}
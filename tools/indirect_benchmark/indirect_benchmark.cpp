@@ -0,0 +1,256 @@
+/* Measures how the cost of submitting N objects scales, one glDrawElements per object against a single
+glMultiDrawElementsIndirect for all of them, and reports the results as JSON.
+- Both paths draw the same grid of rectangles and triangles out of the same MeshPool, into a small offscreen
+framebuffer, so what differs is the submission: per_draw sets two uniforms and issues one draw call per
+object, multi_draw_indirect reads the same data from an indirect buffer and a shader storage buffer.
+- Needs an OpenGL 4.3 context.
+- Usage: indirect_benchmark [--frames N] [--warmup N] [--counts 1,10,100,...] [--output results.json] */
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <learnopengl/frame_profiler.h>
+#include <learnopengl/multi_draw.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// the per-draw baseline: the same transform as the multi-draw shader, from uniforms
+const char *perDrawVertexSource = "#version 430 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "uniform vec4 offsetScale;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(aPos.xy * offsetScale.zw + offsetScale.xy, aPos.z, 1.0);\n"
+    "}\0";
+const char *perDrawFragmentSource = "#version 430 core\n"
+    "uniform vec4 color;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = color;\n"
+    "}\n\0";
+
+unsigned int compileProgram(const char* vertexSource, const char* fragmentSource)
+{
+    int success;
+    char infoLog[512];
+    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vertexSource, NULL);
+    glCompileShader(vertex);
+    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fragmentSource, NULL);
+    glCompileShader(fragment);
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return program;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 300;
+    int warmup = 30;
+    std::vector<int> counts;
+    const char* outputPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+            warmup = std::max(0, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--counts") && i + 1 < argc)
+        {
+            std::string list(argv[++i]);
+            for (size_t start = 0; start < list.size();)
+            {
+                size_t end = list.find(',', start);
+                if (end == std::string::npos)
+                    end = list.size();
+                int count = atoi(list.substr(start, end - start).c_str());
+                if (count > 0)
+                    counts.push_back(count);
+                start = end + 1;
+            }
+        }
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--frames N] [--warmup N] [--counts 1,10,100,...] [--output results.json]" << std::endl;
+            return -1;
+        }
+    }
+    if (counts.empty())
+        for (int count = 1; count <= 100000; count *= 10)
+            counts.push_back(count);
+
+    // glfw: initialize and create a hidden window, we only need its context
+    // ----------------------------------------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "LearnOpenGL indirect benchmark", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cerr << "Failed to create an OpenGL 4.3 window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+    if (!multiDrawIndirectSupported())
+    {
+        std::cerr << "glMultiDrawElementsIndirect is not supported" << std::endl;
+        return -1;
+    }
+
+    std::ofstream file;
+    if (outputPath)
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& json = outputPath ? file : std::cout;
+    json << "{\n  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+         << "  \"version\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+         << "  \"frames\": " << frames << ",\n  \"results\": [";
+
+    // offscreen target, small so that the fill rate does not matter
+    unsigned int framebuffer, colorbuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &colorbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 256, 256);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorbuffer);
+    glViewport(0, 0, 256, 256);
+
+    // the two meshes of hello_rectangle and hello_triangle
+    float rectangle[] = { 0.5f, 0.5f, 0.0f,  0.5f, -0.5f, 0.0f,  -0.5f, -0.5f, 0.0f,  -0.5f, 0.5f, 0.0f };
+    unsigned int rectangleIndices[] = { 0, 1, 3,  1, 2, 3 };
+    float triangle[] = { -0.5f, -0.5f, 0.0f,  0.5f, -0.5f, 0.0f,  0.0f, 0.5f, 0.0f };
+    unsigned int triangleIndices[] = { 0, 1, 2 };
+    MeshPool pool(16, 16);
+    int meshes[2] = { pool.add(rectangle, 4, rectangleIndices, 6), pool.add(triangle, 3, triangleIndices, 3) };
+
+    unsigned int perDrawProgram = compileProgram(perDrawVertexSource, perDrawFragmentSource);
+    int offsetScaleLocation = glGetUniformLocation(perDrawProgram, "offsetScale");
+    int colorLocation = glGetUniformLocation(perDrawProgram, "color");
+    std::string multiDrawVertexSource = multiDrawVertexShader();
+    unsigned int multiDrawProgram = compileProgram(multiDrawVertexSource.c_str(), multiDrawFragmentSource);
+
+    bool first = true;
+    for (size_t c = 0; c < counts.size(); c++)
+    {
+        int count = counts[c];
+        MultiDrawBatch batch(pool);
+        int side = (int)std::ceil(std::sqrt((double)count));
+        float size = 2.0f / side;
+        for (int i = 0; i < count; i++)
+        {
+            DrawData data;
+            data.offsetScale[0] = -1.0f + (i % side + 0.5f) * size;
+            data.offsetScale[1] = -1.0f + (i / side + 0.5f) * size;
+            data.offsetScale[2] = data.offsetScale[3] = size * 0.9f;
+            data.color[0] = 1.0f; data.color[1] = 0.5f; data.color[2] = 0.2f; data.color[3] = 1.0f;
+            batch.add(meshes[i % 2], data);
+        }
+        batch.upload();
+
+        for (int multi = 0; multi < 2; multi++)
+        {
+            FrameProfiler profiler;
+            std::chrono::steady_clock::time_point start;
+            for (int f = -warmup; f < frames; f++)
+            {
+                if (f == 0)
+                {
+                    glFinish();
+                    start = std::chrono::steady_clock::now();
+                }
+                profiler.beginFrame();
+                profiler.beginGpu("frame");
+                glClear(GL_COLOR_BUFFER_BIT);
+                profiler.beginCpu("submit");
+                if (multi)
+                {
+                    glUseProgram(multiDrawProgram);
+                    batch.draw();
+                }
+                else
+                {
+                    glUseProgram(perDrawProgram);
+                    glBindVertexArray(pool.VAO);
+                    for (int i = 0; i < count; i++)
+                    {
+                        const DrawElementsIndirectCommand& command = batch.commands[i];
+                        const DrawData& data = batch.drawData[i];
+                        glUniform4fv(offsetScaleLocation, 1, data.offsetScale);
+                        glUniform4fv(colorLocation, 1, data.color);
+                        glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+                                                 (void*)(command.firstIndex * sizeof(unsigned int)), command.baseVertex);
+                    }
+                }
+                profiler.endCpu("submit");
+                profiler.endGpu();
+                glfwSwapBuffers(window);
+                profiler.endFrame();
+            }
+            glFinish();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            profiler.beginFrame();
+            ScopeStats submit = profiler.stats("submit");
+            ScopeStats gpu = profiler.stats("frame", true);
+            profiler.release();
+
+            json << (first ? "\n" : ",\n") << "    { \"method\": \"" << (multi ? "multi_draw_indirect" : "per_draw") << "\""
+                 << ", \"objects\": " << count
+                 << ", \"fps\": " << frames / seconds
+                 << ", \"submit_ms_p50\": " << submit.p50 << ", \"submit_ms_p99\": " << submit.p99
+                 << ", \"submit_us_per_object\": " << 1000.0 * submit.p50 / count
+                 << ", \"gpu_ms_avg\": " << gpu.avg << " }";
+            first = false;
+        }
+        batch.release();
+    }
+    json << "\n  ]\n}" << std::endl;
+
+    glDeleteProgram(perDrawProgram);
+    glDeleteProgram(multiDrawProgram);
+    pool.release();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorbuffer);
+    glfwTerminate();
+    return 0;
+}
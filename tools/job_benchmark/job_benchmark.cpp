@@ -0,0 +1,141 @@
+/* Measures how the instance transform update of a frame scales with the threads of a JobSystem
+(learnopengl/job_system.h), from 1 thread up to every core, and reports the results as JSON.
+- Every frame integrates the position and rotation of --instances instances and rebuilds their 4x4 model
+matrices with one parallelFor of --grain instances per job, the kind of update the instancing stress mode
+of perf_playground does before its upload.
+- No OpenGL context is needed; the times are CPU wall clock per frame (median and 95th percentile).
+- Usage: job_benchmark [--instances N] [--grain N] [--frames N] [--warmup N] [--max-threads N] [--output results.json] */
+#include <learnopengl/job_system.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+struct InstanceState
+{
+    float position[3];
+    float velocity[3];
+    float angle;
+    float angularVelocity;
+};
+
+// one instance step: move, bounce off the unit cube, spin around z and write the model matrix (column major)
+void updateInstances(std::vector<InstanceState>& states, std::vector<float>& matrices, size_t begin, size_t end, float deltaTime)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        InstanceState& state = states[i];
+        for (int j = 0; j < 3; j++)
+        {
+            state.position[j] += state.velocity[j] * deltaTime;
+            if (state.position[j] < -1.0f || state.position[j] > 1.0f)
+                state.velocity[j] = -state.velocity[j];
+        }
+        state.angle += state.angularVelocity * deltaTime;
+        float c = std::cos(state.angle), s = std::sin(state.angle);
+        float* m = &matrices[i * 16];
+        m[0] = c;    m[1] = s;    m[2] = 0.0f;  m[3] = 0.0f;
+        m[4] = -s;   m[5] = c;    m[6] = 0.0f;  m[7] = 0.0f;
+        m[8] = 0.0f; m[9] = 0.0f; m[10] = 1.0f; m[11] = 0.0f;
+        m[12] = state.position[0]; m[13] = state.position[1]; m[14] = state.position[2]; m[15] = 1.0f;
+    }
+}
+
+double percentile(std::vector<double> values, double p)
+{
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t)(p * values.size()))];
+}
+
+int main(int argc, char** argv)
+{
+    size_t instances = 1 << 20;
+    size_t grain = 4096;
+    int frames = 200;
+    int warmup = 20;
+    unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    const char* outputPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--instances") && i + 1 < argc)
+            instances = std::max(1L, atol(argv[++i]));
+        else if (!strcmp(argv[i], "--grain") && i + 1 < argc)
+            grain = std::max(1L, atol(argv[++i]));
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+            warmup = std::max(0, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--max-threads") && i + 1 < argc)
+            maxThreads = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--instances N] [--grain N] [--frames N] [--warmup N] [--max-threads N] [--output results.json]" << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<InstanceState> states(instances);
+    std::vector<float> matrices(instances * 16);
+    for (size_t i = 0; i < instances; i++)
+    {
+        // a fixed pseudo random start, so every thread count does the same work
+        unsigned int hash = (unsigned int)i * 2654435761u;
+        for (int j = 0; j < 3; j++)
+        {
+            hash ^= hash >> 15;
+            hash *= 2246822519u;
+            states[i].position[j] = (hash & 0xFFFF) / 32768.0f - 1.0f;
+            states[i].velocity[j] = ((hash >> 16) & 0xFFFF) / 65536.0f - 0.5f;
+        }
+        states[i].angle = 0.0f;
+        states[i].angularVelocity = (float)(i % 7) - 3.0f;
+    }
+
+    std::ofstream file;
+    if (outputPath)
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& json = outputPath ? file : std::cout;
+    json << "{\n  \"instances\": " << instances << ", \"grain\": " << grain << ", \"frames\": " << frames
+         << ", \"cores\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [";
+
+    double singleThreaded = 0.0;
+    for (unsigned int threads = 1; threads <= maxThreads; threads++)
+    {
+        JobSystem jobs(threads);
+        std::vector<double> times;
+        for (int frame = 0; frame < warmup + frames; frame++)
+        {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            jobs.parallelFor(0, instances, grain, [&](size_t begin, size_t end)
+            {
+                updateInstances(states, matrices, begin, end, 1.0f / 60.0f);
+            });
+            if (frame >= warmup)
+                times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        double median = percentile(times, 0.5);
+        if (threads == 1)
+            singleThreaded = median;
+        double speedup = singleThreaded / median;
+        json << (threads > 1 ? "," : "") << "\n    { \"threads\": " << threads << ", \"median_ms\": " << median
+             << ", \"p95_ms\": " << percentile(times, 0.95) << ", \"speedup\": " << speedup
+             << ", \"efficiency\": " << speedup / threads << " }";
+    }
+    json << "\n  ]\n}" << std::endl;
+    return 0;
+}
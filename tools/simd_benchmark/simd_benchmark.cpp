@@ -0,0 +1,169 @@
+/* Runs every kernel of learnopengl/simd_kernels.h with every instruction set this CPU supports and reports the
+throughput (elements per second) as JSON, next to the largest difference from the scalar reference.
+- Each kernel processes --count elements per run: matrices for multiply_mat4, spheres for transform_spheres,
+floats for the packing kernels. The median of --runs runs is reported, after --warmup runs.
+- max_error is the largest absolute difference of a result from the scalar one (in units of the last place for
+the packing kernels); the FMA kernels differ in the last bits, the half packing by one ulp on exact ties.
+- No OpenGL context is needed.
+- Usage: simd_benchmark [--count N] [--runs N] [--warmup N] [--output results.json] */
+#include <glad/glad.h>
+
+#include <learnopengl/simd_kernels.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+// SoA views of 16 (matrices) or 4 (spheres) arrays of count floats in one buffer
+Mat4SoA matrices(std::vector<float>& storage, size_t count)
+{
+    storage.resize(16 * count);
+    Mat4SoA soa;
+    for (int e = 0; e < 16; e++)
+        soa.m[e] = &storage[e * count];
+    return soa;
+}
+SphereSoA spheres(std::vector<float>& storage, size_t count)
+{
+    storage.resize(4 * count);
+    SphereSoA soa = { &storage[0], &storage[count], &storage[2 * count], &storage[3 * count] };
+    return soa;
+}
+
+// median seconds of one call to kernel
+double measure(const std::function<void()>& kernel, int runs, int warmup)
+{
+    for (int i = 0; i < warmup; i++)
+        kernel();
+    std::vector<double> times;
+    for (int i = 0; i < runs; i++)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        kernel();
+        times.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+template <typename T>
+double maxError(const std::vector<T>& values, const std::vector<T>& reference)
+{
+    double error = 0.0;
+    for (size_t i = 0; i < values.size(); i++)
+        if (values[i] == values[i]) // NaN inputs give NaN in both, with payloads that may differ
+            error = std::max(error, std::fabs((double)values[i] - (double)reference[i]));
+    return error;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = 1 << 16;
+    int runs = 101;
+    int warmup = 10;
+    const char* outputPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--count") && i + 1 < argc)
+            count = std::max(1L, atol(argv[++i]));
+        else if (!strcmp(argv[i], "--runs") && i + 1 < argc)
+            runs = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+            warmup = std::max(0, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--count N] [--runs N] [--warmup N] [--output results.json]" << std::endl;
+            return -1;
+        }
+    }
+
+    // inputs: rotation-and-scale model matrices, spheres, and floats a little beyond [0, 1] for the packing
+    std::vector<float> modelStorage, sphereStorage;
+    Mat4SoA models = matrices(modelStorage, count);
+    SphereSoA localSpheres = spheres(sphereStorage, count);
+    std::vector<float> values(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        float angle = 0.001f * i, scale = 0.5f + (i % 5) * 0.25f;
+        float model[16] = { scale * std::cos(angle), scale * std::sin(angle), 0.0f, 0.0f,
+                            -scale * std::sin(angle), scale * std::cos(angle), 0.0f, 0.0f,
+                            0.0f, 0.0f, scale, 0.0f,
+                            (float)(i % 100) - 50.0f, (float)(i / 100 % 100) - 50.0f, 0.0f, 1.0f };
+        for (int e = 0; e < 16; e++)
+            models.m[e][i] = model[e];
+        localSpheres.x[i] = 0.1f * (i % 3);
+        localSpheres.y[i] = -0.1f * (i % 7);
+        localSpheres.z[i] = 0.05f;
+        localSpheres.radius[i] = 0.5f + 0.01f * (i % 11);
+        values[i] = -0.1f + 1.2f * (float)((i * 2654435761u) % 100000) / 100000.0f;
+    }
+    float viewProjection[16] = { 1.2f, 0.0f, 0.0f, 0.0f, 0.0f, 1.6f, 0.0f, 0.0f, 0.0f, 0.0f, -1.002f, -1.0f, 0.0f, 0.0f, -0.2f, 0.0f };
+
+    // the scalar results every instruction set is compared against
+    std::vector<float> referenceMatrices, referenceSpheres;
+    Mat4SoA referenceMatrixSoA = matrices(referenceMatrices, count);
+    SphereSoA referenceSphereSoA = spheres(referenceSpheres, count);
+    std::vector<unsigned short> referenceHalves(count), referenceUnorm16(count);
+    std::vector<unsigned char> referenceUnorm8(count);
+    ScalarKernels::multiplyMat4(viewProjection, models, referenceMatrixSoA, count);
+    ScalarKernels::transformSpheres(models, localSpheres, referenceSphereSoA, count);
+    ScalarKernels::packHalf(values.data(), referenceHalves.data(), count);
+    ScalarKernels::packUnorm8(values.data(), referenceUnorm8.data(), count);
+    ScalarKernels::packUnorm16(values.data(), referenceUnorm16.data(), count);
+
+    std::ofstream file;
+    if (outputPath)
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& json = outputPath ? file : std::cout;
+    json << "{\n  \"count\": " << count << ", \"runs\": " << runs << ", \"best\": \"" << simdKernels().name() << "\",\n  \"results\": [";
+
+    bool first = true;
+    for (int isa = 0; isa < SIMD_ISA_COUNT; isa++)
+    {
+        if (!simdIsaSupported((SimdIsa)isa))
+            continue;
+        const SimdKernels& kernels = simdKernels((SimdIsa)isa);
+        std::vector<float> matrixStorage, sphereOutStorage;
+        Mat4SoA outMatrices = matrices(matrixStorage, count);
+        SphereSoA outSpheres = spheres(sphereOutStorage, count);
+        std::vector<unsigned short> halves(count), unorm16(count);
+        std::vector<unsigned char> unorm8(count);
+
+        struct Result { const char* kernel; double seconds, error; };
+        Result results[] = {
+            { "multiply_mat4", measure([&]() { kernels.multiplyMat4(viewProjection, models, outMatrices, count); }, runs, warmup),
+              maxError(matrixStorage, referenceMatrices) },
+            { "transform_spheres", measure([&]() { kernels.transformSpheres(models, localSpheres, outSpheres, count); }, runs, warmup),
+              maxError(sphereOutStorage, referenceSpheres) },
+            { "pack_half", measure([&]() { kernels.packHalf(values.data(), halves.data(), count); }, runs, warmup),
+              maxError(halves, referenceHalves) },
+            { "pack_unorm8", measure([&]() { kernels.packUnorm8(values.data(), unorm8.data(), count); }, runs, warmup),
+              maxError(unorm8, referenceUnorm8) },
+            { "pack_unorm16", measure([&]() { kernels.packUnorm16(values.data(), unorm16.data(), count); }, runs, warmup),
+              maxError(unorm16, referenceUnorm16) }
+        };
+        for (size_t r = 0; r < sizeof(results) / sizeof(results[0]); r++)
+        {
+            json << (first ? "\n" : ",\n") << "    { \"isa\": \"" << kernels.name() << "\", \"kernel\": \"" << results[r].kernel
+                 << "\", \"elements_per_second\": " << count / results[r].seconds << ", \"max_error\": " << results[r].error << " }";
+            first = false;
+        }
+    }
+    json << "\n  ]\n}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,270 @@
+/* Compares three ways of re-uploading vertex data that changes every frame, and reports the results as JSON:
+- buffer_sub_data: one VBO, rewritten with glBufferSubData before every draw. The driver has to wait until
+the GPU finished the previous draw from that buffer, or copy the data aside.
+- orphaning: glBufferData(NULL) before every glBufferSubData, so the driver can hand out fresh storage
+while the GPU keeps reading the old one.
+- persistent_ring: a StreamBuffer; the data is copied straight into a persistently mapped ring and fences
+recycle its regions (it falls back to unsynchronized glMapBufferRange without OpenGL 4.4).
+Every frame draws --batches batches of --vertices animated vertices each into a small offscreen framebuffer,
+so the cost measured is the upload and the synchronization, not the fill rate.
+- Usage: stream_benchmark [--frames N] [--warmup N] [--vertices N] [--batches N] [--output results.json] */
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <learnopengl/frame_profiler.h>
+#include <learnopengl/stream_buffer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+enum Method { BUFFER_SUB_DATA, ORPHANING, PERSISTENT_RING };
+const char* methodNames[] = { "buffer_sub_data", "orphaning", "persistent_ring" };
+
+const char *vertexShaderSource = "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "void main()\n"
+    "{\n"
+    "   gl_Position = vec4(aPos, 1.0);\n"
+    "}\0";
+const char *fragmentShaderSource = "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);\n"
+    "}\n\0";
+
+unsigned int compileProgram(const char* vertexSource, const char* fragmentSource)
+{
+    int success;
+    char infoLog[512];
+    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertex, 1, &vertexSource, NULL);
+    glCompileShader(vertex);
+    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragment, 1, &fragmentSource, NULL);
+    glCompileShader(fragment);
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    return program;
+}
+
+// small triangles on a grid, wobbling with time, so the data really is different every frame
+void animateVertices(std::vector<float>& vertices, int batch, double time)
+{
+    size_t triangles = vertices.size() / 9;
+    size_t side = (size_t)std::ceil(std::sqrt((double)triangles));
+    float size = 2.0f / side;
+    for (size_t t = 0; t < triangles; t++)
+    {
+        float x = -1.0f + (t % side) * size;
+        float y = -1.0f + (t / side) * size;
+        float wobble = 0.25f * size * (float)std::sin(time * 3.0 + t * 0.1 + batch);
+        float* v = &vertices[t * 9];
+        v[0] = x;                    v[1] = y + wobble;        v[2] = 0.0f;
+        v[3] = x + size * 0.8f;      v[4] = y;                 v[5] = 0.0f;
+        v[6] = x + size * 0.4f;      v[7] = y + size * 0.8f;   v[8] = 0.0f;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int frames = 1000;
+    int warmup = 100;
+    int vertexCount = 3 * 16384;
+    int batches = 8;
+    const char* outputPath = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+            frames = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+            warmup = std::max(0, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--vertices") && i + 1 < argc)
+            vertexCount = std::max(3, atoi(argv[++i]) / 3 * 3);
+        else if (!strcmp(argv[i], "--batches") && i + 1 < argc)
+            batches = std::max(1, atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+            outputPath = argv[++i];
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--frames N] [--warmup N] [--vertices N] [--batches N] [--output results.json]" << std::endl;
+            return -1;
+        }
+    }
+
+    // glfw: initialize and create a hidden window, we only need its context
+    // ----------------------------------------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "LearnOpenGL stream benchmark", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    std::ofstream file;
+    if (outputPath)
+    {
+        file.open(outputPath);
+        if (!file)
+        {
+            std::cerr << "Failed to open " << outputPath << std::endl;
+            return -1;
+        }
+    }
+    std::ostream& json = outputPath ? file : std::cout;
+    size_t batchSize = vertexCount * 3 * sizeof(float);
+    json << "{\n  \"renderer\": \"" << (const char*)glGetString(GL_RENDERER) << "\",\n"
+         << "  \"version\": \"" << (const char*)glGetString(GL_VERSION) << "\",\n"
+         << "  \"persistent_mapping\": " << ((GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage) ? "true" : "false") << ",\n"
+         << "  \"frames\": " << frames << ", \"vertices\": " << vertexCount << ", \"batches\": " << batches << ",\n  \"results\": [";
+
+    // offscreen target, small on purpose
+    unsigned int framebuffer, colorbuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &colorbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, 256, 256);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorbuffer);
+    glViewport(0, 0, 256, 256);
+
+    unsigned int program = compileProgram(vertexShaderSource, fragmentShaderSource);
+    glUseProgram(program);
+    std::vector<float> vertices(vertexCount * 3);
+
+    for (int m = 0; m < 3; m++)
+    {
+        Method method = (Method)m;
+        unsigned int VAO, VBO = 0;
+        StreamBuffer* ring = NULL;
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+        if (method == PERSISTENT_RING)
+        {
+            ring = new StreamBuffer(batches * batchSize);
+            glBindBuffer(GL_ARRAY_BUFFER, ring->ID);
+        }
+        else
+        {
+            glGenBuffers(1, &VBO);
+            glBindBuffer(GL_ARRAY_BUFFER, VBO);
+            glBufferData(GL_ARRAY_BUFFER, batchSize, NULL, GL_STREAM_DRAW);
+        }
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        FrameProfiler profiler;
+        std::chrono::steady_clock::time_point start;
+        for (int i = -warmup; i < frames; i++)
+        {
+            if (i == 0)
+            {
+                // the warm-up frames are not part of the results
+                glFinish();
+                profiler.resetStats("frame");
+                profiler.resetStats("upload");
+                if (ring)
+                    ring->stalls = 0;
+                start = std::chrono::steady_clock::now();
+            }
+            profiler.beginFrame();
+            profiler.beginGpu("frame");
+            glClear(GL_COLOR_BUFFER_BIT);
+            for (int b = 0; b < batches; b++)
+            {
+                animateVertices(vertices, b, i / 60.0);
+                profiler.beginCpu("upload");
+                int first = 0;
+                if (method == PERSISTENT_RING)
+                {
+                    std::memcpy(ring->map(batchSize, 3 * sizeof(float)), vertices.data(), batchSize);
+                    ring->unmap();
+                    first = (int)(ring->offset() / (3 * sizeof(float)));
+                }
+                else
+                {
+                    if (method == ORPHANING)
+                        glBufferData(GL_ARRAY_BUFFER, batchSize, NULL, GL_STREAM_DRAW);
+                    glBufferSubData(GL_ARRAY_BUFFER, 0, batchSize, vertices.data());
+                }
+                profiler.endCpu("upload");
+                glDrawArrays(GL_TRIANGLES, first, vertexCount);
+            }
+            if (ring)
+                ring->endFrame();
+            profiler.endGpu();
+            glfwSwapBuffers(window);
+            profiler.endFrame();
+        }
+        glFinish();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        profiler.beginFrame();
+        ScopeStats cpu = profiler.stats("frame");
+        ScopeStats upload = profiler.stats("upload");
+        ScopeStats gpu = profiler.stats("frame", true);
+        profiler.release();
+
+        json << (m == 0 ? "\n" : ",\n") << "    { \"method\": \"" << methodNames[m] << "\""
+             << ", \"fps\": " << frames / seconds
+             << ", \"upload_mb_per_second\": " << (double)frames * batches * batchSize / seconds / (1024.0 * 1024.0)
+             << ", \"cpu_frame_ms_p50\": " << cpu.p50 << ", \"cpu_frame_ms_p99\": " << cpu.p99
+             << ", \"upload_ms_p50\": " << upload.p50 << ", \"upload_ms_p99\": " << upload.p99
+             << ", \"gpu_ms_avg\": " << gpu.avg << ", \"gpu_frames_missed\": " << gpu.missed
+             << ", \"ring_stalls\": " << (ring ? ring->stalls : 0) << " }";
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glDeleteVertexArrays(1, &VAO);
+        if (ring)
+        {
+            ring->release();
+            delete ring;
+        }
+        else
+            glDeleteBuffers(1, &VBO);
+    }
+    json << "\n  ]\n}" << std::endl;
+
+    glDeleteProgram(program);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorbuffer);
+    glfwTerminate();
+    return 0;
+}
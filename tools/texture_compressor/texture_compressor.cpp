@@ -0,0 +1,303 @@
+/* Converts the images of a directory (by default resources/textures) into pre-compressed KTX2 files with a
+prebuilt mip chain, which learnopengl/compressed_texture.h loads without any decoding at startup.
+- There is no encoder library here: the images are compressed by the OpenGL driver. Uploading pixels with a
+compressed internal format makes the driver encode them, and glGetCompressedTexImage reads the blocks back.
+The quality picks the GL_TEXTURE_COMPRESSION_HINT and, for ASTC, the block size (best 4x4, normal 6x6, fast 8x8).
+Not every driver can encode every format (desktop drivers rarely encode ASTC); those images are reported and skipped.
+- Usage: texture_compressor [--format bc7|etc2|astc] [--quality fast|normal|best] [--output-dir dir] [input dir or files...] */
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <learnopengl/compressed_texture.h>
+#include <learnopengl/filesystem.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+enum Quality { FAST, NORMAL, BEST };
+
+// color model and channel numbers of the Khronos data format descriptor
+const int KHR_DF_MODEL_BC7 = 134;
+const int KHR_DF_MODEL_ETC2 = 161;
+const int KHR_DF_MODEL_ASTC = 162;
+const int KHR_DF_CHANNEL_ETC2_COLOR = 2;
+const int KHR_DF_CHANNEL_ETC2_ALPHA = 15;
+
+void putU32(std::vector<unsigned char>& out, unsigned int value)
+{
+    for (int i = 0; i < 4; i++)
+        out.push_back((unsigned char)(value >> (8 * i)));
+}
+
+void putU64(std::vector<unsigned char>& out, unsigned long long value)
+{
+    putU32(out, (unsigned int)value);
+    putU32(out, (unsigned int)(value >> 32));
+}
+
+// basic data format descriptor: one 128 bit sample, or an alpha and a color sample of 64 bits each for ETC2 RGBA
+std::vector<unsigned char> buildDataFormatDescriptor(const CompressedFormatInfo& info, int colorModel, bool etc2Alpha)
+{
+    int samples = etc2Alpha ? 2 : 1;
+    std::vector<unsigned char> block;
+    putU32(block, 0);                             // vendorId 0 (Khronos), descriptorType 0 (basic)
+    putU32(block, 2 | ((24 + 16 * samples) << 16)); // version 1.3, descriptor block size
+    block.push_back((unsigned char)colorModel);
+    block.push_back(1);                           // BT.709 primaries
+    block.push_back(1);                           // linear transfer function
+    block.push_back(0);                           // alpha straight
+    block.push_back((unsigned char)(info.blockWidth - 1));
+    block.push_back((unsigned char)(info.blockHeight - 1));
+    block.push_back(0);
+    block.push_back(0);
+    block.push_back((unsigned char)info.blockBytes); // bytesPlane0
+    for (int i = 1; i < 8; i++)
+        block.push_back(0);
+    for (int i = 0; i < samples; i++)
+    {
+        int bitOffset = etc2Alpha ? 64 * i : 0;
+        int bitLength = etc2Alpha ? 64 : info.blockBytes * 8;
+        int channel = colorModel == KHR_DF_MODEL_ETC2 ? (etc2Alpha && i == 0 ? KHR_DF_CHANNEL_ETC2_ALPHA : KHR_DF_CHANNEL_ETC2_COLOR) : 0;
+        putU32(block, bitOffset | ((bitLength - 1) << 16) | (channel << 24));
+        putU32(block, 0);          // sample position
+        putU32(block, 0);          // sampleLower
+        putU32(block, 0xFFFFFFFF); // sampleUpper
+    }
+    std::vector<unsigned char> dfd;
+    putU32(dfd, (unsigned int)(4 + block.size()));
+    dfd.insert(dfd.end(), block.begin(), block.end());
+    return dfd;
+}
+
+// KTX2 layout: header, level index, data format descriptor, then the levels from the smallest to the largest
+bool writeKTX2(const std::string& path, const CompressedFormatInfo& info, int colorModel, bool etc2Alpha,
+               int width, int height, const std::vector<std::vector<unsigned char> >& levels)
+{
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    std::vector<unsigned char> dfd = buildDataFormatDescriptor(info, colorModel, etc2Alpha);
+    size_t levelCount = levels.size();
+    size_t dfdOffset = 80 + 24 * levelCount;
+    size_t alignment = info.blockBytes; // lcm(block size, 4) for 8 and 16 byte blocks
+
+    std::vector<size_t> offsets(levelCount);
+    size_t offset = dfdOffset + dfd.size();
+    for (size_t i = levelCount; i-- > 0;)
+    {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        offsets[i] = offset;
+        offset += levels[i].size();
+    }
+
+    std::vector<unsigned char> out(identifier, identifier + 12);
+    putU32(out, info.vkFormat);
+    putU32(out, 1);      // typeSize
+    putU32(out, width);
+    putU32(out, height);
+    putU32(out, 0);      // pixelDepth
+    putU32(out, 0);      // layerCount
+    putU32(out, 1);      // faceCount
+    putU32(out, (unsigned int)levelCount);
+    putU32(out, 0);      // no supercompression
+    putU32(out, (unsigned int)dfdOffset);
+    putU32(out, (unsigned int)dfd.size());
+    putU32(out, 0);      // no key/value data
+    putU32(out, 0);
+    putU64(out, 0);      // no supercompression global data
+    putU64(out, 0);
+    for (size_t i = 0; i < levelCount; i++)
+    {
+        putU64(out, offsets[i]);
+        putU64(out, levels[i].size());
+        putU64(out, levels[i].size());
+    }
+    out.insert(out.end(), dfd.begin(), dfd.end());
+    for (size_t i = levelCount; i-- > 0;)
+    {
+        out.resize(offsets[i], 0);
+        out.insert(out.end(), levels[i].begin(), levels[i].end());
+    }
+
+    std::ofstream file(path.c_str(), std::ios::binary);
+    file.write((const char*)out.data(), out.size());
+    return (bool)file;
+}
+
+// lets the driver build the mip chain from the RGBA8 image, then encodes every level into the compressed format
+bool compressImage(const std::string& input, const std::string& output, GLenum format, int colorModel)
+{
+    int width, height, nrChannels;
+    unsigned char* data = stbi_load(input.c_str(), &width, &height, &nrChannels, 4);
+    if (!data)
+    {
+        std::cout << "Failed to load texture: " << input << std::endl;
+        return false;
+    }
+    const CompressedFormatInfo* info = findCompressedFormat(format);
+    bool etc2Alpha = format == GL_COMPRESSED_RGBA8_ETC2_EAC;
+
+    unsigned int source, compressed;
+    glGenTextures(1, &source);
+    glBindTexture(GL_TEXTURE_2D, source);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    stbi_image_free(data);
+
+    int levelCount = 1;
+    while ((width >> levelCount) > 0 || (height >> levelCount) > 0)
+        levelCount++;
+
+    glGenTextures(1, &compressed);
+    std::vector<unsigned char> pixels;
+    std::vector<std::vector<unsigned char> > levels;
+    bool success = true;
+    for (int level = 0; level < levelCount && success; level++)
+    {
+        int levelWidth = std::max(1, width >> level);
+        int levelHeight = std::max(1, height >> level);
+        pixels.resize((size_t)levelWidth * levelHeight * 4);
+        glBindTexture(GL_TEXTURE_2D, source);
+        glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        glBindTexture(GL_TEXTURE_2D, compressed);
+        glTexImage2D(GL_TEXTURE_2D, level, format, levelWidth, levelHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        int isCompressed = 0, internalFormat = 0, size = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED, &isCompressed);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+        if (!isCompressed || (GLenum)internalFormat != format || (size_t)size != compressedLevelSize(*info, levelWidth, levelHeight))
+        {
+            std::cout << "The driver can't encode format 0x" << std::hex << format << std::dec << ": " << input << std::endl;
+            success = false;
+            break;
+        }
+        levels.push_back(std::vector<unsigned char>(size));
+        glGetCompressedTexImage(GL_TEXTURE_2D, level, levels.back().data());
+    }
+    glDeleteTextures(1, &source);
+    glDeleteTextures(1, &compressed);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+    if (success)
+        success = writeKTX2(output, *info, colorModel, etc2Alpha, width, height, levels);
+    if (success)
+        std::cout << input << " -> " << output << " (" << levelCount << " levels)" << std::endl;
+    return success;
+}
+
+bool isImage(const fs::path& path)
+{
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension == ".jpg" || extension == ".jpeg" || extension == ".png" || extension == ".tga" || extension == ".bmp";
+}
+
+int main(int argc, char** argv)
+{
+    std::string formatName = "bc7";
+    Quality quality = NORMAL;
+    std::string outputDir;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--format") && i + 1 < argc)
+            formatName = argv[++i];
+        else if (!strcmp(argv[i], "--quality") && i + 1 < argc)
+        {
+            std::string value = argv[++i];
+            quality = value == "fast" ? FAST : value == "best" ? BEST : NORMAL;
+        }
+        else if (!strcmp(argv[i], "--output-dir") && i + 1 < argc)
+            outputDir = argv[++i];
+        else if (argv[i][0] != '-')
+            inputs.push_back(argv[i]);
+        else
+        {
+            std::cout << "usage: " << argv[0] << " [--format bc7|etc2|astc] [--quality fast|normal|best] [--output-dir dir] [inputs...]" << std::endl;
+            return -1;
+        }
+    }
+    if (inputs.empty())
+        inputs.push_back(FileSystem::getPath("resources/textures"));
+
+    // glfw: a hidden window, only the context is needed
+    // -------------------------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "texture_compressor", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+    loadGLExtensions((GLADloadproc)glfwGetProcAddress);
+
+    glHint(GL_TEXTURE_COMPRESSION_HINT, quality == FAST ? GL_FASTEST : quality == BEST ? GL_NICEST : GL_DONT_CARE);
+
+    std::vector<fs::path> images;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (fs::is_directory(inputs[i]))
+        {
+            for (fs::recursive_directory_iterator it(inputs[i]), end; it != end; ++it)
+                if (it->is_regular_file() && isImage(it->path()))
+                    images.push_back(it->path());
+        }
+        else
+            images.push_back(inputs[i]);
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < images.size(); i++)
+    {
+        // the format decides between RGB and RGBA per image: ETC2 has separate formats for them
+        int width, height, nrChannels;
+        bool alpha = stbi_info(images[i].string().c_str(), &width, &height, &nrChannels) && nrChannels == 4;
+        GLenum format;
+        int colorModel;
+        if (formatName == "etc2")
+        {
+            format = alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+            colorModel = KHR_DF_MODEL_ETC2;
+        }
+        else if (formatName == "astc")
+        {
+            format = quality == BEST ? GL_COMPRESSED_RGBA_ASTC_4x4_KHR : quality == NORMAL ? GL_COMPRESSED_RGBA_ASTC_6x6_KHR : GL_COMPRESSED_RGBA_ASTC_8x8_KHR;
+            colorModel = KHR_DF_MODEL_ASTC;
+        }
+        else
+        {
+            format = GL_COMPRESSED_RGBA_BPTC_UNORM;
+            colorModel = KHR_DF_MODEL_BC7;
+        }
+        fs::path output = images[i];
+        output.replace_extension(".ktx2");
+        if (!outputDir.empty())
+            output = fs::path(outputDir) / output.filename();
+        if (!compressImage(images[i].string(), output.string(), format, colorModel))
+            failed++;
+    }
+
+    glfwTerminate();
+    return failed == 0 ? 0 : 1;
+}